@@ -2,82 +2,403 @@
 // SPDX-License-Identifier: GPL-2.0
 #include <linux/module.h>
 #include <linux/init.h>
-#include <linux/fs.h>
-#include <linux/uaccess.h>
 #include <linux/ioctl.h>
-#include <linux/miscdevice.h>
 #include <linux/of.h>
 #include <linux/of_device.h>
 #include <linux/platform_device.h>
+#include <linux/pm_runtime.h>
+#include <linux/pwm.h>
+#include <linux/thermal.h>
+#include <linux/workqueue.h>
+#include "topst_core.h"
 
 #define AIRCON_MAGIC 'A'
 #define AIRCON_SET_LEVEL _IOW(AIRCON_MAGIC, 1, int)
 #define AIRCON_GET_LEVEL _IOR(AIRCON_MAGIC, 2, int)
 
+#define AIRCON_LEVEL_AUTO (-1) /* SET_LEVEL 전용: 수동 override 해제 → thermal 제어 */
 #define AIRCON_LEVEL_OFF  0
 #define AIRCON_LEVEL_LOW  1
 #define AIRCON_LEVEL_MID  2
 #define AIRCON_LEVEL_HIGH 3
 
+struct aircon_status {
+    __s32 level;       /* 실제 적용 중인 레벨 (cooling state 를 OFF~HIGH 로 내림) */
+    __s32 manual;      /* 1: AIRCON_SET_LEVEL override 중 */
+    __u32 cool_state;  /* thermal 이 요청한 state */
+    __u32 cur_state;   /* 실제 적용 중인 state */
+    __u32 max_state;
+    __u32 duty_pct;
+    __s32 pwm_owned;   /* 1: 드라이버가 팬 PWM 을 직접 구동 (aircon_daemon 불필요) */
+    __s32 boosting;
+};
+#define AIRCON_GET_STATUS _IOR(AIRCON_MAGIC, 3, struct aircon_status)
+
+#define AIRCON_DEFAULT_PERIOD_NS 20000000
+#define AIRCON_DEFAULT_BOOST_MS  1000
+
+/*
+ * cooling state → duty(%). 기존 레벨은 이 중 일부 state 에 대응하고
+ * (OFF 0, LOW 2 = 50%, MID 4 = 80%, HIGH 6 = 100% — aircon_daemon 과 같은 duty),
+ * 나머지는 thermal zone 이 쓰는 중간 단계.
+ */
+static const u8 aircon_duty_pct[] = { 0, 40, 50, 65, 80, 90, 100 };
+static const u8 aircon_level_state[] = { 0, 2, 4, 6 };
+#define AIRCON_MAX_STATE (ARRAY_SIZE(aircon_duty_pct) - 1)
+
+/* fan.lock 안에서만 쓰고, GET_LEVEL 은 잠금 없이 읽음 */
 static int aircon_level = AIRCON_LEVEL_OFF;
+static struct topst_dev *aircon_td;
 
-static long aircon_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
+static struct aircon_fan {
+    struct mutex                   lock;
+    struct pwm_device             *pwm;   /* NULL: DT 에 pwms 없음 → 기존처럼 데몬이 구동 */
+    struct thermal_cooling_device *cdev;
+    struct delayed_work            boost_work;
+    unsigned int                   boost_ms;
+    unsigned long                  thermal_state;
+    unsigned long                  cur_state;
+    int                            manual_level; /* AIRCON_LEVEL_AUTO 면 override 없음 */
+    bool                           boosting;
+    bool                           removing;
+    bool                           suspended;    /* 시스템 suspend 중: 요청은 상태만 남김 */
+} fan = {
+    .lock         = __MUTEX_INITIALIZER(fan.lock),
+    .manual_level = AIRCON_LEVEL_AUTO,
+};
+
+static int aircon_state_to_level(unsigned long state)
 {
-    int user_val;
+    int level = AIRCON_LEVEL_HIGH;
 
-    switch (cmd) {
-    case AIRCON_SET_LEVEL:
-        if (copy_from_user(&user_val, (int __user *)arg, sizeof(int)))
-            return -EFAULT;
-        if (user_val < AIRCON_LEVEL_OFF || user_val > AIRCON_LEVEL_HIGH)
-            return -EINVAL;
-        aircon_level = user_val;
-        break;
+    while (level > AIRCON_LEVEL_OFF && state < aircon_level_state[level])
+        level--;
+    return level;
+}
 
-    case AIRCON_GET_LEVEL:
-        if (copy_to_user((int __user *)arg, &aircon_level, sizeof(int)))
-            return -EFAULT;
-        break;
+static void aircon_pwm_set(unsigned int pct)
+{
+    struct pwm_state st;
 
-    default:
-        return -EINVAL;
+    pwm_get_state(fan.pwm, &st);
+    st.duty_cycle = DIV_ROUND_CLOSEST_ULL((u64)st.period * pct, 100);
+    st.enabled    = pct > 0;
+    pwm_apply_state(fan.pwm, &st);
+}
+
+/* fan.lock 안에서 호출. override 가 있으면 thermal 요청보다 우선 */
+static void aircon_apply_locked(u16 cause)
+{
+    unsigned long target;
+    int level;
+
+    if (fan.removing || fan.suspended)
+        return;
+
+    target = fan.manual_level != AIRCON_LEVEL_AUTO ?
+             aircon_level_state[fan.manual_level] : fan.thermal_state;
+    if (target == fan.cur_state)
+        return;
+
+    level = aircon_state_to_level(target);
+    if (level != aircon_level)
+        topst_dev_event(aircon_td, cause, TOPST_EV_ATTR_STATE, aircon_level, level);
+    WRITE_ONCE(aircon_level, level);
+
+    if (fan.pwm) {
+        if (fan.cur_state == 0 && aircon_duty_pct[target] < 100 && fan.boost_ms) {
+            /* 정지 상태에서 낮은 duty 로는 기동이 안 되므로 잠시 100% (데몬의 boost 와 동일) */
+            aircon_pwm_set(100);
+            fan.boosting = true;
+            mod_delayed_work(system_wq, &fan.boost_work, msecs_to_jiffies(fan.boost_ms));
+        } else if (!fan.boosting || target == 0) {
+            /* boost 중 다른 state 는 boost_work 가 끝날 때 반영 */
+            if (fan.boosting) {
+                fan.boosting = false;
+                cancel_delayed_work(&fan.boost_work);
+            }
+            aircon_pwm_set(aircon_duty_pct[target]);
+        }
+    }
+    fan.cur_state = target;
+}
+
+static void aircon_boost_work(struct work_struct *work)
+{
+    mutex_lock(&fan.lock);
+    if (fan.boosting && !fan.removing) {
+        fan.boosting = false;
+        aircon_pwm_set(aircon_duty_pct[fan.cur_state]);
     }
+    mutex_unlock(&fan.lock);
+}
+
+static int aircon_get_max_state(struct thermal_cooling_device *cdev, unsigned long *state)
+{
+    *state = AIRCON_MAX_STATE;
+    return 0;
+}
+
+static int aircon_get_cur_state(struct thermal_cooling_device *cdev, unsigned long *state)
+{
+    *state = READ_ONCE(fan.cur_state);
+    return 0;
+}
+
+static int aircon_set_cur_state(struct thermal_cooling_device *cdev, unsigned long state)
+{
+    if (state > AIRCON_MAX_STATE)
+        return -EINVAL;
+
+    mutex_lock(&fan.lock);
+    fan.thermal_state = state;
+    aircon_apply_locked(TOPST_EV_CAUSE_THERMAL);
+    mutex_unlock(&fan.lock);
+    topst_pm_update(aircon_td);
+    return 0;
+}
+
+static const struct thermal_cooling_device_ops aircon_cooling_ops = {
+    .get_max_state = aircon_get_max_state,
+    .get_cur_state = aircon_get_cur_state,
+    .set_cur_state = aircon_set_cur_state,
+};
+
+/* mailbox 가 최신값만, 최소 간격마다 부름 */
+static void aircon_apply(struct topst_dev *td, s32 val)
+{
+    mutex_lock(&fan.lock);
+    WRITE_ONCE(fan.manual_level, val);
+    aircon_apply_locked(TOPST_EV_CAUSE_IOCTL);
+    mutex_unlock(&fan.lock);
+    topst_pm_update(td);
+}
+
+static s32 aircon_state(struct topst_dev *td)
+{
+    return READ_ONCE(fan.manual_level);
+}
+
+/* 수동 OFF 는 간격 제한 없이 바로 */
+static bool aircon_urgent(struct topst_dev *td, s32 val)
+{
+    return val == AIRCON_LEVEL_OFF;
+}
+
+static bool aircon_busy(struct topst_dev *td)
+{
+    return READ_ONCE(fan.cur_state) != 0;
+}
+
+static long aircon_set_level(struct topst_dev *td, void *arg)
+{
+    int user_val = *(int *)arg;
+
+    if (user_val < AIRCON_LEVEL_AUTO || user_val > AIRCON_LEVEL_HIGH)
+        return -EINVAL;
+    return topst_mbox_post(td, user_val);
+}
+
+static long aircon_get_level(struct topst_dev *td, void *arg)
+{
+    *(int *)arg = READ_ONCE(aircon_level);
     return 0;
 }
 
-static const struct file_operations aircon_fops = {
-    .owner          = THIS_MODULE,
-    .unlocked_ioctl = aircon_ioctl,
-#ifdef CONFIG_COMPAT
-    .compat_ioctl   = aircon_ioctl,
-#endif
+static long aircon_get_status(struct topst_dev *td, void *arg)
+{
+    struct aircon_status *st = arg;
+
+    mutex_lock(&fan.lock);
+    st->level      = aircon_level;
+    st->manual     = fan.manual_level != AIRCON_LEVEL_AUTO;
+    st->cool_state = fan.thermal_state;
+    st->cur_state  = fan.cur_state;
+    st->max_state  = AIRCON_MAX_STATE;
+    st->duty_pct   = aircon_duty_pct[fan.cur_state];
+    st->pwm_owned  = fan.pwm != NULL;
+    st->boosting   = fan.boosting;
+    mutex_unlock(&fan.lock);
+    return 0;
+}
+
+static const struct topst_ioctl aircon_ioctls[] = {
+    TOPST_IOCTL(AIRCON_SET_LEVEL,  aircon_set_level),
+    TOPST_IOCTL(AIRCON_GET_LEVEL,  aircon_get_level),
+    TOPST_IOCTL(AIRCON_GET_STATUS, aircon_get_status),
 };
 
-static struct miscdevice aircon_miscdev = {
-    .minor = MISC_DYNAMIC_MINOR,
-    .name  = "aircon_dev",
-    .fops  = &aircon_fops,
-    .mode  = 0666,
+static const struct topst_dev_ops aircon_ops = {
+    .owner           = THIS_MODULE,
+    .ioctls          = aircon_ioctls,
+    .nr_ioctls       = ARRAY_SIZE(aircon_ioctls),
+    .apply           = aircon_apply,
+    .state           = aircon_state,
+    .urgent          = aircon_urgent,
+    .min_interval_us = 100000,  /* 팬은 100ms 안의 변화를 따라갈 수 없음 */
+    .busy            = aircon_busy,
 };
 
+/* 팬이 멈춰 있을 때만 (cur_state 0 이면 PWM 도 이미 0%) */
+static int __maybe_unused aircon_runtime_suspend(struct device *dev)
+{
+    if (aircon_busy(aircon_td))
+        return -EBUSY;
+    topst_pm_set_state(aircon_td, TOPST_PARK_SUSPENDED);
+    return 0;
+}
+
+static int __maybe_unused aircon_runtime_resume(struct device *dev)
+{
+    topst_pm_set_state(aircon_td, TOPST_PARK_ACTIVE);
+    return 0;
+}
+
+static int __maybe_unused aircon_suspend(struct device *dev)
+{
+    if (pm_runtime_suspended(dev))
+        return 0;
+
+    mutex_lock(&fan.lock);
+    fan.suspended = true;
+    if (fan.pwm) {
+        /* resume 때 정지 상태부터 다시 적용해 기동 boost 를 거치게 함 */
+        fan.boosting = false;
+        aircon_pwm_set(0);
+        fan.cur_state = 0;
+    }
+    mutex_unlock(&fan.lock);
+    cancel_delayed_work_sync(&fan.boost_work);
+    topst_pm_set_state(aircon_td, TOPST_PARK_SUSPENDED);
+    return 0;
+}
+
+static int __maybe_unused aircon_resume(struct device *dev)
+{
+    if (!fan.suspended)
+        return 0;
+
+    mutex_lock(&fan.lock);
+    fan.suspended = false;
+    aircon_apply_locked(TOPST_EV_CAUSE_PM);
+    mutex_unlock(&fan.lock);
+    topst_pm_set_state(aircon_td, TOPST_PARK_ACTIVE);
+    topst_pm_update(aircon_td);
+    return 0;
+}
+
+static const struct dev_pm_ops aircon_pm_ops = {
+    SET_SYSTEM_SLEEP_PM_OPS(aircon_suspend, aircon_resume)
+    SET_RUNTIME_PM_OPS(aircon_runtime_suspend, aircon_runtime_resume, NULL)
+};
+
+static int aircon_pwm_init(struct platform_device *pdev)
+{
+    struct pwm_state st;
+    struct pwm_device *pwm;
+
+    pwm = devm_pwm_get(&pdev->dev, NULL);
+    if (IS_ERR(pwm)) {
+        /* pwms 가 없는 기존 DT: 상태만 보관하고 aircon_daemon 이 구동 */
+        if (PTR_ERR(pwm) == -ENODEV || PTR_ERR(pwm) == -ENOENT)
+            return 0;
+        if (PTR_ERR(pwm) != -EPROBE_DEFER)
+            dev_err(&pdev->dev, "failed to get pwms: %ld\n", PTR_ERR(pwm));
+        return PTR_ERR(pwm);
+    }
+
+    pwm_init_state(pwm, &st);
+    if (!st.period)
+        st.period = AIRCON_DEFAULT_PERIOD_NS;
+    st.duty_cycle = 0;
+    st.enabled    = false;
+    pwm_apply_state(pwm, &st);
+
+    fan.pwm = pwm;
+    return 0;
+}
+
 static int aircon_probe(struct platform_device *pdev)
 {
+    struct thermal_cooling_device *cdev;
+    u64 t0 = topst_probe_start();
     int ret;
 
-    ret = misc_register(&aircon_miscdev);
-    if (ret) {
-        dev_err(&pdev->dev, "misc_register failed: %d\n", ret);
+    INIT_DELAYED_WORK(&fan.boost_work, aircon_boost_work);
+    fan.pwm           = NULL;
+    fan.cdev          = NULL;
+    fan.thermal_state = 0;
+    fan.cur_state     = 0;
+    fan.manual_level  = AIRCON_LEVEL_AUTO;
+    fan.boosting      = false;
+    fan.removing      = false;
+    fan.suspended     = false;
+    aircon_level      = AIRCON_LEVEL_OFF;
+
+    fan.boost_ms = AIRCON_DEFAULT_BOOST_MS;
+    of_property_read_u32(pdev->dev.of_node, "boost-ms", &fan.boost_ms);
+
+    ret = aircon_pwm_init(pdev);
+    if (ret)
         return ret;
+
+    /* set_cur_state 가 이벤트를 남기므로 cooling device 보다 먼저 */
+    aircon_td = topst_dev_register(&pdev->dev, "aircon_dev", TOPST_EV_DEV_AIRCON,
+                                   &aircon_ops, NULL);
+    if (IS_ERR(aircon_td))
+        return PTR_ERR(aircon_td);
+
+    /*
+     * #cooling-cells 가 있으면 thermal zone 의 cooling-maps 에서 참조 가능.
+     * 데몬이 PWM 을 구동하는 state-only 모드는 GET_LEVEL 의 4 단계만 보므로
+     * 중간 state 가 내림돼 꺼질 수 있어 cooling device 를 만들지 않음.
+     */
+    cdev = NULL;
+    if (fan.pwm)
+        cdev = thermal_of_cooling_device_register(pdev->dev.of_node, "aircon-fan", NULL,
+                                                  &aircon_cooling_ops);
+    if (IS_ERR(cdev)) {
+        if (PTR_ERR(cdev) == -EPROBE_DEFER) {
+            topst_dev_unregister(aircon_td);
+            aircon_td = NULL;
+            return -EPROBE_DEFER;
+        }
+        dev_warn(&pdev->dev, "cooling device not registered: %ld\n", PTR_ERR(cdev));
+    } else {
+        fan.cdev = cdev;
     }
+    /* 드라이버가 PWM 을 쥐지 않으면 aircon_daemon 이 park 함 */
+    topst_pm_enable(aircon_td, !fan.pwm);
 
-    dev_info(&pdev->dev, "aircon driver probed (state-only), /dev/%s\n",
-             aircon_miscdev.name);
+    dev_info(&pdev->dev, "aircon driver probed (%s%s), /dev/aircon_dev\n",
+             fan.pwm ? "pwm" : "state-only", fan.cdev ? ", cooling device" : "");
+    topst_dev_ready(aircon_td, t0);
     return 0;
 }
 
 static int aircon_remove(struct platform_device *pdev)
 {
-    misc_deregister(&aircon_miscdev);
+    /*
+     * set_cur_state 가 aircon_td 를 쓰므로 cooling device 를 먼저 내림.
+     * unregister 가 돌아오면 thermal core 에서 더 들어오는 호출은 없음.
+     */
+    if (fan.cdev) {
+        thermal_cooling_device_unregister(fan.cdev);
+        fan.cdev = NULL;
+    }
+
+    mutex_lock(&fan.lock);
+    fan.removing = true;
+    fan.boosting = false;
+    mutex_unlock(&fan.lock);
+
+    topst_pm_disable(aircon_td);
+    topst_dev_unregister(aircon_td);
+    aircon_td = NULL;
+    cancel_delayed_work_sync(&fan.boost_work);
+    if (fan.pwm)
+        aircon_pwm_set(0);
+
     dev_info(&pdev->dev, "aircon driver removed\n");
     return 0;
 }
@@ -94,11 +415,13 @@ static struct platform_driver aircon_platdrv = {
     .driver = {
         .name           = "telechips-aircon",
         .of_match_table = aircon_of_match,
+        .probe_type     = PROBE_PREFER_ASYNCHRONOUS,
+        .pm             = &aircon_pm_ops,
     },
 };
 
-module_platform_driver(aircon_platdrv);
+topst_platform_driver(aircon_platdrv);
 
 MODULE_LICENSE("GPL");
 MODULE_AUTHOR("telli");
-MODULE_DESCRIPTION("TOPST D3-G Aircon State-Only Driver (platform + DT)");
+MODULE_DESCRIPTION("TOPST D3-G Aircon Fan Driver (PWM + thermal cooling device, platform + DT)");
@@ -2,15 +2,15 @@
 // SPDX-License-Identifier: GPL-2.0
 #include <linux/init.h>
 #include <linux/module.h>
-#include <linux/fs.h>
-#include <linux/uaccess.h>
-#include <linux/device.h>
 #include <linux/of.h>
 #include <linux/of_device.h>
 #include <linux/platform_device.h>
+#include <linux/pm_runtime.h>
+#include <linux/seqlock.h>
+#include <linux/string.h>
+#include "topst_core.h"
 
 #define DEVICE_NAME "ambient_dev"
-#define CLASS_NAME  "ambient_class"
 
 
 #define AMBIENT_MAGIC 'L'
@@ -19,113 +19,448 @@
 #define AMBIENT_SET_BRIGHTNESS  _IOW(AMBIENT_MAGIC, 3, int)
 #define AMBIENT_GET_BRIGHTNESS  _IOR(AMBIENT_MAGIC, 4, int)
 
+/*
+ * 멀티 존: 한 스트립을 LED 구간(존)으로 나눠 존마다 모드/밝기를 둔다.
+ * 존에 속하지 않은 LED 는 위의 전역 모드/밝기(배경)로 그린다.
+ */
+#define AMBIENT_MAX_ZONES  8
+#define AMBIENT_MAX_LEDS   4096
+
+struct ambient_zone {
+    __u16 first;        /* 시작 LED index */
+    __u16 count;        /* LED 개수, 0 이면 비활성 */
+    __s32 brightness;   /* 0~100 */
+    char  mode[16];
+};
+
+struct ambient_zone_arg {
+    __u32               id;     /* 0 ~ AMBIENT_MAX_ZONES-1 */
+    struct ambient_zone zone;
+};
+
+struct ambient_zones {
+    __u32               nr;     /* AMBIENT_MAX_ZONES */
+    struct ambient_zone bg;     /* 배경 (first/count 는 0) */
+    struct ambient_zone zone[AMBIENT_MAX_ZONES];
+};
+
+#define AMBIENT_SET_ZONE        _IOW(AMBIENT_MAGIC, 5, struct ambient_zone_arg)
+#define AMBIENT_GET_ZONE        _IOWR(AMBIENT_MAGIC, 6, struct ambient_zone_arg)
+#define AMBIENT_GET_ZONES       _IOR(AMBIENT_MAGIC, 7, struct ambient_zones)
+
+/*
+ * scene: 배경 + 존 전체 구성을 미리 올려 두고 APPLY_SCENE 한 번으로 통째로 바꾼다.
+ * 모드/밝기/존을 따로 SET 하면 그 사이 데몬이 섞인 상태를 한 프레임 그릴 수 있지만
+ * APPLY 는 seqlock 한 번 안에서 바뀌므로 중간 상태가 보이지 않는다.
+ * transition_ms 는 데몬이 이전 화면에서 crossfade 할 시간 (0 = 바로).
+ */
+#define AMBIENT_MAX_SCENES         8
+#define AMBIENT_MAX_TRANSITION_MS  10000
+#define AMBIENT_NO_SCENE           0xffffffffu
+
+struct ambient_scene {
+    __u32               transition_ms;
+    struct ambient_zone bg;     /* first/count 무시 */
+    struct ambient_zone zone[AMBIENT_MAX_ZONES];
+};
+
+struct ambient_scene_arg {
+    __u32                id;    /* 0 ~ AMBIENT_MAX_SCENES-1 */
+    struct ambient_scene scene;
+};
+
+/* GET_ZONES + 마지막 scene 적용 정보. 데몬은 scene_seq 가 바뀌면 crossfade */
+struct ambient_state {
+    struct ambient_zones zones;
+    __u32                scene;          /* 마지막 APPLY 한 id, 없으면 AMBIENT_NO_SCENE */
+    __u32                scene_seq;      /* APPLY 마다 +1 */
+    __u32                transition_ms;
+};
+
+#define AMBIENT_SET_SCENE       _IOW(AMBIENT_MAGIC, 8, struct ambient_scene_arg)
+#define AMBIENT_GET_SCENE       _IOWR(AMBIENT_MAGIC, 9, struct ambient_scene_arg)
+#define AMBIENT_APPLY_SCENE     _IOW(AMBIENT_MAGIC, 10, __u32)
+#define AMBIENT_GET_STATE       _IOR(AMBIENT_MAGIC, 11, struct ambient_state)
 
-static int major;
-static struct class  *ambient_class;
-static struct device *ambient_device;
 
 static char current_mode[16] = "red";  /* 초기 모드 */
 static int  current_brightness = 50;   /* 초기 밝기 */
+static struct ambient_zone zones[AMBIENT_MAX_ZONES];
+static struct ambient_scene scenes[AMBIENT_MAX_SCENES];
+static unsigned long scene_loaded;        /* 올라온 scene bitmap */
+static u32 scene_cur = AMBIENT_NO_SCENE;
+static u32 scene_seq;
+static u32 scene_transition_ms;
+/*
+ * 모드/밝기/zones/scene 보호. 쓰기는 드물고 짧아 seqlock 의 spinlock 으로 직렬화,
+ * 읽기(데몬의 프레임마다 GET_ZONES 포함)는 잠금 없이 sequence 만 확인하고
+ * 쓰기와 겹쳤으면 다시 복사한다 → 읽는 스레드가 늘어도 서로 막지 않고 찢어진 값도 없음.
+ */
+static DEFINE_SEQLOCK(ambient_seq);
+static struct topst_dev *ambient_td;
+static bool ambient_sys_parked;   /* 시스템 suspend 가 park 시킴 (runtime suspend 아님) */
 
+/*
+ * 데몬이 그리는 모드. music 은 오디오 band, stream 은 외부 producer 가
+ * 공유 메모리로 넣는 프레임(ambient_stream)을 해당 LED 에 그대로 낸다.
+ */
+static const char *const ambient_modes[] = {
+    "off", "red", "green", "blue", "yellow", "cyan", "magenta", "white",
+    "rainbow", "music", "stream",
+};
 
-static long ambient_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
+static bool ambient_mode_valid(const char *mode)
 {
-    switch (cmd) {
-    case AMBIENT_SET_MODE:
-        if (copy_from_user(current_mode, (char __user *)arg, sizeof(current_mode)))
-            return -EFAULT;
-        printk(KERN_INFO "AMBIENT: Set mode to %s\n", current_mode);
-        break;
+    return match_string(ambient_modes, ARRAY_SIZE(ambient_modes), mode) >= 0;
+}
 
-    case AMBIENT_GET_MODE:
-        if (copy_to_user((char __user *)arg, current_mode, sizeof(current_mode)))
-            return -EFAULT;
-        break;
+/* 이벤트용: 모드 문자열 앞 4바이트 */
+static s32 ambient_mode_tag(const char *mode)
+{
+    s32 tag = 0;
 
-    case AMBIENT_SET_BRIGHTNESS:
-        if (copy_from_user(&current_brightness, (int __user *)arg, sizeof(int)))
-            return -EFAULT;
-        printk(KERN_INFO "AMBIENT: Set brightness to %d\n", current_brightness);
-        break;
+    memcpy(&tag, mode, min_t(size_t, strnlen(mode, 16), sizeof(tag)));
+    return tag;
+}
 
-    case AMBIENT_GET_BRIGHTNESS:
-        if (copy_to_user((int __user *)arg, &current_brightness, sizeof(int)))
-            return -EFAULT;
-        break;
+/* set 안의 다른 활성 존과 LED 구간이 겹치면 안 됨 (set = 현재 zones 또는 scene 의 존) */
+static int ambient_zone_check(const struct ambient_zone *set, u32 id,
+                              const struct ambient_zone *z)
+{
+    int i;
 
-    default:
+    if (id >= AMBIENT_MAX_ZONES)
         return -EINVAL;
+    if (z->count == 0)
+        return 0;
+    if (z->first + z->count > AMBIENT_MAX_LEDS)
+        return -EINVAL;
+    if (z->brightness < 0 || z->brightness > 100)
+        return -EINVAL;
+    if (!ambient_mode_valid(z->mode))
+        return -EINVAL;
+
+    for (i = 0; i < AMBIENT_MAX_ZONES; i++) {
+        if (i == id || set[i].count == 0)
+            continue;
+        if (z->first < set[i].first + set[i].count &&
+            set[i].first < z->first + z->count)
+            return -EBUSY;
     }
     return 0;
 }
 
-static const struct file_operations fops = {
-    .owner          = THIS_MODULE,
-    .unlocked_ioctl = ambient_ioctl,
-#ifdef CONFIG_COMPAT
-    .compat_ioctl   = ambient_ioctl,
-#endif
-};
 
+static bool ambient_zone_lit(const char *mode, int brightness)
+{
+    return brightness > 0 && strcmp(mode, "off") != 0;
+}
 
-static int ambient_probe(struct platform_device *pdev)
+/* 배경이나 활성 존 중 하나라도 켜져 있으면 busy */
+static bool ambient_busy(struct topst_dev *td)
+{
+    unsigned int seq;
+    bool lit;
+    int i;
+
+    do {
+        seq = read_seqbegin(&ambient_seq);
+        lit = ambient_zone_lit(current_mode, current_brightness);
+        for (i = 0; i < AMBIENT_MAX_ZONES && !lit; i++)
+            lit = zones[i].count && ambient_zone_lit(zones[i].mode, zones[i].brightness);
+    } while (read_seqretry(&ambient_seq, seq));
+    return lit;
+}
+
+static long ambient_set_mode(struct topst_dev *td, void *arg)
 {
+    char *new_mode = arg;
+
+    new_mode[sizeof(current_mode) - 1] = '\0';
+    if (!ambient_mode_valid(new_mode))
+        return -EINVAL;
+    write_seqlock(&ambient_seq);
+    if (strcmp(new_mode, current_mode))
+        topst_dev_event(td, TOPST_EV_CAUSE_IOCTL, TOPST_EV_ATTR_MODE,
+                        ambient_mode_tag(current_mode), ambient_mode_tag(new_mode));
+    memcpy(current_mode, new_mode, sizeof(current_mode));
+    write_sequnlock(&ambient_seq);
+    topst_pm_update(td);
+    pr_debug("AMBIENT: Set mode to %s\n", new_mode);
+    return 0;
+}
+
+static long ambient_get_mode(struct topst_dev *td, void *arg)
+{
+    unsigned int seq;
+
+    do {
+        seq = read_seqbegin(&ambient_seq);
+        memcpy(arg, current_mode, sizeof(current_mode));
+    } while (read_seqretry(&ambient_seq, seq));
+    return 0;
+}
+
+static long ambient_set_brightness(struct topst_dev *td, void *arg)
+{
+    int new_brightness = *(int *)arg;
+
+    if (new_brightness < 0 || new_brightness > 100)
+        return -EINVAL;
+    write_seqlock(&ambient_seq);
+    if (new_brightness != current_brightness)
+        topst_dev_event(td, TOPST_EV_CAUSE_IOCTL, TOPST_EV_ATTR_BRIGHTNESS,
+                        current_brightness, new_brightness);
+    WRITE_ONCE(current_brightness, new_brightness);
+    write_sequnlock(&ambient_seq);
+    topst_pm_update(td);
+    pr_debug("AMBIENT: Set brightness to %d\n", new_brightness);
+    return 0;
+}
+
+static long ambient_get_brightness(struct topst_dev *td, void *arg)
+{
+    *(int *)arg = READ_ONCE(current_brightness);
+    return 0;
+}
+
+static long ambient_set_zone(struct topst_dev *td, void *arg)
+{
+    struct ambient_zone_arg *za = arg;
     int ret;
 
-    /* character device 등록 */
-    if (major == 0) {
-        major = register_chrdev(0, DEVICE_NAME, &fops);
-        if (major < 0) {
-            dev_err(&pdev->dev, "Failed to register a major number\n");
-            return major;
-        }
-    }
+    za->zone.mode[sizeof(za->zone.mode) - 1] = '\0';
+    write_seqlock(&ambient_seq);
+    ret = ambient_zone_check(zones, za->id, &za->zone);
+    if (!ret)
+        zones[za->id] = za->zone;
+    write_sequnlock(&ambient_seq);
+    if (ret)
+        return ret;
+    topst_pm_update(td);
+    pr_debug("AMBIENT: zone %u = [%u..+%u] %s/%d\n", za->id,
+            za->zone.first, za->zone.count, za->zone.mode, za->zone.brightness);
+    return 0;
+}
+
+static long ambient_get_zone(struct topst_dev *td, void *arg)
+{
+    struct ambient_zone_arg *za = arg;
+    unsigned int seq;
+
+    if (za->id >= AMBIENT_MAX_ZONES)
+        return -EINVAL;
+    do {
+        seq = read_seqbegin(&ambient_seq);
+        za->zone = zones[za->id];
+    } while (read_seqretry(&ambient_seq, seq));
+    return 0;
+}
 
-    /* 클래스 생성 (최초 1회) */
-    if (!ambient_class) {
-        ambient_class = class_create(THIS_MODULE, CLASS_NAME);
-        if (IS_ERR(ambient_class)) {
-            ret = PTR_ERR(ambient_class);
-            ambient_class = NULL;
-            unregister_chrdev(major, DEVICE_NAME);
-            major = 0;
+/* 데몬이 프레임마다 한 번에 가져가는 전체 스냅샷 (220 바이트) */
+static long ambient_get_zones(struct topst_dev *td, void *arg)
+{
+    struct ambient_zones *snap = arg;
+    unsigned int seq;
+
+    snap->nr = AMBIENT_MAX_ZONES;
+    do {
+        seq = read_seqbegin(&ambient_seq);
+        memcpy(snap->bg.mode, current_mode, sizeof(snap->bg.mode));
+        snap->bg.brightness = current_brightness;
+        memcpy(snap->zone, zones, sizeof(zones));
+    } while (read_seqretry(&ambient_seq, seq));
+    return 0;
+}
+
+static long ambient_get_state(struct topst_dev *td, void *arg)
+{
+    struct ambient_state *st = arg;
+    unsigned int seq;
+
+    ambient_get_zones(td, &st->zones);
+    do {
+        seq = read_seqbegin(&ambient_seq);
+        st->scene = scene_cur;
+        st->scene_seq = scene_seq;
+        st->transition_ms = scene_transition_ms;
+    } while (read_seqretry(&ambient_seq, seq));
+    return 0;
+}
+
+/* 올릴 때 한 번 전부 검사해 두므로 APPLY 는 복사만 */
+static int ambient_scene_check(struct ambient_scene *sc)
+{
+    int i, ret;
+
+    if (sc->transition_ms > AMBIENT_MAX_TRANSITION_MS)
+        return -EINVAL;
+    sc->bg.mode[sizeof(sc->bg.mode) - 1] = '\0';
+    if (!ambient_mode_valid(sc->bg.mode) || sc->bg.brightness < 0 || sc->bg.brightness > 100)
+        return -EINVAL;
+    sc->bg.first = 0;
+    sc->bg.count = 0;
+    for (i = 0; i < AMBIENT_MAX_ZONES; i++) {
+        sc->zone[i].mode[sizeof(sc->zone[i].mode) - 1] = '\0';
+        ret = ambient_zone_check(sc->zone, i, &sc->zone[i]);
+        if (ret)
             return ret;
-        }
     }
+    return 0;
+}
 
-    /* 디바이스 노드 생성: /dev/ambient_dev (minor 0로 고정) */
-    ambient_device = device_create(ambient_class, NULL, MKDEV(major, 0),
-                                   NULL, DEVICE_NAME);
-    if (IS_ERR(ambient_device)) {
-        ret = PTR_ERR(ambient_device);
-        ambient_device = NULL;
-        class_unregister(ambient_class);
-        class_destroy(ambient_class);
-        ambient_class = NULL;
-        unregister_chrdev(major, DEVICE_NAME);
-        major = 0;
+static long ambient_set_scene(struct topst_dev *td, void *arg)
+{
+    struct ambient_scene_arg *sa = arg;
+    int ret;
+
+    if (sa->id >= AMBIENT_MAX_SCENES)
+        return -EINVAL;
+    ret = ambient_scene_check(&sa->scene);
+    if (ret)
         return ret;
+    write_seqlock(&ambient_seq);
+    scenes[sa->id] = sa->scene;
+    __set_bit(sa->id, &scene_loaded);
+    write_sequnlock(&ambient_seq);
+    pr_debug("AMBIENT: scene %u loaded (%s/%d, %u ms)\n", sa->id,
+            sa->scene.bg.mode, sa->scene.bg.brightness, sa->scene.transition_ms);
+    return 0;
+}
+
+static long ambient_get_scene(struct topst_dev *td, void *arg)
+{
+    struct ambient_scene_arg *sa = arg;
+    unsigned int seq;
+    bool loaded;
+
+    if (sa->id >= AMBIENT_MAX_SCENES)
+        return -EINVAL;
+    do {
+        seq = read_seqbegin(&ambient_seq);
+        loaded = test_bit(sa->id, &scene_loaded);
+        sa->scene = scenes[sa->id];
+    } while (read_seqretry(&ambient_seq, seq));
+    return loaded ? 0 : -ENOENT;
+}
+
+/* 배경과 존 전체를 한 write 구간에서 교체 → 데몬의 GET_STATE 는 전/후 중 하나만 봄 */
+static long ambient_apply_scene(struct topst_dev *td, void *arg)
+{
+    u32 id = *(u32 *)arg;
+    const struct ambient_scene *sc;
+
+    if (id >= AMBIENT_MAX_SCENES)
+        return -EINVAL;
+    write_seqlock(&ambient_seq);
+    if (!test_bit(id, &scene_loaded)) {
+        write_sequnlock(&ambient_seq);
+        return -ENOENT;
     }
+    sc = &scenes[id];
+    topst_dev_event(td, TOPST_EV_CAUSE_IOCTL, TOPST_EV_ATTR_SCENE, (s32)scene_cur, id);
+    if (strcmp(sc->bg.mode, current_mode))
+        topst_dev_event(td, TOPST_EV_CAUSE_IOCTL, TOPST_EV_ATTR_MODE,
+                        ambient_mode_tag(current_mode), ambient_mode_tag(sc->bg.mode));
+    if (sc->bg.brightness != current_brightness)
+        topst_dev_event(td, TOPST_EV_CAUSE_IOCTL, TOPST_EV_ATTR_BRIGHTNESS,
+                        current_brightness, sc->bg.brightness);
+    memcpy(current_mode, sc->bg.mode, sizeof(current_mode));
+    WRITE_ONCE(current_brightness, sc->bg.brightness);
+    memcpy(zones, sc->zone, sizeof(zones));
+    scene_cur = id;
+    scene_seq++;
+    scene_transition_ms = sc->transition_ms;
+    write_sequnlock(&ambient_seq);
+    topst_pm_update(td);
+    pr_debug("AMBIENT: scene %u applied\n", id);
+    return 0;
+}
+
+/* SET/GET_MODE 는 _IOW/_IOR(..., char *) 로 정의돼 있지만 실제로는 16바이트를 주고받는다 */
+static const struct topst_ioctl ambient_ioctls[] = {
+    TOPST_IOCTL_SIZED(AMBIENT_SET_MODE, ambient_set_mode, sizeof(current_mode)),
+    TOPST_IOCTL_SIZED(AMBIENT_GET_MODE, ambient_get_mode, sizeof(current_mode)),
+    TOPST_IOCTL(AMBIENT_SET_BRIGHTNESS, ambient_set_brightness),
+    TOPST_IOCTL(AMBIENT_GET_BRIGHTNESS, ambient_get_brightness),
+    TOPST_IOCTL(AMBIENT_SET_ZONE,       ambient_set_zone),
+    TOPST_IOCTL(AMBIENT_GET_ZONE,       ambient_get_zone),
+    TOPST_IOCTL(AMBIENT_GET_ZONES,      ambient_get_zones),
+    TOPST_IOCTL(AMBIENT_SET_SCENE,      ambient_set_scene),
+    TOPST_IOCTL(AMBIENT_GET_SCENE,      ambient_get_scene),
+    TOPST_IOCTL(AMBIENT_APPLY_SCENE,    ambient_apply_scene),
+    TOPST_IOCTL(AMBIENT_GET_STATE,      ambient_get_state),
+};
+
+static const struct topst_dev_ops ambient_ops = {
+    .owner     = THIS_MODULE,
+    .ioctls    = ambient_ioctls,
+    .nr_ioctls = ARRAY_SIZE(ambient_ioctls),
+    .busy      = ambient_busy,
+};
+
+/*
+ * SPI 출력은 ambient_daemon 몫이라 여기서는 상태만 알린다.
+ * 데몬은 parking/suspended 를 보면 스트립을 끈 프레임을 보내고 active 까지 잠들며,
+ * 모드/존은 그대로라 resume 뒤 다시 그리면 복원된다.
+ */
+static int __maybe_unused ambient_runtime_suspend(struct device *dev)
+{
+    if (ambient_busy(ambient_td))
+        return -EBUSY;
+    topst_pm_set_state(ambient_td, TOPST_PARK_SUSPENDED);
+    return 0;
+}
+
+static int __maybe_unused ambient_runtime_resume(struct device *dev)
+{
+    topst_pm_set_state(ambient_td, TOPST_PARK_ACTIVE);
+    return 0;
+}
+
+static int __maybe_unused ambient_suspend(struct device *dev)
+{
+    if (pm_runtime_suspended(dev))
+        return 0;
+    ambient_sys_parked = true;
+    topst_pm_set_state(ambient_td, TOPST_PARK_SUSPENDED);
+    return 0;
+}
+
+static int __maybe_unused ambient_resume(struct device *dev)
+{
+    if (!ambient_sys_parked)
+        return 0;
+    ambient_sys_parked = false;
+    topst_pm_set_state(ambient_td, TOPST_PARK_ACTIVE);
+    return 0;
+}
+
+static const struct dev_pm_ops ambient_pm_ops = {
+    SET_SYSTEM_SLEEP_PM_OPS(ambient_suspend, ambient_resume)
+    SET_RUNTIME_PM_OPS(ambient_runtime_suspend, ambient_runtime_resume, NULL)
+};
+
+static int ambient_probe(struct platform_device *pdev)
+{
+    u64 t0 = topst_probe_start();
+
+    ambient_td = topst_dev_register(&pdev->dev, DEVICE_NAME, TOPST_EV_DEV_AMBIENT,
+                                    &ambient_ops, NULL);
+    if (IS_ERR(ambient_td))
+        return PTR_ERR(ambient_td);
+    topst_pm_enable(ambient_td, true);
 
     dev_info(&pdev->dev, "AMBIENT driver probed via DT.\n");
+    topst_dev_ready(ambient_td, t0);
     return 0;
 }
 
 static int ambient_remove(struct platform_device *pdev)
 {
-    if (ambient_device) {
-        device_destroy(ambient_class, MKDEV(major, 0));
-        ambient_device = NULL;
-    }
-    if (ambient_class) {
-        class_unregister(ambient_class);
-        class_destroy(ambient_class);
-        ambient_class = NULL;
-    }
-    if (major > 0) {
-        unregister_chrdev(major, DEVICE_NAME);
-        major = 0;
-    }
+    topst_pm_disable(ambient_td);
+    topst_dev_unregister(ambient_td);
+    ambient_td = NULL;
     dev_info(&pdev->dev, "AMBIENT driver removed.\n");
     return 0;
 }
@@ -143,10 +478,12 @@ static struct platform_driver ambient_platdrv = {
     .driver = {
         .name           = "telechips-ambient",
         .of_match_table = ambient_of_match,
+        .probe_type     = PROBE_PREFER_ASYNCHRONOUS,
+        .pm             = &ambient_pm_ops,
     },
 };
 
-module_platform_driver(ambient_platdrv);
+topst_platform_driver(ambient_platdrv);
 
 MODULE_LICENSE("GPL");
 MODULE_AUTHOR("telli");
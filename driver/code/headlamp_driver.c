@@ -1,81 +1,477 @@
 // drivers/mytopst/headlamp_driver.c
 // SPDX-License-Identifier: GPL-2.0
 #include <linux/module.h>
-#include <linux/fs.h>
-#include <linux/uaccess.h>
-#include <linux/cdev.h>
 #include <linux/ioctl.h>
 #include <linux/platform_device.h>
 #include <linux/of.h>
 #include <linux/of_device.h>
 #include <linux/gpio/consumer.h>
+#include <linux/bitmap.h>
+#include <linux/ktime.h>
+#include <linux/leds.h>
+#include <linux/mutex.h>
+#include <linux/pm_runtime.h>
+#include <linux/workqueue.h>
+#include "topst_core.h"
 
 #define DEVICE_NAME "headlamp_dev"
-#define CLASS_NAME  "headlamp_class"
 
 #define HEADLAMP_MAGIC        'H'
 #define HEADLAMP_SET_STATE    _IOW(HEADLAMP_MAGIC, 0, int) /* 0:off, 1:on */
 #define HEADLAMP_GET_STATE    _IOR(HEADLAMP_MAGIC, 1, int)
+#define HEADLAMP_SET_MASK     _IOW(HEADLAMP_MAGIC, 2, __u32) /* bit n = segment n */
+#define HEADLAMP_GET_MASK     _IOR(HEADLAMP_MAGIC, 3, __u32)
+
+/* 매트릭스(ADB) 헤드램프 세그먼트 최대 수 (mask 폭) */
+#define HEADLAMP_MAX_SEGMENTS 32
+
+/* timer trigger 가 delay 를 안 주면 방향지시등 주기(약 90회/분)로 점멸 */
+#define HEADLAMP_BLINK_DEFAULT_MS 333
 
 struct headlamp_priv {
 	struct device    *dev;
 	struct gpio_desc *lamp;        
 	int               state;     
+	struct topst_dev *td;
+
+	/* LED class: trigger(timer/oneshot/pattern)가 유저 공간 루프 없이 점멸 */
+	struct led_classdev led;
+	struct mutex        lock;     /* gpio/state: ioctl, LED 콜백, blink_work */
+	struct delayed_work blink_work;
+	unsigned long       blink_on_ms;
+	unsigned long       blink_off_ms;
+	bool                blink_restart; /* blink_set 이후 첫 토글은 ON 부터 */
+	bool                blink_lit;
+	bool                blinking;      /* blink_set ~ blink_stop (runtime PM busy) */
+
+	/* 시스템 suspend 가 끈 것: resume 에서 state/seg_mask/점멸을 되돌림 */
+	bool                sys_parked;
+	bool                sys_blinking;
+	u32                 sys_mask;
+
+	/*
+	 * headlamp-segments-gpios (선택): 카메라 프레임마다 바뀌는 눈부심 방지 mask.
+	 * 전체 mask 를 gpiod_set_array_value_cansleep 한 번으로 반영하므로
+	 * 같은 GPIO 뱅크면 레지스터 write 한 번이다.
+	 */
+	struct gpio_descs  *segs;
+	struct mutex        seg_lock;   /* segs/seg_mask/통계 */
+	u32                 seg_mask;
+	u64                 seg_updates;
+	u64                 seg_lat_last_ns;    /* gpiod 호출 시간 */
+	u64                 seg_lat_max_ns;
+	u64                 seg_lat_sum_ns;
+	u64                 seg_interval_min_ns; /* 연속 갱신 최소 간격 */
+	ktime_t             seg_last;
+	ktime_t             seg_win_start;      /* 갱신률 1초 창 */
+	u32                 seg_win_updates;
+	u32                 seg_rate_hz;
 };
 
-static int            major;
-static struct class  *cls;
-static struct device *devnode;
-static struct headlamp_priv *g_priv;
+static void headlamp_blink_stop(struct headlamp_priv *priv)
+{
+	cancel_delayed_work_sync(&priv->blink_work);
+	WRITE_ONCE(priv->blinking, false);
+}
+
+static void headlamp_blink_work(struct work_struct *work)
+{
+	struct headlamp_priv *priv = container_of(to_delayed_work(work),
+						  struct headlamp_priv, blink_work);
+	unsigned long on, off;
+	bool restart;
+
+	mutex_lock(&priv->lock);
+	on  = READ_ONCE(priv->blink_on_ms);
+	off = READ_ONCE(priv->blink_off_ms);
+	restart = xchg(&priv->blink_restart, false);
+	if (restart)
+		priv->blink_lit = true;
+	else
+		priv->blink_lit = !priv->blink_lit;
+	if (on == 0 || off == 0)
+		priv->blink_lit = on != 0; /* 한쪽이 0 이면 점멸 없이 고정 */
+	gpiod_set_value_cansleep(priv->lamp, priv->blink_lit);
+	mutex_unlock(&priv->lock);
+	/* blink_set 은 atomic 일 수 있어 runtime PM 참조는 첫 토글에서 잡음 */
+	if (restart)
+		topst_pm_update(priv->td);
+
+	if (on && off)
+		schedule_delayed_work(&priv->blink_work,
+				      msecs_to_jiffies(priv->blink_lit ? on : off));
+}
+
+/* LED core 의 brightness 변경 (sysfs, trigger, 점멸 해제 시 LED_OFF) */
+static int headlamp_led_set(struct led_classdev *led, enum led_brightness value)
+{
+	struct headlamp_priv *priv = container_of(led, struct headlamp_priv, led);
+
+	headlamp_blink_stop(priv);
+
+	mutex_lock(&priv->lock);
+	priv->state = value ? 1 : 0;
+	gpiod_set_value_cansleep(priv->lamp, priv->state);
+	mutex_unlock(&priv->lock);
+	topst_pm_update(priv->td);
+	return 0;
+}
+
+/*
+ * 하드웨어 blink 는 없지만 delayed work 로 직접 토글하면 LED core 의
+ * software blink(timer → set_brightness_work → brightness_set) 보다 한 단계 짧다.
+ * trigger 에 따라 atomic context 에서 불릴 수 있으므로 여기서는 work 만 건다.
+ */
+static int headlamp_led_blink_set(struct led_classdev *led,
+				  unsigned long *delay_on, unsigned long *delay_off)
+{
+	struct headlamp_priv *priv = container_of(led, struct headlamp_priv, led);
 
-static long headlamp_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
+	if (*delay_on == 0 && *delay_off == 0)
+		*delay_on = *delay_off = HEADLAMP_BLINK_DEFAULT_MS;
+
+	WRITE_ONCE(priv->blink_on_ms, *delay_on);
+	WRITE_ONCE(priv->blink_off_ms, *delay_off);
+	WRITE_ONCE(priv->blink_restart, true);
+	WRITE_ONCE(priv->blinking, true);
+	mod_delayed_work(system_wq, &priv->blink_work, 0);
+	return 0;
+}
+
+static long headlamp_set_state(struct topst_dev *td, void *arg)
 {
+	struct headlamp_priv *priv = topst_dev_priv(td);
+	int val = *(int *)arg;
+
+	if (val != 0 && val != 1)
+		return -EINVAL;
+	/*
+	 * ioctl 은 점멸 중이어도 고정 ON/OFF 로 덮어쓴다. trigger 가 붙어 있으면
+	 * 떼어서 sysfs trigger/brightness 도 ioctl 상태와 같게 하고, 해제 때
+	 * LED core 가 work 로 건 LED_OFF 가 아래 값을 나중에 덮지 않도록 기다림
+	 */
+#ifdef CONFIG_LEDS_TRIGGERS
+	if (READ_ONCE(priv->led.trigger)) {
+		led_trigger_remove(&priv->led);
+		flush_work(&priv->led.set_brightness_work);
+	}
+#endif
+	headlamp_blink_stop(priv);
+	mutex_lock(&priv->lock);
+	if (val != priv->state)
+		topst_dev_event(td, TOPST_EV_CAUSE_IOCTL, TOPST_EV_ATTR_STATE, priv->state, val);
+	gpiod_set_value_cansleep(priv->lamp, val);
+	priv->state = val;
+	priv->led.brightness = val ? priv->led.max_brightness : LED_OFF;
+	mutex_unlock(&priv->lock);
+	topst_pm_update(td);
+	pr_debug("[headlamp_driver] ioctl: HEADLAMP %s\n", val ? "ON" : "OFF");
+	return 0;
+}
+
+static long headlamp_get_state(struct topst_dev *td, void *arg)
+{
+	struct headlamp_priv *priv = topst_dev_priv(td);
 	int val;
 
-	if (!g_priv || !g_priv->lamp)
-		return -ENODEV;
+	val = gpiod_get_value_cansleep(priv->lamp);
+	*(int *)arg = val;
+	pr_debug("[headlamp_driver] ioctl: HEADLAMP GET (%d)\n", val);
+	return 0;
+}
 
-	switch (cmd) {
-	case HEADLAMP_SET_STATE:
-		if (copy_from_user(&val, (int __user *)arg, sizeof(int)))
-			return -EFAULT;
-		if (val == 0) {
-			gpiod_set_value_cansleep(g_priv->lamp, 0);
-			g_priv->state = 0;
-			pr_info("[headlamp_driver] ioctl: HEADLAMP OFF\n");
-		} else if (val == 1) {
-			gpiod_set_value_cansleep(g_priv->lamp, 1);
-			g_priv->state = 1;
-			pr_info("[headlamp_driver] ioctl: HEADLAMP ON\n");
-		} else {
-			return -EINVAL;
-		}
-		break;
+/* 호출자가 seg_lock 을 잡고 있어야 함 */
+static int headlamp_seg_apply(struct headlamp_priv *priv, u32 mask)
+{
+	DECLARE_BITMAP(values, HEADLAMP_MAX_SEGMENTS);
+	ktime_t t0, t1;
+	u64 lat;
+	int ret;
 
-	case HEADLAMP_GET_STATE:
-		val = gpiod_get_value_cansleep(g_priv->lamp);
-		if (copy_to_user((int __user *)arg, &val, sizeof(int)))
-			return -EFAULT;
-		pr_info("[headlamp_driver] ioctl: HEADLAMP GET (%d)\n", val);
-		break;
+	bitmap_from_arr32(values, &mask, HEADLAMP_MAX_SEGMENTS);
+	t0 = ktime_get();
+	ret = gpiod_set_array_value_cansleep(priv->segs->ndescs, priv->segs->desc,
+					     priv->segs->info, values);
+	t1 = ktime_get();
+	if (ret)
+		return ret;
+
+	lat = ktime_to_ns(ktime_sub(t1, t0));
+	priv->seg_mask = mask;
+	priv->seg_updates++;
+	priv->seg_lat_last_ns = lat;
+	priv->seg_lat_sum_ns += lat;
+	if (lat > priv->seg_lat_max_ns)
+		priv->seg_lat_max_ns = lat;
+
+	if (priv->seg_updates > 1) {
+		u64 gap = ktime_to_ns(ktime_sub(t0, priv->seg_last));
+
+		if (!priv->seg_interval_min_ns || gap < priv->seg_interval_min_ns)
+			priv->seg_interval_min_ns = gap;
+	}
+	priv->seg_last = t0;
 
-	default:
-		pr_err("[headlamp_driver] ioctl: unknown cmd %u\n", cmd);
+	/* 1초마다 지난 창의 갱신 횟수로 rate 확정 */
+	priv->seg_win_updates++;
+	if (ktime_ms_delta(t1, priv->seg_win_start) >= MSEC_PER_SEC) {
+		priv->seg_rate_hz = div64_u64((u64)priv->seg_win_updates * NSEC_PER_SEC,
+					      ktime_to_ns(ktime_sub(t1, priv->seg_win_start)));
+		priv->seg_win_start = t1;
+		priv->seg_win_updates = 0;
+	}
+	return 0;
+}
+
+/*
+ * 프레임 단위로 불리므로 이벤트 로그에는 남기지 않는다 (fifo 가 바로 넘침).
+ * 갱신 횟수/지연/rate 는 sysfs segments/ 에서 본다.
+ */
+static long headlamp_set_mask(struct topst_dev *td, void *arg)
+{
+	struct headlamp_priv *priv = topst_dev_priv(td);
+	u32 mask = *(u32 *)arg;
+	int ret;
+
+	if (!priv->segs)
+		return -ENODEV;
+	if (priv->segs->ndescs < 32 && (mask >> priv->segs->ndescs))
 		return -EINVAL;
+
+	mutex_lock(&priv->seg_lock);
+	ret = headlamp_seg_apply(priv, mask);
+	mutex_unlock(&priv->seg_lock);
+	/* 프레임마다 불려도 busy 가 바뀔 때만 runtime PM 이 움직임 */
+	topst_pm_update(td);
+	return ret;
+}
+
+static long headlamp_get_mask(struct topst_dev *td, void *arg)
+{
+	struct headlamp_priv *priv = topst_dev_priv(td);
+
+	if (!priv->segs)
+		return -ENODEV;
+	*(u32 *)arg = READ_ONCE(priv->seg_mask);
+	return 0;
+}
+
+static const struct topst_ioctl headlamp_ioctls[] = {
+	TOPST_IOCTL(HEADLAMP_SET_STATE, headlamp_set_state),
+	TOPST_IOCTL(HEADLAMP_GET_STATE, headlamp_get_state),
+	TOPST_IOCTL(HEADLAMP_SET_MASK,  headlamp_set_mask),
+	TOPST_IOCTL(HEADLAMP_GET_MASK,  headlamp_get_mask),
+};
+
+static bool headlamp_busy(struct topst_dev *td)
+{
+	struct headlamp_priv *priv = topst_dev_priv(td);
+
+	return READ_ONCE(priv->state) || READ_ONCE(priv->seg_mask) ||
+	       READ_ONCE(priv->blinking);
+}
+
+static const struct topst_dev_ops headlamp_ops = {
+	.owner     = THIS_MODULE,
+	.ioctls    = headlamp_ioctls,
+	.nr_ioctls = ARRAY_SIZE(headlamp_ioctls),
+	.busy      = headlamp_busy,
+};
+
+/* ===== 전원 관리 ===== */
+static int __maybe_unused headlamp_runtime_suspend(struct device *dev)
+{
+	struct headlamp_priv *priv = dev_get_drvdata(dev);
+
+	/* 꺼져 있을 때만 오므로 램프/세그먼트 출력은 이미 0 */
+	if (headlamp_busy(priv->td))
+		return -EBUSY;
+	topst_pm_set_state(priv->td, TOPST_PARK_SUSPENDED);
+	return 0;
+}
+
+static int __maybe_unused headlamp_runtime_resume(struct device *dev)
+{
+	struct headlamp_priv *priv = dev_get_drvdata(dev);
+
+	topst_pm_set_state(priv->td, TOPST_PARK_ACTIVE);
+	return 0;
+}
+
+/* 램프와 세그먼트를 끄고, state/mask/점멸은 resume 에서 되돌리도록 남겨 둠 */
+static int __maybe_unused headlamp_suspend(struct device *dev)
+{
+	struct headlamp_priv *priv = dev_get_drvdata(dev);
+
+	if (pm_runtime_suspended(dev))
+		return 0;
+
+	priv->sys_blinking = READ_ONCE(priv->blinking);
+	cancel_delayed_work_sync(&priv->blink_work);
+	mutex_lock(&priv->lock);
+	gpiod_set_value_cansleep(priv->lamp, 0);
+	mutex_unlock(&priv->lock);
+	if (priv->segs) {
+		mutex_lock(&priv->seg_lock);
+		priv->sys_mask = priv->seg_mask;
+		headlamp_seg_apply(priv, 0);
+		mutex_unlock(&priv->seg_lock);
 	}
+	priv->sys_parked = true;
+	topst_pm_set_state(priv->td, TOPST_PARK_SUSPENDED);
 	return 0;
 }
 
-static const struct file_operations fops = {
-	.owner          = THIS_MODULE,      
-	.unlocked_ioctl = headlamp_ioctl,
-#ifdef CONFIG_COMPAT
-	.compat_ioctl   = headlamp_ioctl,
-#endif
+static int __maybe_unused headlamp_resume(struct device *dev)
+{
+	struct headlamp_priv *priv = dev_get_drvdata(dev);
+
+	if (!priv->sys_parked)
+		return 0;
+	priv->sys_parked = false;
+
+	if (priv->segs) {
+		mutex_lock(&priv->seg_lock);
+		headlamp_seg_apply(priv, priv->sys_mask);
+		mutex_unlock(&priv->seg_lock);
+	}
+	if (priv->sys_blinking) {
+		WRITE_ONCE(priv->blink_restart, true);
+		mod_delayed_work(system_wq, &priv->blink_work, 0);
+	} else {
+		mutex_lock(&priv->lock);
+		gpiod_set_value_cansleep(priv->lamp, priv->state);
+		mutex_unlock(&priv->lock);
+	}
+	topst_pm_set_state(priv->td, TOPST_PARK_ACTIVE);
+	return 0;
+}
+
+static const struct dev_pm_ops headlamp_pm_ops = {
+	SET_SYSTEM_SLEEP_PM_OPS(headlamp_suspend, headlamp_resume)
+	SET_RUNTIME_PM_OPS(headlamp_runtime_suspend, headlamp_runtime_resume, NULL)
+};
+
+/* ===== sysfs: /sys/bus/platform/devices/<headlamp>/segments/ ===== */
+#define HEADLAMP_SEG_ATTR(_name, _fmt, _field)					\
+static ssize_t _name##_show(struct device *dev, struct device_attribute *attr,	\
+			    char *buf)						\
+{										\
+	struct headlamp_priv *priv = dev_get_drvdata(dev);			\
+										\
+	return sprintf(buf, _fmt "\n", READ_ONCE(priv->_field));		\
+}										\
+static DEVICE_ATTR_RO(_name)
+
+HEADLAMP_SEG_ATTR(mask,            "0x%08x", seg_mask);
+HEADLAMP_SEG_ATTR(updates,         "%llu",   seg_updates);
+HEADLAMP_SEG_ATTR(latency_last_ns, "%llu",   seg_lat_last_ns);
+HEADLAMP_SEG_ATTR(latency_max_ns,  "%llu",   seg_lat_max_ns);
+HEADLAMP_SEG_ATTR(interval_min_ns, "%llu",   seg_interval_min_ns);
+
+static ssize_t count_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+	struct headlamp_priv *priv = dev_get_drvdata(dev);
+
+	return sprintf(buf, "%u\n", priv->segs->ndescs);
+}
+static DEVICE_ATTR_RO(count);
+
+static ssize_t latency_avg_ns_show(struct device *dev, struct device_attribute *attr,
+				   char *buf)
+{
+	struct headlamp_priv *priv = dev_get_drvdata(dev);
+	u64 sum, n;
+
+	mutex_lock(&priv->seg_lock);
+	sum = priv->seg_lat_sum_ns;
+	n   = priv->seg_updates;
+	mutex_unlock(&priv->seg_lock);
+	return sprintf(buf, "%llu\n", n ? div64_u64(sum, n) : 0);
+}
+static DEVICE_ATTR_RO(latency_avg_ns);
+
+/* 지난 1초 창의 갱신률. 갱신이 1초 이상 끊기면 0 */
+static ssize_t rate_hz_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+	struct headlamp_priv *priv = dev_get_drvdata(dev);
+	u32 rate;
+
+	mutex_lock(&priv->seg_lock);
+	rate = priv->seg_rate_hz;
+	if (!priv->seg_updates || ktime_ms_delta(ktime_get(), priv->seg_last) >= MSEC_PER_SEC)
+		rate = 0;
+	mutex_unlock(&priv->seg_lock);
+	return sprintf(buf, "%u\n", rate);
+}
+static DEVICE_ATTR_RO(rate_hz);
+
+/* echo 1 > reset_stats */
+static ssize_t reset_stats_store(struct device *dev, struct device_attribute *attr,
+				 const char *buf, size_t count)
+{
+	struct headlamp_priv *priv = dev_get_drvdata(dev);
+
+	mutex_lock(&priv->seg_lock);
+	priv->seg_updates = 0;
+	priv->seg_lat_last_ns = priv->seg_lat_max_ns = priv->seg_lat_sum_ns = 0;
+	priv->seg_interval_min_ns = 0;
+	priv->seg_win_start = ktime_get();
+	priv->seg_win_updates = 0;
+	priv->seg_rate_hz = 0;
+	mutex_unlock(&priv->seg_lock);
+	return count;
+}
+static DEVICE_ATTR_WO(reset_stats);
+
+static struct attribute *headlamp_seg_attrs[] = {
+	&dev_attr_count.attr,
+	&dev_attr_mask.attr,
+	&dev_attr_updates.attr,
+	&dev_attr_latency_last_ns.attr,
+	&dev_attr_latency_max_ns.attr,
+	&dev_attr_latency_avg_ns.attr,
+	&dev_attr_interval_min_ns.attr,
+	&dev_attr_rate_hz.attr,
+	&dev_attr_reset_stats.attr,
+	NULL,
+};
+
+static const struct attribute_group headlamp_seg_group = {
+	.name  = "segments",
+	.attrs = headlamp_seg_attrs,
 };
 
+/*
+ * DT (선택): headlamp-segments-gpios = <&gpa 0 0>, <&gpa 1 0>, ... ;  (최대 32)
+ * 배열의 n 번째 GPIO 가 mask bit n. 없으면 SET/GET_MASK 는 -ENODEV.
+ */
+static int headlamp_seg_init(struct platform_device *pdev, struct headlamp_priv *priv)
+{
+	mutex_init(&priv->seg_lock);
+	priv->segs = devm_gpiod_get_array_optional(&pdev->dev, "headlamp-segments",
+						   GPIOD_OUT_LOW);
+	if (IS_ERR(priv->segs)) {
+		dev_err(&pdev->dev, "failed to get headlamp-segments-gpios\n");
+		return PTR_ERR(priv->segs);
+	}
+	if (!priv->segs)
+		return 0;
+	if (priv->segs->ndescs > HEADLAMP_MAX_SEGMENTS) {
+		dev_err(&pdev->dev, "too many segments (%u > %d)\n",
+			priv->segs->ndescs, HEADLAMP_MAX_SEGMENTS);
+		return -EINVAL;
+	}
+	priv->seg_win_start = ktime_get();
+
+	dev_info(&pdev->dev, "%u segments%s\n", priv->segs->ndescs,
+		 priv->segs->info ? " (fast path: single bank)" : "");
+	return devm_device_add_group(&pdev->dev, &headlamp_seg_group);
+}
+
 static int headlamp_probe(struct platform_device *pdev)
 {
+	u64 t0 = topst_probe_start();
 	int ret;
 	struct headlamp_priv *priv;
 
@@ -90,41 +486,40 @@ static int headlamp_probe(struct platform_device *pdev)
 		return PTR_ERR(priv->lamp);
 	}
 	priv->state = 0; /* 기본 OFF */
+	mutex_init(&priv->lock);
+	INIT_DELAYED_WORK(&priv->blink_work, headlamp_blink_work);
 
-	/* character device 등록 */
-	if (major == 0) {
-		major = register_chrdev(0, DEVICE_NAME, &fops);
-		if (major < 0) {
-			dev_err(&pdev->dev, "register_chrdev failed: %d\n", major);
-			return major;
-		}
-	}
-	if (!cls) {
-		cls = class_create(THIS_MODULE, CLASS_NAME);
-		if (IS_ERR(cls)) {
-			ret = PTR_ERR(cls);
-			cls = NULL;
-			unregister_chrdev(major, DEVICE_NAME);
-			major = 0;
-			return ret;
-		}
-	}
-	devnode = device_create(cls, NULL, MKDEV(major, 0), NULL, DEVICE_NAME);
-	if (IS_ERR(devnode)) {
-		ret = PTR_ERR(devnode);
-		devnode = NULL;
-		class_destroy(cls);
-		cls = NULL;
-		unregister_chrdev(major, DEVICE_NAME);
-		major = 0;
+	/* sysfs 그룹이 drvdata 를 쓰므로 먼저 설정 */
+	platform_set_drvdata(pdev, priv);
+	ret = headlamp_seg_init(pdev, priv);
+	if (ret)
 		return ret;
-	}
 
-	platform_set_drvdata(pdev, priv);
-	g_priv = priv; 
+	/* LED core 가 등록 중에도 (default trigger) brightness_set 을 부르므로 td 가 먼저 */
+	priv->td = topst_dev_register(&pdev->dev, DEVICE_NAME, TOPST_EV_DEV_HEADLAMP,
+				      &headlamp_ops, priv);
+	if (IS_ERR(priv->td))
+		return PTR_ERR(priv->td);
+	topst_pm_enable(priv->td, false);
+
+	/* /sys/class/leds/<label>, 예: echo timer > .../trigger */
+	priv->led.name = "headlamp";
+	of_property_read_string(pdev->dev.of_node, "label", &priv->led.name);
+	priv->led.default_trigger =
+		of_get_property(pdev->dev.of_node, "linux,default-trigger", NULL);
+	priv->led.max_brightness          = 1;
+	priv->led.brightness_set_blocking = headlamp_led_set;
+	priv->led.blink_set               = headlamp_led_blink_set;
+	ret = led_classdev_register(&pdev->dev, &priv->led);
+	if (ret) {
+		dev_err(&pdev->dev, "led_classdev register failed: %d\n", ret);
+		topst_pm_disable(priv->td);
+		topst_dev_unregister(priv->td);
+		return ret;
+	}
 
-	dev_info(&pdev->dev, "headlamp driver probed, /dev/%s (major=%d)\n",
-	         DEVICE_NAME, major);
+	dev_info(&pdev->dev, "headlamp driver probed, /dev/%s\n", DEVICE_NAME);
+	topst_dev_ready(priv->td, t0);
 	return 0;
 }
 
@@ -132,23 +527,22 @@ static int headlamp_remove(struct platform_device *pdev)
 {
 	struct headlamp_priv *priv = platform_get_drvdata(pdev);
 
-	/* 안전하게 OFF */
-	if (priv && priv->lamp)
+	/*
+	 * sysfs/trigger/blink work 가 td 를 쓰므로 LED class 를 먼저 내리고
+	 * (해제하며 LED_OFF) 점멸 work 까지 끝낸 뒤 ioctl 을 막고 안전하게 OFF
+	 */
+	if (priv) {
+		led_classdev_unregister(&priv->led);
+		headlamp_blink_stop(priv);
+		topst_pm_disable(priv->td);
+		topst_dev_unregister(priv->td);
 		gpiod_set_value_cansleep(priv->lamp, 0);
-
-	if (devnode) {
-		device_destroy(cls, MKDEV(major, 0));
-		devnode = NULL;
-	}
-	if (cls) {
-		class_destroy(cls);
-		cls = NULL;
-	}
-	if (major > 0) {
-		unregister_chrdev(major, DEVICE_NAME);
-		major = 0;
+		if (priv->segs) {
+			mutex_lock(&priv->seg_lock);
+			headlamp_seg_apply(priv, 0);
+			mutex_unlock(&priv->seg_lock);
+		}
 	}
-	g_priv = NULL;
 
 	dev_info(&pdev->dev, "headlamp driver removed\n");
 	return 0;
@@ -167,10 +561,12 @@ static struct platform_driver headlamp_platdrv = {
 	.driver = {
 		.name           = "telechips-headlamp",
 		.of_match_table = headlamp_of_match,
+		.probe_type     = PROBE_PREFER_ASYNCHRONOUS,
+		.pm             = &headlamp_pm_ops,
 	},
 };
 
-module_platform_driver(headlamp_platdrv);
+topst_platform_driver(headlamp_platdrv);
 
 MODULE_LICENSE("GPL");
 MODULE_AUTHOR("JSY Project");
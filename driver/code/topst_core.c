@@ -0,0 +1,907 @@
+// drivers/mytopst/topst_core.c
+// SPDX-License-Identifier: GPL-2.0
+#include <linux/module.h>
+#include <linux/init.h>
+#include <linux/fs.h>
+#include <linux/cdev.h>
+#include <linux/device.h>
+#include <linux/idr.h>
+#include <linux/math64.h>
+#include <linux/mutex.h>
+#include <linux/percpu.h>
+#include <linux/pm_runtime.h>
+#include <linux/property.h>
+#include <linux/slab.h>
+#include <linux/suspend.h>
+#include <linux/uaccess.h>
+#include "topst_core.h"
+
+#define CREATE_TRACE_POINTS
+#include "topst_trace.h"
+
+static dev_t          topst_devt;
+static struct class  *topst_class;
+static DEFINE_IDR(topst_minors);
+static DEFINE_MUTEX(topst_minor_lock);   /* topst_minors, open 시 kref 획득 */
+
+/* 시스템 suspend 직전 데몬 park 대기 */
+static DECLARE_WAIT_QUEUE_HEAD(topst_park_wq);
+static atomic_t topst_parking = ATOMIC_INIT(0);   /* PARKING 상태인 장치 수 */
+static unsigned int park_timeout_ms = 300;
+module_param(park_timeout_ms, uint, 0644);
+MODULE_PARM_DESC(park_timeout_ms, "system suspend: max wait for daemons to park (ms)");
+
+static void topst_dev_free(struct kref *kref)
+{
+	struct topst_dev *td = container_of(kref, struct topst_dev, kref);
+
+	percpu_free_rwsem(&td->rwsem);
+	free_percpu(td->stats.pcpu);
+	kfree(td);
+}
+
+/* ===== 공통 file_operations ===== */
+static int topst_open(struct inode *inode, struct file *file)
+{
+	struct topst_dev *td;
+	int ret = 0;
+
+	mutex_lock(&topst_minor_lock);
+	td = idr_find(&topst_minors, iminor(inode));
+	if (td)
+		kref_get(&td->kref);
+	mutex_unlock(&topst_minor_lock);
+	if (!td)
+		return -ENODEV;
+
+	percpu_down_read(&td->rwsem);
+	if (td->dead)
+		ret = -ENODEV;
+	else if (td->ops->open)
+		ret = td->ops->open(td);
+	percpu_up_read(&td->rwsem);
+
+	if (ret) {
+		kref_put(&td->kref, topst_dev_free);
+		return ret;
+	}
+	atomic_inc(&td->stats.opens);
+	atomic_inc(&td->users);
+	file->private_data = td;
+	return stream_open(inode, file);
+}
+
+static int topst_release(struct inode *inode, struct file *file)
+{
+	struct topst_dev *td = file->private_data;
+
+	percpu_down_read(&td->rwsem);
+	if (!td->dead && td->ops->release)
+		td->ops->release(td);
+	percpu_up_read(&td->rwsem);
+
+	atomic_dec(&td->users);
+	kref_put(&td->kref, topst_dev_free);
+	return 0;
+}
+
+static ssize_t topst_read(struct file *file, char __user *buf, size_t count, loff_t *ppos)
+{
+	struct topst_dev *td = file->private_data;
+
+	return topst_evlog_read(&td->evlog, file, buf, count);
+}
+
+static __poll_t topst_poll(struct file *file, poll_table *wait)
+{
+	struct topst_dev *td = file->private_data;
+
+	return topst_evlog_poll(&td->evlog, file, wait);
+}
+
+static bool topst_ioctl_match(const struct topst_ioctl *ent, unsigned int cmd)
+{
+	if (ent->size)
+		return (ent->cmd & ~IOCSIZE_MASK) == (cmd & ~IOCSIZE_MASK);
+	return ent->cmd == cmd;
+}
+
+static void topst_stats_ioctl(struct topst_stats *st, long ret, u64 ns)
+{
+	struct topst_pcpu_stats *pc = get_cpu_ptr(st->pcpu);
+
+	u64_stats_update_begin(&pc->syncp);
+	pc->ioctls++;
+	if (ret)
+		pc->ioctl_errors++;
+	pc->ioctl_ns_sum += ns;
+	if (ns > pc->ioctl_ns_max)
+		pc->ioctl_ns_max = ns;
+	u64_stats_update_end(&pc->syncp);
+	put_cpu_ptr(st->pcpu);
+}
+
+/* sysfs 용 CPU 합산 (max 는 CPU 별 max 의 max) */
+static void topst_stats_sum(struct topst_stats *st, struct topst_pcpu_stats *sum)
+{
+	int cpu;
+
+	memset(sum, 0, sizeof(*sum));
+	for_each_possible_cpu(cpu) {
+		const struct topst_pcpu_stats *pc = per_cpu_ptr(st->pcpu, cpu);
+		u64 ioctls, errors, ns_sum, ns_max;
+		unsigned int start;
+
+		do {
+			start  = u64_stats_fetch_begin(&pc->syncp);
+			ioctls = pc->ioctls;
+			errors = pc->ioctl_errors;
+			ns_sum = pc->ioctl_ns_sum;
+			ns_max = pc->ioctl_ns_max;
+		} while (u64_stats_fetch_retry(&pc->syncp, start));
+
+		sum->ioctls       += ioctls;
+		sum->ioctl_errors += errors;
+		sum->ioctl_ns_sum += ns_sum;
+		sum->ioctl_ns_max  = max(sum->ioctl_ns_max, ns_max);
+	}
+}
+
+static long topst_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
+{
+	struct topst_dev *td = file->private_data;
+	const struct topst_ioctl *ent = NULL;
+	void __user *uarg = (void __user *)arg;
+	u8 kbuf[TOPST_IOCTL_MAX_ARG];
+	unsigned int i, size;
+	u64 t0, ns;
+	long ret;
+
+	for (i = 0; i < td->ops->nr_ioctls; i++) {
+		if (topst_ioctl_match(&td->ops->ioctls[i], cmd)) {
+			ent = &td->ops->ioctls[i];
+			break;
+		}
+	}
+	if (!ent)
+		return -ENOTTY;
+
+	size = ent->size ? ent->size : _IOC_SIZE(cmd);
+	if (WARN_ON_ONCE(size > sizeof(kbuf)))
+		return -EINVAL;
+	if (_IOC_DIR(cmd) & _IOC_WRITE) {
+		if (copy_from_user(kbuf, uarg, size))
+			return -EFAULT;
+	} else {
+		memset(kbuf, 0, size);
+	}
+
+	percpu_down_read(&td->rwsem);
+	if (td->dead) {
+		percpu_up_read(&td->rwsem);
+		return -ENODEV;
+	}
+	t0  = ktime_get_ns();
+	ret = ent->fn(td, kbuf);
+	ns  = ktime_get_ns() - t0;
+	percpu_up_read(&td->rwsem);
+
+	topst_stats_ioctl(&td->stats, ret, ns);
+	trace_topst_ioctl(td->name, cmd, ret, ns);
+
+	if (!ret && (_IOC_DIR(cmd) & _IOC_READ) && copy_to_user(uarg, kbuf, size))
+		return -EFAULT;
+	return ret;
+}
+
+/* ===== SET 명령 mailbox ===== */
+static void topst_mbox_flush(struct topst_dev *td)
+{
+	struct topst_mbox *mb = &td->mbox;
+	s32 val;
+
+	mutex_lock(&mb->apply_lock);
+	spin_lock(&mb->lock);
+	if (!mb->has_pending) {
+		spin_unlock(&mb->lock);
+		mutex_unlock(&mb->apply_lock);
+		return;
+	}
+	val = mb->pending;
+	mb->has_pending   = false;
+	mb->applying      = true;
+	mb->inflight      = val;
+	mb->last_apply_ns = ktime_get_ns();
+	mb->applied++;
+	spin_unlock(&mb->lock);
+
+	td->ops->apply(td, val);
+
+	spin_lock(&mb->lock);
+	mb->applying = false;
+	spin_unlock(&mb->lock);
+	mutex_unlock(&mb->apply_lock);
+}
+
+static void topst_mbox_work(struct work_struct *work)
+{
+	struct topst_mbox *mb = container_of(to_delayed_work(work), struct topst_mbox, work);
+
+	topst_mbox_flush(container_of(mb, struct topst_dev, mbox));
+}
+
+int topst_mbox_post(struct topst_dev *td, s32 val)
+{
+	struct topst_mbox *mb = &td->mbox;
+	bool apply_now = false;
+	s32 ref;
+	u64 now, due;
+
+	if (WARN_ON_ONCE(!td->ops->apply))
+		return -EINVAL;
+
+	spin_lock(&mb->lock);
+	mb->posted++;
+	/* 마지막으로 보게 될 값과 비교: 대기 중 > 적용 중 > 현재 하드웨어 상태 */
+	ref = mb->has_pending ? mb->pending : mb->applying ? mb->inflight : td->ops->state(td);
+	if (val == ref) {
+		mb->redundant++;
+		spin_unlock(&mb->lock);
+		return 0;
+	}
+	if (mb->has_pending)
+		mb->coalesced++;
+	mb->pending     = val;
+	mb->has_pending = true;
+
+	now = ktime_get_ns();
+	due = mb->last_apply_ns + (u64)READ_ONCE(mb->min_interval_us) * NSEC_PER_USEC;
+	if (now < due && !(td->ops->urgent && td->ops->urgent(td, val))) {
+		/* 이미 예약돼 있으면 그대로 (due 는 마지막 apply 기준이라 같음) */
+		schedule_delayed_work(&mb->work, nsecs_to_jiffies(due - now) + 1);
+	} else {
+		/* 대기 값은 아래에서 바로 적용하므로 예약된 apply 는 할 일이 없음 */
+		cancel_delayed_work(&mb->work);
+		apply_now = true;
+	}
+	spin_unlock(&mb->lock);
+
+	if (apply_now)
+		topst_mbox_flush(td);
+	return 0;
+}
+EXPORT_SYMBOL_GPL(topst_mbox_post);
+
+static void topst_mbox_init(struct topst_dev *td, struct device *parent)
+{
+	struct topst_mbox *mb = &td->mbox;
+
+	spin_lock_init(&mb->lock);
+	mutex_init(&mb->apply_lock);
+	INIT_DELAYED_WORK(&mb->work, topst_mbox_work);
+	mb->min_interval_us = td->ops->min_interval_us;
+	if (parent)
+		device_property_read_u32(parent, "min-apply-interval-us", &mb->min_interval_us);
+}
+
+/* ===== 전원 관리 ===== */
+static const char *const topst_park_names[] = {
+	[TOPST_PARK_ACTIVE]    = "active",
+	[TOPST_PARK_PARKING]   = "parking",
+	[TOPST_PARK_PARKED]    = "parked",
+	[TOPST_PARK_SUSPENDED] = "suspended",
+};
+
+static void topst_pm_init(struct topst_dev *td, struct device *parent)
+{
+	struct topst_pm *pm = &td->pm;
+
+	pm->dev = parent;
+	mutex_init(&pm->lock);
+	spin_lock_init(&pm->state_lock);
+	pm->state    = TOPST_PARK_ACTIVE;
+	pm->state_ns = ktime_get_ns();
+}
+
+void topst_pm_set_state(struct topst_dev *td, int state)
+{
+	struct topst_pm *pm = &td->pm;
+	u64 now = ktime_get_ns();
+	int old;
+
+	spin_lock(&pm->state_lock);
+	old = pm->state;
+	if (old == state) {
+		spin_unlock(&pm->state_lock);
+		return;
+	}
+	if (old == TOPST_PARK_SUSPENDED) {
+		pm->suspended_ns += now - pm->state_ns;
+		pm->resumes++;
+	}
+	if (state == TOPST_PARK_SUSPENDED)
+		pm->suspends++;
+	pm->state    = state;
+	pm->state_ns = now;
+	spin_unlock(&pm->state_lock);
+
+	if (state == TOPST_PARK_PARKING)
+		atomic_inc(&topst_parking);
+	if (old == TOPST_PARK_PARKING && atomic_dec_and_test(&topst_parking))
+		wake_up(&topst_park_wq);
+
+	topst_dev_event(td, TOPST_EV_CAUSE_PM, TOPST_EV_ATTR_PARK, old, state);
+	sysfs_notify(&td->dev->kobj, "park", "state");
+}
+EXPORT_SYMBOL_GPL(topst_pm_set_state);
+
+void topst_pm_update(struct topst_dev *td)
+{
+	struct topst_pm *pm = &td->pm;
+	bool busy;
+
+	mutex_lock(&pm->lock);
+	if (!pm->enabled)
+		goto out;
+	busy = td->ops->busy(td);
+	if (busy && !pm->held) {
+		/* runtime_resume 콜백이 바로 불림: 드라이버는 이 함수를 자기 잠금 밖에서 부를 것 */
+		pm_runtime_get_sync(pm->dev);
+		pm->held = true;
+	} else if (!busy && pm->held) {
+		pm_runtime_mark_last_busy(pm->dev);
+		pm_runtime_put_autosuspend(pm->dev);
+		pm->held = false;
+	}
+out:
+	mutex_unlock(&pm->lock);
+}
+EXPORT_SYMBOL_GPL(topst_pm_update);
+
+int topst_pm_enable(struct topst_dev *td, bool user_park)
+{
+	struct topst_pm *pm = &td->pm;
+	u32 delay = TOPST_PM_AUTOSUSPEND_MS;
+
+	if (WARN_ON_ONCE(!td->ops->busy))
+		return -EINVAL;
+	device_property_read_u32(pm->dev, "autosuspend-delay-ms", &delay);
+
+	pm->user_park = user_park;
+	pm_runtime_set_active(pm->dev);
+	pm_runtime_set_autosuspend_delay(pm->dev, delay);
+	pm_runtime_use_autosuspend(pm->dev);
+	pm_runtime_enable(pm->dev);
+
+	mutex_lock(&pm->lock);
+	pm->enabled = true;
+	mutex_unlock(&pm->lock);
+	topst_pm_update(td);
+
+	/* 처음부터 멈춰 있으면 delay 뒤 suspend */
+	pm_runtime_mark_last_busy(pm->dev);
+	pm_request_autosuspend(pm->dev);
+	return 0;
+}
+EXPORT_SYMBOL_GPL(topst_pm_enable);
+
+void topst_pm_disable(struct topst_dev *td)
+{
+	struct topst_pm *pm = &td->pm;
+
+	mutex_lock(&pm->lock);
+	if (!pm->enabled) {
+		mutex_unlock(&pm->lock);
+		return;
+	}
+	pm->enabled = false;
+	if (pm->held) {
+		pm_runtime_put_noidle(pm->dev);
+		pm->held = false;
+	}
+	mutex_unlock(&pm->lock);
+
+	pm_runtime_disable(pm->dev);
+	pm_runtime_dont_use_autosuspend(pm->dev);
+}
+EXPORT_SYMBOL_GPL(topst_pm_disable);
+
+/* 시스템 suspend 직전: 데몬이 구동하는 장치에 parking 을 알리고 park 완료를 기다림 */
+static void topst_park_begin(void)
+{
+	struct topst_dev *td;
+	int id;
+
+	mutex_lock(&topst_minor_lock);
+	idr_for_each_entry(&topst_minors, td, id) {
+		/* 장치를 연 프로세스가 없으면 기다릴 상대도 없음 */
+		if (!td || !td->pm.user_park || !atomic_read(&td->users))
+			continue;
+		if (READ_ONCE(td->pm.state) == TOPST_PARK_ACTIVE)
+			topst_pm_set_state(td, TOPST_PARK_PARKING);
+	}
+	mutex_unlock(&topst_minor_lock);
+
+	if (!wait_event_timeout(topst_park_wq, atomic_read(&topst_parking) == 0,
+				msecs_to_jiffies(READ_ONCE(park_timeout_ms)))) {
+		mutex_lock(&topst_minor_lock);
+		idr_for_each_entry(&topst_minors, td, id) {
+			if (td && READ_ONCE(td->pm.state) == TOPST_PARK_PARKING) {
+				td->pm.park_timeouts++;
+				pr_warn("topst: %s: daemon did not park in %u ms\n",
+					td->name, park_timeout_ms);
+			}
+		}
+		mutex_unlock(&topst_minor_lock);
+	}
+}
+
+/* suspend 가 취소됐거나 드라이버가 suspend 하지 않은 장치는 다시 active */
+static void topst_park_end(void)
+{
+	struct topst_dev *td;
+	int id;
+
+	mutex_lock(&topst_minor_lock);
+	idr_for_each_entry(&topst_minors, td, id) {
+		int st = td ? READ_ONCE(td->pm.state) : TOPST_PARK_ACTIVE;
+
+		if (st == TOPST_PARK_PARKING || st == TOPST_PARK_PARKED)
+			topst_pm_set_state(td, TOPST_PARK_ACTIVE);
+	}
+	mutex_unlock(&topst_minor_lock);
+}
+
+static int topst_pm_notify(struct notifier_block *nb, unsigned long action, void *data)
+{
+	switch (action) {
+	case PM_SUSPEND_PREPARE:
+	case PM_HIBERNATION_PREPARE:
+		topst_park_begin();
+		break;
+	case PM_POST_SUSPEND:
+	case PM_POST_HIBERNATION:
+		topst_park_end();
+		break;
+	}
+	return NOTIFY_DONE;
+}
+
+static struct notifier_block topst_pm_nb = {
+	.notifier_call = topst_pm_notify,
+};
+
+static const struct file_operations topst_fops = {
+	.owner          = THIS_MODULE,
+	.open           = topst_open,
+	.release        = topst_release,
+	.read           = topst_read,
+	.poll           = topst_poll,
+	.unlocked_ioctl = topst_ioctl,
+#ifdef CONFIG_COMPAT
+	.compat_ioctl   = topst_ioctl,
+#endif
+	.llseek         = no_llseek,
+};
+
+/* ===== sysfs: /sys/class/topst/<name>/stats/ ===== */
+#define TOPST_STAT_ATTR(_name, _expr)						\
+static ssize_t _name##_show(struct device *dev, struct device_attribute *attr,	\
+			    char *buf)						\
+{										\
+	struct topst_dev *td = dev_get_drvdata(dev);				\
+										\
+	return sprintf(buf, "%lld\n", (long long)(_expr));			\
+}										\
+static DEVICE_ATTR_RO(_name)
+
+/* CPU 별 ioctl 통계를 합산해서 보여 주는 항목 */
+#define TOPST_PCPU_STAT_ATTR(_name, _expr)					\
+static ssize_t _name##_show(struct device *dev, struct device_attribute *attr,	\
+			    char *buf)						\
+{										\
+	struct topst_dev *td = dev_get_drvdata(dev);				\
+	struct topst_pcpu_stats s;						\
+										\
+	topst_stats_sum(&td->stats, &s);					\
+	return sprintf(buf, "%llu\n", (unsigned long long)(_expr));		\
+}										\
+static DEVICE_ATTR_RO(_name)
+
+TOPST_PCPU_STAT_ATTR(ioctls,       s.ioctls);
+TOPST_PCPU_STAT_ATTR(ioctl_errors, s.ioctl_errors);
+TOPST_PCPU_STAT_ATTR(ioctl_max_ns, s.ioctl_ns_max);
+TOPST_PCPU_STAT_ATTR(ioctl_avg_ns, s.ioctls ? div64_u64(s.ioctl_ns_sum, s.ioctls) : 0);
+TOPST_STAT_ATTR(events,         atomic64_read(&td->stats.events));
+TOPST_STAT_ATTR(event_overflow, READ_ONCE(td->evlog.overflow));
+TOPST_STAT_ATTR(opens,          atomic_read(&td->stats.opens));
+TOPST_STAT_ATTR(probe_ns,       READ_ONCE(td->stats.probe_ns));
+TOPST_STAT_ATTR(ready_ns,       READ_ONCE(td->stats.ready_ns));
+
+static struct attribute *topst_stats_attrs[] = {
+	&dev_attr_ioctls.attr,
+	&dev_attr_ioctl_errors.attr,
+	&dev_attr_ioctl_max_ns.attr,
+	&dev_attr_ioctl_avg_ns.attr,
+	&dev_attr_events.attr,
+	&dev_attr_event_overflow.attr,
+	&dev_attr_opens.attr,
+	&dev_attr_probe_ns.attr,
+	&dev_attr_ready_ns.attr,
+	NULL,
+};
+
+static const struct attribute_group topst_stats_group = {
+	.name  = "stats",
+	.attrs = topst_stats_attrs,
+};
+
+/* /sys/class/topst/<name>/mailbox/ (ops->apply 가 있는 장치만) */
+#define TOPST_MBOX_ATTR(_name)							\
+static ssize_t mbox_##_name##_show(struct device *dev,				\
+				   struct device_attribute *attr, char *buf)	\
+{										\
+	struct topst_dev *td = dev_get_drvdata(dev);				\
+										\
+	return sprintf(buf, "%llu\n", (unsigned long long)READ_ONCE(td->mbox._name)); \
+}										\
+static struct device_attribute dev_attr_mbox_##_name = __ATTR(_name, 0444, mbox_##_name##_show, NULL)
+
+TOPST_MBOX_ATTR(posted);
+TOPST_MBOX_ATTR(applied);
+TOPST_MBOX_ATTR(coalesced);
+TOPST_MBOX_ATTR(redundant);
+
+static ssize_t min_interval_us_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+	struct topst_dev *td = dev_get_drvdata(dev);
+
+	return sprintf(buf, "%u\n", READ_ONCE(td->mbox.min_interval_us));
+}
+
+static ssize_t min_interval_us_store(struct device *dev, struct device_attribute *attr,
+				     const char *buf, size_t count)
+{
+	struct topst_dev *td = dev_get_drvdata(dev);
+	u32 us;
+	int ret;
+
+	ret = kstrtou32(buf, 0, &us);
+	if (ret)
+		return ret;
+	WRITE_ONCE(td->mbox.min_interval_us, us);
+	return count;
+}
+static DEVICE_ATTR_RW(min_interval_us);
+
+/* echo 1 > reset_stats */
+static ssize_t reset_stats_store(struct device *dev, struct device_attribute *attr,
+				 const char *buf, size_t count)
+{
+	struct topst_dev *td = dev_get_drvdata(dev);
+
+	spin_lock(&td->mbox.lock);
+	td->mbox.posted    = 0;
+	td->mbox.applied   = 0;
+	td->mbox.coalesced = 0;
+	td->mbox.redundant = 0;
+	spin_unlock(&td->mbox.lock);
+	return count;
+}
+static DEVICE_ATTR_WO(reset_stats);
+
+static struct attribute *topst_mbox_attrs[] = {
+	&dev_attr_mbox_posted.attr,
+	&dev_attr_mbox_applied.attr,
+	&dev_attr_mbox_coalesced.attr,
+	&dev_attr_mbox_redundant.attr,
+	&dev_attr_min_interval_us.attr,
+	&dev_attr_reset_stats.attr,
+	NULL,
+};
+
+static umode_t topst_mbox_visible(struct kobject *kobj, struct attribute *attr, int n)
+{
+	struct topst_dev *td = dev_get_drvdata(kobj_to_dev(kobj));
+
+	return td->ops->apply ? attr->mode : 0;
+}
+
+static const struct attribute_group topst_mbox_group = {
+	.name       = "mailbox",
+	.attrs      = topst_mbox_attrs,
+	.is_visible = topst_mbox_visible,
+};
+
+/* /sys/class/topst/<name>/park/ (ops->busy 가 있는 장치만) */
+static ssize_t state_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+	struct topst_dev *td = dev_get_drvdata(dev);
+
+	return sprintf(buf, "%s\n", topst_park_names[READ_ONCE(td->pm.state)]);
+}
+
+/* 데몬: parking 을 받고 park 를 마치면 echo parked > state */
+static ssize_t state_store(struct device *dev, struct device_attribute *attr,
+			   const char *buf, size_t count)
+{
+	struct topst_dev *td = dev_get_drvdata(dev);
+
+	if (!sysfs_streq(buf, "parked"))
+		return -EINVAL;
+	if (READ_ONCE(td->pm.state) == TOPST_PARK_PARKING)
+		topst_pm_set_state(td, TOPST_PARK_PARKED);
+	return count;
+}
+static DEVICE_ATTR_RW(state);
+
+#define TOPST_PM_ATTR(_name, _expr)						\
+static ssize_t pm_##_name##_show(struct device *dev,				\
+				 struct device_attribute *attr, char *buf)	\
+{										\
+	struct topst_dev *td = dev_get_drvdata(dev);				\
+	struct topst_pm *pm = &td->pm;						\
+	u64 v;									\
+										\
+	spin_lock(&pm->state_lock);						\
+	v = (_expr);								\
+	spin_unlock(&pm->state_lock);						\
+	return sprintf(buf, "%llu\n", (unsigned long long)v);			\
+}										\
+static struct device_attribute dev_attr_pm_##_name = __ATTR(_name, 0444, pm_##_name##_show, NULL)
+
+TOPST_PM_ATTR(suspends,      pm->suspends);
+TOPST_PM_ATTR(resumes,       pm->resumes);
+TOPST_PM_ATTR(park_timeouts, pm->park_timeouts);
+TOPST_PM_ATTR(suspended_ms,  div_u64(pm->suspended_ns + (pm->state == TOPST_PARK_SUSPENDED ?
+					ktime_get_ns() - pm->state_ns : 0), NSEC_PER_MSEC));
+
+static struct attribute *topst_park_attrs[] = {
+	&dev_attr_state.attr,
+	&dev_attr_pm_suspends.attr,
+	&dev_attr_pm_resumes.attr,
+	&dev_attr_pm_park_timeouts.attr,
+	&dev_attr_pm_suspended_ms.attr,
+	NULL,
+};
+
+static umode_t topst_park_visible(struct kobject *kobj, struct attribute *attr, int n)
+{
+	struct topst_dev *td = dev_get_drvdata(kobj_to_dev(kobj));
+
+	return td->ops->busy ? attr->mode : 0;
+}
+
+static const struct attribute_group topst_park_group = {
+	.name       = "park",
+	.attrs      = topst_park_attrs,
+	.is_visible = topst_park_visible,
+};
+
+static const struct attribute_group *topst_dev_groups[] = {
+	&topst_stats_group,
+	&topst_mbox_group,
+	&topst_park_group,
+	NULL,
+};
+
+/* ===== 드라이버용 API ===== */
+struct topst_dev *topst_dev_register(struct device *parent, const char *name, u16 ev_device,
+				     const struct topst_dev_ops *ops, void *priv)
+{
+	struct topst_dev *td;
+	int ret, cpu;
+
+	td = kzalloc(sizeof(*td), GFP_KERNEL);
+	if (!td)
+		return ERR_PTR(-ENOMEM);
+
+	strscpy(td->name, name, sizeof(td->name));
+	td->ops  = ops;
+	td->priv = priv;
+	td->stats.pcpu = alloc_percpu(struct topst_pcpu_stats);
+	if (!td->stats.pcpu) {
+		kfree(td);
+		return ERR_PTR(-ENOMEM);
+	}
+	for_each_possible_cpu(cpu)
+		u64_stats_init(&per_cpu_ptr(td->stats.pcpu, cpu)->syncp);
+	ret = percpu_init_rwsem(&td->rwsem);
+	if (ret) {
+		free_percpu(td->stats.pcpu);
+		kfree(td);
+		return ERR_PTR(ret);
+	}
+	kref_init(&td->kref);
+	topst_evlog_init(&td->evlog, ev_device);
+	if (ops->apply)
+		topst_mbox_init(td, parent);
+	topst_pm_init(td, parent);
+
+	mutex_lock(&topst_minor_lock);
+	td->minor = idr_alloc(&topst_minors, NULL, 0, TOPST_MAX_MINORS, GFP_KERNEL);
+	mutex_unlock(&topst_minor_lock);
+	if (td->minor < 0) {
+		ret = td->minor;
+		goto err_free;
+	}
+
+	td->cdev = cdev_alloc();
+	if (!td->cdev) {
+		ret = -ENOMEM;
+		goto err_minor;
+	}
+	td->cdev->ops   = &topst_fops;
+	td->cdev->owner = ops->owner;
+	ret = cdev_add(td->cdev, MKDEV(MAJOR(topst_devt), td->minor), 1);
+	if (ret) {
+		kobject_put(&td->cdev->kobj);
+		goto err_minor;
+	}
+
+	td->dev = device_create_with_groups(topst_class, parent,
+					    MKDEV(MAJOR(topst_devt), td->minor), td,
+					    topst_dev_groups, "%s", td->name);
+	if (IS_ERR(td->dev)) {
+		ret = PTR_ERR(td->dev);
+		goto err_cdev;
+	}
+
+	/* 여기서부터 open 가능 */
+	mutex_lock(&topst_minor_lock);
+	idr_replace(&topst_minors, td, td->minor);
+	mutex_unlock(&topst_minor_lock);
+	return td;
+
+err_cdev:
+	cdev_del(td->cdev);
+err_minor:
+	mutex_lock(&topst_minor_lock);
+	idr_remove(&topst_minors, td->minor);
+	mutex_unlock(&topst_minor_lock);
+err_free:
+	kref_put(&td->kref, topst_dev_free);
+	return ERR_PTR(ret);
+}
+EXPORT_SYMBOL_GPL(topst_dev_register);
+
+void topst_dev_unregister(struct topst_dev *td)
+{
+	mutex_lock(&topst_minor_lock);
+	idr_remove(&topst_minors, td->minor);
+	mutex_unlock(&topst_minor_lock);
+
+	percpu_down_write(&td->rwsem);
+	td->dead = true;
+	percpu_up_write(&td->rwsem);
+	/* 더 이상 post 가 없으니 예약된 apply 만 정리 (대기 중인 값은 버림) */
+	if (td->ops->apply)
+		cancel_delayed_work_sync(&td->mbox.work);
+	topst_evlog_shutdown(&td->evlog);
+
+	device_destroy(topst_class, MKDEV(MAJOR(topst_devt), td->minor));
+	cdev_del(td->cdev);
+	kref_put(&td->kref, topst_dev_free);
+}
+EXPORT_SYMBOL_GPL(topst_dev_unregister);
+
+void topst_dev_ready(struct topst_dev *td, u64 t0)
+{
+	u64 now = ktime_get_boottime_ns();
+
+	td->stats.probe_ns = now - t0;
+	td->stats.ready_ns = now;
+	pr_info("topst: %s ready at %llu.%06llu s (probe %llu us)\n", td->name,
+		now / NSEC_PER_SEC, (now % NSEC_PER_SEC) / NSEC_PER_USEC,
+		td->stats.probe_ns / NSEC_PER_USEC);
+}
+EXPORT_SYMBOL_GPL(topst_dev_ready);
+
+void topst_dev_event(struct topst_dev *td, u16 cause, u16 attr, s32 old_val, s32 new_val)
+{
+	topst_evlog_push(&td->evlog, cause, attr, old_val, new_val);
+	atomic64_inc(&td->stats.events);
+	trace_topst_event(td->name, cause, attr, old_val, new_val);
+}
+EXPORT_SYMBOL_GPL(topst_dev_event);
+
+/* 기존 misc 장치(aircon/wiper)와 같은 권한 */
+static char *topst_devnode(struct device *dev, umode_t *mode)
+{
+	if (mode)
+		*mode = 0666;
+	return NULL;
+}
+
+#ifdef TOPST_BODY
+/* topst_body.ko / built-in: 포함된 드라이버 목록 (Makefile 이 TOPST_BODY_* 정의) */
+extern struct platform_driver *const topst_body_ambient_platdrv;
+extern struct platform_driver *const topst_body_wiper_driver;
+extern struct platform_driver *const topst_body_window_platdrv;
+extern struct platform_driver *const topst_body_aircon_platdrv;
+extern struct platform_driver *const topst_body_headlamp_platdrv;
+
+static unsigned int topst_body_drivers(struct platform_driver **drv)
+{
+	unsigned int n = 0;
+
+#ifdef TOPST_BODY_WIPER
+	drv[n++] = topst_body_wiper_driver;
+#endif
+#ifdef TOPST_BODY_HEADLAMP
+	drv[n++] = topst_body_headlamp_platdrv;
+#endif
+#ifdef TOPST_BODY_AMBIENT
+	drv[n++] = topst_body_ambient_platdrv;
+#endif
+#ifdef TOPST_BODY_WINDOW
+	drv[n++] = topst_body_window_platdrv;
+#endif
+#ifdef TOPST_BODY_AIRCON
+	drv[n++] = topst_body_aircon_platdrv;
+#endif
+	return n;
+}
+#endif
+
+static int __init topst_core_init(void)
+{
+	int ret;
+#ifdef TOPST_BODY
+	struct platform_driver *drv[5];
+	unsigned int n;
+#endif
+
+	ret = alloc_chrdev_region(&topst_devt, 0, TOPST_MAX_MINORS, "topst");
+	if (ret)
+		return ret;
+
+	topst_class = class_create(THIS_MODULE, "topst");
+	if (IS_ERR(topst_class)) {
+		unregister_chrdev_region(topst_devt, TOPST_MAX_MINORS);
+		return PTR_ERR(topst_class);
+	}
+	topst_class->devnode = topst_devnode;
+
+	pr_info("topst_core: major %d, %d minors\n", MAJOR(topst_devt), TOPST_MAX_MINORS);
+	ret = register_pm_notifier(&topst_pm_nb);
+	if (ret) {
+		class_destroy(topst_class);
+		unregister_chrdev_region(topst_devt, TOPST_MAX_MINORS);
+		return ret;
+	}
+
+#ifdef TOPST_BODY
+	/* probe 는 PROBE_PREFER_ASYNCHRONOUS 라 여기서 기다리지 않는다 */
+	n = topst_body_drivers(drv);
+	ret = platform_register_drivers(drv, n);
+	if (ret) {
+		unregister_pm_notifier(&topst_pm_nb);
+		class_destroy(topst_class);
+		unregister_chrdev_region(topst_devt, TOPST_MAX_MINORS);
+		return ret;
+	}
+	pr_info("topst_body: %u drivers registered\n", n);
+#endif
+	return 0;
+}
+
+static void __exit topst_core_exit(void)
+{
+#ifdef TOPST_BODY
+	struct platform_driver *drv[5];
+
+	platform_unregister_drivers(drv, topst_body_drivers(drv));
+#endif
+	unregister_pm_notifier(&topst_pm_nb);
+	class_destroy(topst_class);
+	unregister_chrdev_region(topst_devt, TOPST_MAX_MINORS);
+	idr_destroy(&topst_minors);
+}
+
+module_init(topst_core_init);
+module_exit(topst_core_exit);
+
+MODULE_LICENSE("GPL");
+MODULE_AUTHOR("telli");
+MODULE_DESCRIPTION("TOPST shared chardev core (class, minors, ioctl dispatch, event log, stats)");
@@ -0,0 +1,209 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+// drivers/mytopst/topst_core.h
+//
+// topst_core: 다섯 장치 드라이버가 공유하는 chardev 공통부.
+// class "topst" 하나, dynamic chardev region 하나를 두고 장치마다 minor 만 나눠 쓴다.
+// 드라이버는 ioctl 테이블(topst_dev_ops)과 하드웨어 로직만 가진다.
+#ifndef TOPST_CORE_H
+#define TOPST_CORE_H
+
+#include <linux/atomic.h>
+#include <linux/fs.h>
+#include <linux/ioctl.h>
+#include <linux/kref.h>
+#include <linux/ktime.h>
+#include <linux/percpu-rwsem.h>
+#include <linux/platform_device.h>
+#include <linux/spinlock.h>
+#include <linux/u64_stats_sync.h>
+#include <linux/workqueue.h>
+#include "topst_event.h"
+
+#define TOPST_MAX_MINORS     16
+#define TOPST_NAME_LEN       32
+#define TOPST_IOCTL_MAX_ARG  256  /* 공통 dispatch 가 스택에 복사하는 인자 최대 크기 */
+
+struct topst_dev;
+
+/*
+ * 공통 ioctl dispatch 테이블 항목.
+ * 코어가 _IOC_DIR/_IOC_SIZE 대로 인자를 커널 버퍼에 복사한 뒤 fn 을 부르고,
+ * _IOC_READ 면 fn 이 0 을 반환했을 때 다시 유저에 복사한다.
+ * size 가 0 이 아니면 cmd 에 인코딩된 크기 대신 size 를 쓰고 크기 필드는 비교하지 않는다
+ * (AMBIENT_SET_MODE 처럼 _IOW(..., char *) 로 정의된 기존 ABI 용).
+ */
+struct topst_ioctl {
+	unsigned int  cmd;
+	unsigned int  size;
+	long        (*fn)(struct topst_dev *td, void *arg);
+};
+
+#define TOPST_IOCTL(_cmd, _fn)               { .cmd = (_cmd), .fn = (_fn) }
+#define TOPST_IOCTL_SIZED(_cmd, _fn, _size)  { .cmd = (_cmd), .fn = (_fn), .size = (_size) }
+
+struct topst_dev_ops {
+	struct module            *owner;
+	const struct topst_ioctl *ioctls;
+	unsigned int              nr_ioctls;
+	int  (*open)(struct topst_dev *td);     /* 선택 */
+	void (*release)(struct topst_dev *td);  /* 선택 */
+
+	/*
+	 * 선택: SET 명령 mailbox (struct topst_mbox). apply 는 잠들 수 있는 문맥에서
+	 * 최신값으로만 불리고, state 는 지금 적용된 값을 잠금 없이 돌려준다.
+	 * min_interval_us 는 기본 최소 apply 간격 (DT "min-apply-interval-us" 가 우선).
+	 * urgent 가 true 를 돌려주는 값 (정지/OFF 같은 안전 상태) 은 간격을 기다리지 않고
+	 * post 한 문맥에서 바로 적용한다. spinlock 안에서 불리므로 잠들면 안 됨.
+	 */
+	void (*apply)(struct topst_dev *td, s32 val);
+	s32  (*state)(struct topst_dev *td);
+	bool (*urgent)(struct topst_dev *td, s32 val);
+	u32  min_interval_us;
+
+	/* 선택: 액추에이터가 동작 중인가 (runtime PM, topst_pm_update() 참고). 잠들면 안 됨 */
+	bool (*busy)(struct topst_dev *td);
+};
+
+/*
+ * ioctl 경로 통계는 CPU 별로 두고 sysfs 에서 합산한다.
+ * 여러 스레드가 동시에 ioctl 해도 공유 캐시라인을 쓰지 않는다.
+ */
+struct topst_pcpu_stats {
+	u64                    ioctls;
+	u64                    ioctl_errors;
+	u64                    ioctl_ns_sum;
+	u64                    ioctl_ns_max;
+	struct u64_stats_sync  syncp;
+};
+
+/* /sys/class/topst/<name>/stats/ */
+struct topst_stats {
+	struct topst_pcpu_stats __percpu *pcpu;
+	atomic64_t events;
+	atomic_t   opens;
+	u64        probe_ns;   /* probe 시작 → topst_dev_ready() */
+	u64        ready_ns;   /* 부팅(CLOCK_BOOTTIME) 후 ready 까지 */
+};
+
+/*
+ * latest-wins 명령 mailbox. 드라이버 SET ioctl 은 검증 뒤 topst_mbox_post() 만 부르고
+ * 코어가 min_interval_us 에 한 번씩 ops->apply 를 부른다 (ops->urgent 값은 즉시).
+ * 간격 안에 들어온 중간값은 덮어써져 적용되지 않고(coalesced),
+ * 적용 중/대기 중/현재 값과 같은 SET 은 드라이버 잠금·이벤트 없이 끝난다(redundant).
+ * /sys/class/topst/<name>/mailbox/
+ */
+struct topst_mbox {
+	spinlock_t          lock;
+	struct mutex        apply_lock;   /* apply 직렬화 (즉시 적용 vs work) */
+	struct delayed_work work;
+	s32                 pending;
+	s32                 inflight;     /* apply 실행 중인 값 */
+	bool                has_pending;
+	bool                applying;
+	u64                 last_apply_ns;
+	u32                 min_interval_us;
+
+	/* 통계 (lock 안에서 갱신) */
+	u64                 posted;
+	u64                 applied;
+	u64                 coalesced;
+	u64                 redundant;
+};
+
+/*
+ * 전원 관리. ops->busy 가 있는 장치는 topst_pm_enable() 뒤 상태가 바뀔 때마다
+ * topst_pm_update() 를 부르고, 코어가 busy 인 동안 runtime PM 참조를 쥐었다가
+ * 멈추면 autosuspend 한다 (DT "autosuspend-delay-ms", 기본 TOPST_PM_AUTOSUSPEND_MS).
+ * 드라이버의 PM 콜백은 topst_pm_set_state() 로 데몬에 알린다:
+ *   /sys/class/topst/<name>/park/state  (active/parking/parked/suspended, POLLPRI)
+ * user_park 장치(하드웨어를 데몬이 구동)는 시스템 suspend 직전에 "parking" 을 알리고
+ * 장치를 연 데몬이 "parked" 를 쓸 때까지 park_timeout_ms 만큼 기다린다.
+ */
+#define TOPST_PM_AUTOSUSPEND_MS  2000
+
+struct topst_pm {
+	struct device *dev;       /* platform device (register 의 parent) */
+	struct mutex  lock;       /* held (busy 평가 ~ get/put) */
+	bool          enabled;
+	bool          held;       /* busy 라서 runtime PM 참조를 쥐고 있음 */
+	bool          user_park;
+	spinlock_t    state_lock; /* 아래 (PM 콜백에서도 갱신) */
+	int           state;      /* TOPST_PARK_* */
+	u64           state_ns;   /* 지금 상태가 된 시각 */
+	u64           suspended_ns;
+	u64           suspends;
+	u64           resumes;
+	u64           park_timeouts;
+};
+
+/*
+ * 코어가 할당하고 kref 로 관리한다. 드라이버가 unregister 한 뒤에도
+ * 열린 fd 가 남아 있으면 마지막 release 까지 유지되며 그동안 ioctl 은 -ENODEV.
+ */
+struct topst_dev {
+	char                        name[TOPST_NAME_LEN];
+	const struct topst_dev_ops *ops;
+	void                       *priv;
+	struct device              *dev;
+	struct cdev                *cdev;
+	int                         minor;
+
+	/* ops 호출(read) vs unregister(write). read 는 CPU 별 카운터라 스레드가 늘어도 경합 없음 */
+	struct percpu_rw_semaphore  rwsem;
+	bool                        dead;
+	struct kref                 kref;
+
+	struct topst_evlog          evlog;
+	struct topst_stats          stats;
+	struct topst_mbox           mbox;   /* ops->apply 가 있을 때만 사용 */
+	struct topst_pm             pm;
+	atomic_t                    users;  /* 지금 열려 있는 fd 수 */
+};
+
+static inline void *topst_dev_priv(const struct topst_dev *td)
+{
+	return td->priv;
+}
+
+/* /dev/<name> 생성. ev_device 는 TOPST_EV_DEV_* */
+struct topst_dev *topst_dev_register(struct device *parent, const char *name, u16 ev_device,
+				     const struct topst_dev_ops *ops, void *priv);
+/* 새 open/ioctl 을 막고 진행 중인 ops 호출이 끝날 때까지 기다린 뒤 노드 제거 */
+void topst_dev_unregister(struct topst_dev *td);
+
+/*
+ * probe 타이밍: probe 첫 줄에서 t0 = topst_probe_start(),
+ * 성공 직전에 topst_dev_ready(td, t0). /sys/class/topst/<dev>/stats/{probe_ns,ready_ns}
+ */
+static inline u64 topst_probe_start(void)
+{
+	return ktime_get_boottime_ns();
+}
+void topst_dev_ready(struct topst_dev *td, u64 t0);
+
+/* SET 값을 mailbox 에 넣음. 간격이 지났으면 호출자 문맥에서 바로 apply */
+int topst_mbox_post(struct topst_dev *td, s32 val);
+
+/* runtime PM 켜기/끄기 (probe 에서 register 뒤 / remove 에서 unregister 전) */
+int  topst_pm_enable(struct topst_dev *td, bool user_park);
+void topst_pm_disable(struct topst_dev *td);
+/* ops->busy 를 다시 평가해 runtime PM 참조를 잡거나 놓음. 잠들 수 있는 문맥 */
+void topst_pm_update(struct topst_dev *td);
+/* PM 콜백에서: TOPST_PARK_* 로 바꾸고 이벤트 + sysfs_notify */
+void topst_pm_set_state(struct topst_dev *td, int state);
+
+/* 이벤트 로그 + 통계 + tracepoint */
+void topst_dev_event(struct topst_dev *td, u16 cause, u16 attr, s32 old_val, s32 new_val);
+
+/*
+ * 드라이버 등록. 개별 모듈/built-in 이면 module_platform_driver 그대로,
+ * topst_body.ko 로 묶을 때(TOPST_BODY)는 topst_core 의 init 이 한 번에 등록한다.
+ */
+#ifdef TOPST_BODY
+#define topst_platform_driver(__drv) \
+	struct platform_driver *const topst_body_##__drv = &(__drv)
+#else
+#define topst_platform_driver(__drv) module_platform_driver(__drv)
+#endif
+
+#endif /* TOPST_CORE_H */
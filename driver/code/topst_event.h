@@ -0,0 +1,176 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+// drivers/mytopst/topst_event.h
+//
+// 상태 전이 이벤트 로그 (read() 로 일괄 수신).
+// 레코드 레이아웃은 유저 공간과 공유하므로 __KERNEL__ 밖에 둔다.
+#ifndef TOPST_EVENT_H
+#define TOPST_EVENT_H
+
+#include <linux/types.h>
+
+/* device */
+#define TOPST_EV_DEV_AMBIENT   1
+#define TOPST_EV_DEV_WIPER     2
+#define TOPST_EV_DEV_WINDOW    3
+#define TOPST_EV_DEV_AIRCON    4
+#define TOPST_EV_DEV_HEADLAMP  5
+
+/* cause: 전이가 일어난 원인 */
+#define TOPST_EV_CAUSE_IOCTL        1
+#define TOPST_EV_CAUSE_LIMIT_UPPER  2
+#define TOPST_EV_CAUSE_LIMIT_LOWER  3
+#define TOPST_EV_CAUSE_THERMAL      4  /* thermal 프레임워크 (cooling device) */
+#define TOPST_EV_CAUSE_PINCH        5  /* window 끼임 검출 → 정지/역회전 */
+#define TOPST_EV_CAUSE_PM           6  /* runtime PM / 시스템 suspend */
+
+/* attr: 바뀐 항목 */
+#define TOPST_EV_ATTR_STATE       0  /* mode/level/state 정수값 */
+#define TOPST_EV_ATTR_MODE        1  /* ambient 모드: 값은 모드 문자열 앞 4바이트 */
+#define TOPST_EV_ATTR_BRIGHTNESS  2
+#define TOPST_EV_ATTR_PARK        3  /* 전원/park 상태: TOPST_PARK_* */
+#define TOPST_EV_ATTR_SCENE       4  /* ambient scene id (없으면 -1) */
+
+/* /sys/class/topst/<dev>/park/state 와 같은 순서 */
+#define TOPST_PARK_ACTIVE     0
+#define TOPST_PARK_PARKING    1  /* 시스템 suspend 직전: 데몬이 park 후 "parked" 를 씀 */
+#define TOPST_PARK_PARKED     2
+#define TOPST_PARK_SUSPENDED  3
+
+/* read() 한 번에 여러 개가 연속으로 복사됨. 32바이트 고정 */
+struct topst_event {
+	__s64 ktime_ns;   /* ktime_get_ns() */
+	__u32 seq;        /* 장치별 일련번호 (drop 돼도 증가) */
+	__u32 overflow;   /* 지금까지 fifo full 로 버려진 이벤트 누적 수 */
+	__u16 device;     /* TOPST_EV_DEV_* */
+	__u16 cause;      /* TOPST_EV_CAUSE_* */
+	__u16 attr;       /* TOPST_EV_ATTR_* */
+	__u16 reserved;
+	__s32 old_val;
+	__s32 new_val;
+};
+
+#ifdef __KERNEL__
+#include <linux/kfifo.h>
+#include <linux/ktime.h>
+#include <linux/mutex.h>
+#include <linux/poll.h>
+#include <linux/spinlock.h>
+#include <linux/uaccess.h>
+#include <linux/wait.h>
+
+#define TOPST_EVLOG_RECORDS 128
+
+/*
+ * producer(ioctl, kthread)는 spinlock 으로 직렬화하고 kfifo_in 만 호출,
+ * consumer(read)는 read_lock 으로 단일화해 kfifo 의 1:1 lock-free 조건을 지킨다.
+ * fifo 가 가득 차면 새 이벤트를 버리고 overflow 를 올린다.
+ * 장치가 제거되면 topst_evlog_shutdown() 으로 대기 중인 reader 를 깨운다.
+ */
+struct topst_evlog {
+	DECLARE_KFIFO(fifo, unsigned char,
+		      TOPST_EVLOG_RECORDS * sizeof(struct topst_event));
+	spinlock_t         lock;
+	struct mutex       read_lock;
+	wait_queue_head_t  wq;
+	u32                seq;
+	u32                overflow;
+	u16                device;
+	bool               shutdown;
+};
+
+static inline void topst_evlog_init(struct topst_evlog *log, u16 device)
+{
+	INIT_KFIFO(log->fifo);
+	spin_lock_init(&log->lock);
+	mutex_init(&log->read_lock);
+	init_waitqueue_head(&log->wq);
+	log->seq      = 0;
+	log->overflow = 0;
+	log->device   = device;
+	log->shutdown = false;
+}
+
+static inline void topst_evlog_shutdown(struct topst_evlog *log)
+{
+	WRITE_ONCE(log->shutdown, true);
+	wake_up_interruptible(&log->wq);
+}
+
+static inline void topst_evlog_push(struct topst_evlog *log, u16 cause, u16 attr,
+				    s32 old_val, s32 new_val)
+{
+	struct topst_event ev = {
+		.ktime_ns = ktime_get_ns(),
+		.device   = log->device,
+		.cause    = cause,
+		.attr     = attr,
+		.old_val  = old_val,
+		.new_val  = new_val,
+	};
+	unsigned long flags;
+	bool queued = false;
+
+	spin_lock_irqsave(&log->lock, flags);
+	ev.seq = log->seq++;
+	ev.overflow = log->overflow;
+	if (kfifo_avail(&log->fifo) >= sizeof(ev)) {
+		kfifo_in(&log->fifo, (unsigned char *)&ev, sizeof(ev));
+		queued = true;
+	} else {
+		log->overflow++;
+	}
+	spin_unlock_irqrestore(&log->lock, flags);
+
+	if (queued)
+		wake_up_interruptible(&log->wq);
+}
+
+/* 레코드 단위로만 복사. O_NONBLOCK 이면 비어 있을 때 -EAGAIN, 장치 제거 후에는 -ENODEV */
+static inline ssize_t topst_evlog_read(struct topst_evlog *log, struct file *file,
+				       char __user *buf, size_t count)
+{
+	unsigned int copied;
+	int ret;
+
+	if (count < sizeof(struct topst_event))
+		return -EINVAL;
+	count = rounddown(count, sizeof(struct topst_event));
+
+	for (;;) {
+		if (mutex_lock_interruptible(&log->read_lock))
+			return -ERESTARTSYS;
+		if (!kfifo_is_empty(&log->fifo))
+			break;
+		mutex_unlock(&log->read_lock);
+
+		if (READ_ONCE(log->shutdown))
+			return -ENODEV;
+		if (file->f_flags & O_NONBLOCK)
+			return -EAGAIN;
+		ret = wait_event_interruptible(log->wq, !kfifo_is_empty(&log->fifo) ||
+					       READ_ONCE(log->shutdown));
+		if (ret)
+			return ret;
+	}
+
+	ret = kfifo_to_user(&log->fifo, buf, count, &copied);
+	mutex_unlock(&log->read_lock);
+
+	return ret ? ret : copied;
+}
+
+static inline __poll_t topst_evlog_poll(struct topst_evlog *log, struct file *file,
+					poll_table *wait)
+{
+	__poll_t mask = 0;
+
+	poll_wait(file, &log->wq, wait);
+	if (!kfifo_is_empty(&log->fifo))
+		mask |= EPOLLIN | EPOLLRDNORM;
+	if (READ_ONCE(log->shutdown))
+		mask |= EPOLLHUP | EPOLLERR;
+	return mask;
+}
+#endif /* __KERNEL__ */
+
+#endif /* TOPST_EVENT_H */
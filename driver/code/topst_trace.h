@@ -0,0 +1,59 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+// drivers/mytopst/topst_trace.h
+//
+// echo 1 > /sys/kernel/debug/tracing/events/topst/enable
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM topst
+
+#if !defined(_TOPST_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _TOPST_TRACE_H
+
+#include <linux/tracepoint.h>
+
+TRACE_EVENT(topst_ioctl,
+	TP_PROTO(const char *name, unsigned int cmd, long ret, u64 ns),
+	TP_ARGS(name, cmd, ret, ns),
+	TP_STRUCT__entry(
+		__string(name, name)
+		__field(unsigned int, cmd)
+		__field(long, ret)
+		__field(u64, ns)
+	),
+	TP_fast_assign(
+		__assign_str(name, name);
+		__entry->cmd = cmd;
+		__entry->ret = ret;
+		__entry->ns  = ns;
+	),
+	TP_printk("%s cmd=0x%08x ret=%ld %llu ns",
+		  __get_str(name), __entry->cmd, __entry->ret, __entry->ns)
+);
+
+TRACE_EVENT(topst_event,
+	TP_PROTO(const char *name, u16 cause, u16 attr, s32 old_val, s32 new_val),
+	TP_ARGS(name, cause, attr, old_val, new_val),
+	TP_STRUCT__entry(
+		__string(name, name)
+		__field(u16, cause)
+		__field(u16, attr)
+		__field(s32, old_val)
+		__field(s32, new_val)
+	),
+	TP_fast_assign(
+		__assign_str(name, name);
+		__entry->cause   = cause;
+		__entry->attr    = attr;
+		__entry->old_val = old_val;
+		__entry->new_val = new_val;
+	),
+	TP_printk("%s cause=%u attr=%u %d -> %d", __get_str(name),
+		  __entry->cause, __entry->attr, __entry->old_val, __entry->new_val)
+);
+
+#endif /* _TOPST_TRACE_H */
+
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#undef TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE topst_trace
+#include <trace/define_trace.h>
@@ -1,26 +1,74 @@
 // drivers/mytopst/window_driver.c
 // SPDX-License-Identifier: GPL-2.0
 #include <linux/module.h>
-#include <linux/fs.h>
-#include <linux/uaccess.h>
-#include <linux/cdev.h>
 #include <linux/ioctl.h>
 #include <linux/kthread.h>
+#include <linux/freezer.h>
 #include <linux/delay.h>
 #include <linux/of.h>
 #include <linux/of_device.h>
 #include <linux/platform_device.h>
+#include <linux/pm_runtime.h>
 #include <linux/gpio/consumer.h>
 #include <linux/mutex.h>
+#include <linux/ktime.h>
+#include <linux/debugfs.h>
+#include <linux/iio/consumer.h>
+#include "topst_core.h"
 
 #define DEVICE_NAME "window_dev"
-#define CLASS_NAME  "window_class"
 
 
 #define WINDOW_MAGIC        'M'
 #define WINDOW_SET_STATE    _IOW(WINDOW_MAGIC, 0, int)  /* 0:stop, 1:up(open), 2:down(close) */
 #define WINDOW_GET_STATE    _IOR(WINDOW_MAGIC, 1, int)
 
+/*
+ * 끼임 방지(anti-pinch): DT 의 motor-current IIO 채널을 보호 방향 구동 중 1 ms 주기로 읽어
+ * 기동 후 경과시간 bin 별 학습 프로파일 + margin 을 debounce 샘플 연속 초과하면 정지 후 역회전.
+ */
+#define WINDOW_PINCH_BINS        64
+#define WINDOW_PINCH_BIN_MS      50      /* 64 x 50 ms = 3.2 s, 이후는 마지막 bin */
+#define WINDOW_PINCH_FALSE_MS    5000    /* 트리거 후 이 안에 같은 방향 완주하면 오검출로 집계 */
+
+struct window_pinch {
+	struct iio_channel *chan;          /* NULL 이면 debugfs 시뮬레이션 입력만 */
+	u32      level;                    /* 보호 방향 (기본 2: down/close) */
+	u32      margin;                   /* 프로파일 대비 허용 초과량 (채널 단위, 보통 mA) */
+	u32      limit;                    /* 학습 전 절대 임계값, 0 이면 첫 완주로 학습만 */
+	u32      blank_ms;                 /* 기동 돌입전류 무시 구간 */
+	u32      debounce;                 /* 연속 초과 샘플 수 */
+	u32      reverse_ms;               /* 검출 후 역회전 시간 */
+
+	s32      profile[WINDOW_PINCH_BINS];
+	s32      stroke[WINDOW_PINCH_BINS];  /* 진행 중 stroke 의 bin 별 최대값 */
+	u32      learned;                  /* 학습에 쓰인 완주 stroke 수 */
+
+	/* 진행 중 stroke */
+	ktime_t  start;
+	ktime_t  first_over;
+	u32      over;
+	ktime_t  last_trigger;
+	bool     check_false;
+
+	/* 검출 후 역회전: 모터 쓰레드가 reverse_end 까지 반대 방향으로 구동 (0: 아님) */
+	int      reverse_lvl;
+	ktime_t  reverse_end;
+
+	/* 통계 (sysfs anti_pinch/) */
+	u32      triggers;
+	u32      false_triggers;
+	u32      rejected;                 /* debounce 로 걸러진 순간 스파이크 */
+	u64      latency_last_ns;          /* 첫 초과 샘플 → H-bridge 정지 */
+	u64      latency_max_ns;
+	s32      last_sample;
+
+	/* 테스트용 입력 주입: /sys/kernel/debug/window_dev/current_sim{,_enable} */
+	bool     sim_enable;
+	u32      sim_val;
+	struct dentry *dbg;
+};
+
 struct window_priv {
 	struct device       *dev;
 	struct gpio_desc    *in1;
@@ -28,29 +76,189 @@ struct window_priv {
 	struct gpio_desc    *limit_lower;  /* NO 스위치: 눌림=LOW */
 	struct gpio_desc    *limit_upper;  /* NO 스위치: 눌림=LOW */
 	struct task_struct  *thread;
-	int                  current_level; /* 0/1/2 */
+	int                  current_level; /* 0/1/2, lock 안에서 쓰고 GET 은 잠금 없이 읽음 */
 	struct mutex         lock;
+	wait_queue_head_t    wq;            /* 정지 중인 모터 쓰레드가 다음 SET 을 기다림 */
+	bool                 sys_parked;    /* 시스템 suspend 가 park 시킴 */
+	struct topst_dev    *td;
+	struct window_pinch  pinch;
 };
 
+static void window_drive(struct window_priv *priv, int lvl)
+{
+	switch (lvl) {
+	case 1: /* up(open) */
+		gpiod_set_value_cansleep(priv->in1, 1);
+		gpiod_set_value_cansleep(priv->in2, 0);
+		break;
+	case 2: /* down(close) */
+		gpiod_set_value_cansleep(priv->in1, 0);
+		gpiod_set_value_cansleep(priv->in2, 1);
+		break;
+	default: /* stop */
+		gpiod_set_value_cansleep(priv->in1, 0);
+		gpiod_set_value_cansleep(priv->in2, 0);
+		break;
+	}
+}
 
-static int            major;
-static struct class  *window_class;
-static struct device *window_device;
-static struct window_priv *g_priv; 
+/* ===== anti-pinch ===== */
+static bool window_pinch_active(struct window_priv *priv)
+{
+	return priv->pinch.chan || READ_ONCE(priv->pinch.sim_enable);
+}
+
+static int window_pinch_read(struct window_pinch *p, int *val)
+{
+	int ret;
+
+	if (READ_ONCE(p->sim_enable)) {
+		*val = READ_ONCE(p->sim_val);
+		return 0;
+	}
+	/* IIO 없이 빌드하면 chan 은 항상 NULL, consumer 호출은 컴파일에서 빠짐 */
+	if (!IS_ENABLED(CONFIG_IIO) || !p->chan)
+		return -ENODEV;
+	ret = iio_read_channel_processed(p->chan, val);
+	if (ret < 0)
+		ret = iio_read_channel_raw(p->chan, val);
+	return ret < 0 ? ret : 0;
+}
+
+static void window_pinch_begin(struct window_pinch *p)
+{
+	int i;
+
+	p->start = ktime_get();
+	p->over  = 0;
+	for (i = 0; i < WINDOW_PINCH_BINS; i++)
+		p->stroke[i] = 0;
+	/* 직전 트리거 직후 같은 방향 재시도면 이번 stroke 결과로 오검출 여부 판정 */
+	p->check_false = p->triggers &&
+			 ktime_ms_delta(p->start, p->last_trigger) < WINDOW_PINCH_FALSE_MS;
+}
+
+/* 보호 방향 stroke 가 리미트 스위치까지 완주: 프로파일 갱신 (EWMA 1/4) */
+static void window_pinch_complete(struct window_pinch *p)
+{
+	int last = min_t(s64, ktime_ms_delta(ktime_get(), p->start) / WINDOW_PINCH_BIN_MS,
+			 WINDOW_PINCH_BINS - 1);
+	int i;
+
+	for (i = 0; i <= last; i++)
+		p->profile[i] = p->learned ? (p->profile[i] * 3 + p->stroke[i]) / 4 : p->stroke[i];
+	p->learned++;
+
+	if (p->check_false) {
+		p->false_triggers++;
+		p->check_false = false;
+	}
+}
+
+/* 한 샘플 처리. 끼임으로 판정되면 true */
+static bool window_pinch_sample(struct window_priv *priv)
+{
+	struct window_pinch *p = &priv->pinch;
+	ktime_t now = ktime_get();
+	s64 ms = ktime_ms_delta(now, p->start);
+	int bin = min_t(s64, ms / WINDOW_PINCH_BIN_MS, WINDOW_PINCH_BINS - 1);
+	s64 thr;
+	int val;
+
+	if (window_pinch_read(p, &val))
+		return false;
+	p->last_sample = val;
+	if (val > p->stroke[bin])
+		p->stroke[bin] = val;
+
+	if (ms < p->blank_ms)
+		return false;
+	if (p->learned)
+		thr = (s64)p->profile[bin] + p->margin;
+	else if (p->limit)
+		thr = p->limit;
+	else
+		return false;
+
+	if (val <= thr) {
+		if (p->over)
+			p->rejected++;
+		p->over = 0;
+		return false;
+	}
+	if (p->over++ == 0)
+		p->first_over = now;
+	return p->over >= p->debounce;
+}
+
+/*
+ * 정지 후 역회전 레벨을 돌려줌. 역회전은 모터 쓰레드 루프가 이어서 구동하므로
+ * 리미트 스위치와 kthread_stop 을 그대로 따르고, 시간이 다 되면 루프가 정지.
+ * 지연은 첫 초과 샘플부터 정지까지
+ */
+static int window_pinch_trip(struct window_priv *priv, int lvl)
+{
+	struct window_pinch *p = &priv->pinch;
+	int rev = p->reverse_ms ? (lvl == 1 ? 2 : 1) : 0;
+	u64 lat;
+
+	window_drive(priv, 0);
+	lat = ktime_to_ns(ktime_sub(ktime_get(), p->first_over));
+
+	mutex_lock(&priv->lock);
+	WRITE_ONCE(priv->current_level, rev);
+	mutex_unlock(&priv->lock);
+
+	p->latency_last_ns = lat;
+	if (lat > p->latency_max_ns)
+		p->latency_max_ns = lat;
+	p->triggers++;
+	p->last_trigger = ktime_get();
+	p->check_false = false;
+	p->over = 0;
+
+	topst_dev_event(priv->td, TOPST_EV_CAUSE_PINCH, TOPST_EV_ATTR_STATE, lvl, rev);
+	dev_warn(priv->dev, "[window_dev] pinch detected (%d), stop in %llu us, reverse %u ms\n",
+		 p->last_sample, lat / NSEC_PER_USEC, p->reverse_ms);
+
+	p->reverse_lvl = rev;
+	p->reverse_end = ktime_add_ms(ktime_get(), p->reverse_ms);
+	return rev;
+}
 
 /* ===== PWM/모터 제어 쓰레드  ===== */
 static int pwm_thread_fn(void *arg)
 {
 	struct window_priv *priv = (struct window_priv *)arg;
+	struct window_pinch *p = &priv->pinch;
+	int prev = 0;
 
+	set_freezable();
 	while (!kthread_should_stop()) {
 		int lvl;
+		bool guard;
 
 		/* 현재 모드 스냅샷 */
 		mutex_lock(&priv->lock);
 		lvl = priv->current_level;
+		/* 끼임 역회전 시간이 끝나면 정지. 그 사이 들어온 SET 이 있으면 그쪽을 따름 */
+		if (p->reverse_lvl) {
+			if (lvl != p->reverse_lvl) {
+				p->reverse_lvl = 0;
+			} else if (ktime_after(ktime_get(), p->reverse_end)) {
+				WRITE_ONCE(priv->current_level, 0);
+				topst_dev_event(priv->td, TOPST_EV_CAUSE_PINCH,
+						TOPST_EV_ATTR_STATE, lvl, 0);
+				p->reverse_lvl = 0;
+				lvl = 0;
+			}
+		}
 		mutex_unlock(&priv->lock);
 
+		guard = window_pinch_active(priv) && lvl == p->level;
+		if (guard && lvl != prev)
+			window_pinch_begin(p);
+
 		/* 리미트 스위치 체크 (눌림=0) */
 		if (lvl == 1 /* up */) {
 			int up_pressed = 1; /* default: not pressed (HIGH) */
@@ -58,9 +266,13 @@ static int pwm_thread_fn(void *arg)
 				up_pressed = gpiod_get_value_cansleep(priv->limit_upper);
 			if (up_pressed == 0) {
 				mutex_lock(&priv->lock);
-				priv->current_level = 0; /* stop */
+				WRITE_ONCE(priv->current_level, 0); /* stop */
 				mutex_unlock(&priv->lock);
+				topst_dev_event(priv->td, TOPST_EV_CAUSE_LIMIT_UPPER,
+						TOPST_EV_ATTR_STATE, 1, 0);
 				dev_info(priv->dev, "[window_dev] upper limit triggered, motor stop\n");
+				if (guard)
+					window_pinch_complete(p);
 				lvl = 0;
 			}
 		} else if (lvl == 2 /* down */) {
@@ -69,99 +281,312 @@ static int pwm_thread_fn(void *arg)
 				low_pressed = gpiod_get_value_cansleep(priv->limit_lower);
 			if (low_pressed == 0) {
 				mutex_lock(&priv->lock);
-				priv->current_level = 0;
+				WRITE_ONCE(priv->current_level, 0);
 				mutex_unlock(&priv->lock);
+				topst_dev_event(priv->td, TOPST_EV_CAUSE_LIMIT_LOWER,
+						TOPST_EV_ATTR_STATE, 2, 0);
 				dev_info(priv->dev, "[window_dev] lower limit triggered, motor stop\n");
+				if (guard)
+					window_pinch_complete(p);
 				lvl = 0;
 			}
 		}
 
-		/* H-Bridge 구동 (IN1/IN2) */
-		switch (lvl) {
-		case 0: /* stop */
-			gpiod_set_value_cansleep(priv->in1, 0);
-			gpiod_set_value_cansleep(priv->in2, 0);
-			break;
-		case 1: /* up(open) */
-			gpiod_set_value_cansleep(priv->in1, 1);
-			gpiod_set_value_cansleep(priv->in2, 0);
-			break;
-		case 2: /* down(close) */
-			gpiod_set_value_cansleep(priv->in1, 0);
-			gpiod_set_value_cansleep(priv->in2, 1);
-			break;
-		default:
-			gpiod_set_value_cansleep(priv->in1, 0);
-			gpiod_set_value_cansleep(priv->in2, 0);
-			break;
+		if (lvl && guard && window_pinch_sample(priv)) {
+			lvl = window_pinch_trip(priv, lvl);
+			guard = false;
 		}
 
-		msleep(10);
+		/* H-Bridge 구동 (IN1/IN2) */
+		window_drive(priv, lvl);
+
+		if (!lvl) {
+			/* 리미트/끼임 정지면 runtime PM 참조를 놓음 (SET 경로는 apply 가 처리) */
+			if (prev)
+				topst_pm_update(priv->td);
+			prev = 0;
+			p->reverse_lvl = 0;
+			/* 정지 중에는 폴링하지 않고 다음 SET (또는 stop) 까지 잠듦 */
+			wait_event_freezable(priv->wq, READ_ONCE(priv->current_level) ||
+					     kthread_should_stop());
+			continue;
+		}
+		prev = lvl;
+
+		/* 보호 방향 구동 중에는 전류를 촘촘히 샘플 */
+		if (guard)
+			usleep_range(1000, 1100);
+		else
+			msleep(10);
+		try_to_freeze();
 	}
 	return 0;
 }
 
-/* ===== 파일 연산/IOCTL ===== */
-static long window_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
+/* ===== IOCTL ===== */
+/* mailbox 가 최신값만, 최소 간격마다 부름 */
+static void window_apply(struct topst_dev *td, s32 level)
 {
-	int level;
+	struct window_priv *priv = topst_dev_priv(td);
+	int old;
+
+	mutex_lock(&priv->lock);
+	old = priv->current_level;
+	WRITE_ONCE(priv->current_level, level);
+	if (old != level)
+		topst_dev_event(td, TOPST_EV_CAUSE_IOCTL, TOPST_EV_ATTR_STATE, old, level);
+	mutex_unlock(&priv->lock);
+	wake_up(&priv->wq);
+	topst_pm_update(td);
+	dev_dbg(priv->dev, "[window_dev] level changed to %d\n", level);
+}
 
-	if (!g_priv)
-		return -ENODEV;
+/* 리미트/끼임 정지도 current_level 에 반영되므로 그 뒤 같은 방향 SET 은 다시 적용됨 */
+static s32 window_state(struct topst_dev *td)
+{
+	struct window_priv *priv = topst_dev_priv(td);
 
-	switch (cmd) {
-	case WINDOW_SET_STATE:
-		if (copy_from_user(&level, (int __user *)arg, sizeof(int)))
-			return -EFAULT;
-		if (level < 0 || level > 2)
-			return -EINVAL;
-		mutex_lock(&g_priv->lock);
-		g_priv->current_level = level;
-		mutex_unlock(&g_priv->lock);
-		dev_info(g_priv->dev, "[window_dev] level changed to %d\n", level);
-		break;
+	return READ_ONCE(priv->current_level);
+}
 
-	case WINDOW_GET_STATE:
-		mutex_lock(&g_priv->lock);
-		level = g_priv->current_level;
-		mutex_unlock(&g_priv->lock);
-		if (copy_to_user((int __user *)arg, &level, sizeof(int)))
-			return -EFAULT;
-		dev_info(g_priv->dev, "[window_dev] GET_STATE: %d\n", level);
-		break;
+/* 정지는 간격 제한 없이 바로 */
+static bool window_urgent(struct topst_dev *td, s32 level)
+{
+	return level == 0;
+}
+
+static bool window_busy(struct topst_dev *td)
+{
+	struct window_priv *priv = topst_dev_priv(td);
 
-	default:
+	return READ_ONCE(priv->current_level) != 0;
+}
+
+static long window_set_state(struct topst_dev *td, void *arg)
+{
+	int level = *(int *)arg;
+
+	if (level < 0 || level > 2)
 		return -EINVAL;
-	}
+	return topst_mbox_post(td, level);
+}
+
+static long window_get_state(struct topst_dev *td, void *arg)
+{
+	struct window_priv *priv = topst_dev_priv(td);
+	int level = READ_ONCE(priv->current_level);
+
+	*(int *)arg = level;
+	dev_dbg(priv->dev, "[window_dev] GET_STATE: %d\n", level);
 	return 0;
 }
 
-static int window_open(struct inode *inode, struct file *file)
+static int window_open(struct topst_dev *td)
 {
 	pr_info("[window_dev] device opened\n");
 	return 0;
 }
 
-static int window_release(struct inode *inode, struct file *file)
+static void window_release(struct topst_dev *td)
 {
 	pr_info("[window_dev] device closed\n");
+}
+
+static const struct topst_ioctl window_ioctls[] = {
+	TOPST_IOCTL(WINDOW_SET_STATE, window_set_state),
+	TOPST_IOCTL(WINDOW_GET_STATE, window_get_state),
+};
+
+static const struct topst_dev_ops window_ops = {
+	.owner           = THIS_MODULE,
+	.ioctls          = window_ioctls,
+	.nr_ioctls       = ARRAY_SIZE(window_ioctls),
+	.open            = window_open,
+	.release         = window_release,
+	.apply           = window_apply,
+	.state           = window_state,
+	.urgent          = window_urgent,
+	.min_interval_us = 10000,   /* 방향 전환만 모터 스레드 주기로 제한, 정지는 즉시 */
+	.busy            = window_busy,
+};
+
+/* ===== 전원 관리 ===== */
+static int __maybe_unused window_runtime_suspend(struct device *dev)
+{
+	struct window_priv *priv = dev_get_drvdata(dev);
+
+	if (window_busy(priv->td))
+		return -EBUSY;
+	topst_pm_set_state(priv->td, TOPST_PARK_SUSPENDED);
+	return 0;
+}
+
+static int __maybe_unused window_runtime_resume(struct device *dev)
+{
+	struct window_priv *priv = dev_get_drvdata(dev);
+
+	topst_pm_set_state(priv->td, TOPST_PARK_ACTIVE);
 	return 0;
 }
 
-static const struct file_operations window_fops = {
-	.owner          = THIS_MODULE,
-	.open           = window_open,
-	.release        = window_release,
-	.unlocked_ioctl = window_ioctl,
-#ifdef CONFIG_COMPAT
-	.compat_ioctl   = window_ioctl,
-#endif
+/*
+ * 모터 쓰레드는 이미 얼어 있음 (freezable). 움직이던 창문은 정지시키고
+ * resume 뒤에도 다시 움직이지 않는다: 사람이 없는 사이 창문이 닫히면 안 됨.
+ */
+static int __maybe_unused window_suspend(struct device *dev)
+{
+	struct window_priv *priv = dev_get_drvdata(dev);
+	int old;
+
+	if (pm_runtime_suspended(dev))
+		return 0;
+
+	mutex_lock(&priv->lock);
+	old = priv->current_level;
+	WRITE_ONCE(priv->current_level, 0);
+	if (old)
+		topst_dev_event(priv->td, TOPST_EV_CAUSE_PM, TOPST_EV_ATTR_STATE, old, 0);
+	mutex_unlock(&priv->lock);
+	window_drive(priv, 0);
+
+	priv->sys_parked = true;
+	topst_pm_set_state(priv->td, TOPST_PARK_SUSPENDED);
+	return 0;
+}
+
+static int __maybe_unused window_resume(struct device *dev)
+{
+	struct window_priv *priv = dev_get_drvdata(dev);
+
+	if (!priv->sys_parked)
+		return 0;
+	priv->sys_parked = false;
+	topst_pm_set_state(priv->td, TOPST_PARK_ACTIVE);
+	/* suspend 에서 멈췄으니 쥐고 있던 참조를 놓음 */
+	topst_pm_update(priv->td);
+	return 0;
+}
+
+static const struct dev_pm_ops window_pm_ops = {
+	SET_SYSTEM_SLEEP_PM_OPS(window_suspend, window_resume)
+	SET_RUNTIME_PM_OPS(window_runtime_suspend, window_runtime_resume, NULL)
 };
 
-static int window_probe(struct platform_device *pdev)
+/* ===== sysfs: /sys/bus/platform/devices/<window>/anti_pinch/ ===== */
+#define WINDOW_PINCH_ATTR(_name, _fmt, _field)					\
+static ssize_t _name##_show(struct device *dev, struct device_attribute *attr,	\
+			    char *buf)						\
+{										\
+	struct window_priv *priv = dev_get_drvdata(dev);			\
+										\
+	return sprintf(buf, _fmt "\n", READ_ONCE(priv->pinch._field));		\
+}										\
+static DEVICE_ATTR_RO(_name)
+
+WINDOW_PINCH_ATTR(triggers,        "%u",   triggers);
+WINDOW_PINCH_ATTR(false_triggers,  "%u",   false_triggers);
+WINDOW_PINCH_ATTR(rejected,        "%u",   rejected);
+WINDOW_PINCH_ATTR(latency_last_ns, "%llu", latency_last_ns);
+WINDOW_PINCH_ATTR(latency_max_ns,  "%llu", latency_max_ns);
+WINDOW_PINCH_ATTR(learned_strokes, "%u",   learned);
+WINDOW_PINCH_ATTR(last_sample,     "%d",   last_sample);
+
+static ssize_t profile_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+	struct window_priv *priv = dev_get_drvdata(dev);
+	int i, len = 0;
+
+	for (i = 0; i < WINDOW_PINCH_BINS; i++)
+		len += scnprintf(buf + len, PAGE_SIZE - len, "%d%c",
+				 READ_ONCE(priv->pinch.profile[i]),
+				 i == WINDOW_PINCH_BINS - 1 ? '\n' : ' ');
+	return len;
+}
+static DEVICE_ATTR_RO(profile);
+
+/* echo 1 > relearn: 프로파일 초기화 (다음 완주부터 다시 학습) */
+static ssize_t relearn_store(struct device *dev, struct device_attribute *attr,
+			     const char *buf, size_t count)
+{
+	struct window_priv *priv = dev_get_drvdata(dev);
+
+	WRITE_ONCE(priv->pinch.learned, 0);
+	return count;
+}
+static DEVICE_ATTR_WO(relearn);
+
+static struct attribute *window_pinch_attrs[] = {
+	&dev_attr_triggers.attr,
+	&dev_attr_false_triggers.attr,
+	&dev_attr_rejected.attr,
+	&dev_attr_latency_last_ns.attr,
+	&dev_attr_latency_max_ns.attr,
+	&dev_attr_learned_strokes.attr,
+	&dev_attr_last_sample.attr,
+	&dev_attr_profile.attr,
+	&dev_attr_relearn.attr,
+	NULL,
+};
+
+static const struct attribute_group window_pinch_group = {
+	.name  = "anti_pinch",
+	.attrs = window_pinch_attrs,
+};
+
+/*
+ * DT (모두 선택):
+ *   io-channels = <&adc N>; io-channel-names = "motor-current";
+ *   pinch-level = <2>; pinch-margin = <400>; pinch-limit = <0>;
+ *   pinch-blank-ms = <150>; pinch-debounce = <3>; pinch-reverse-ms = <300>;
+ */
+static int window_pinch_init(struct platform_device *pdev, struct window_priv *priv)
 {
+	struct device_node *np = pdev->dev.of_node;
+	struct window_pinch *p = &priv->pinch;
 	int ret;
+
+	p->level      = 2;
+	p->margin     = 400;
+	p->limit      = 0;
+	p->blank_ms   = 150;
+	p->debounce   = 3;
+	p->reverse_ms = 300;
+	of_property_read_u32(np, "pinch-level", &p->level);
+	of_property_read_u32(np, "pinch-margin", &p->margin);
+	of_property_read_u32(np, "pinch-limit", &p->limit);
+	of_property_read_u32(np, "pinch-blank-ms", &p->blank_ms);
+	of_property_read_u32(np, "pinch-debounce", &p->debounce);
+	of_property_read_u32(np, "pinch-reverse-ms", &p->reverse_ms);
+	if (p->level < 1 || p->level > 2)
+		p->level = 2;
+	if (!p->debounce)
+		p->debounce = 1;
+
+	p->chan = IS_ENABLED(CONFIG_IIO) ?
+		  devm_iio_channel_get(&pdev->dev, "motor-current") : NULL;
+	if (IS_ERR(p->chan)) {
+		ret = PTR_ERR(p->chan);
+		p->chan = NULL;
+		if (ret == -EPROBE_DEFER)
+			return ret;
+		/* 채널이 없으면 debugfs 시뮬레이션 입력을 켤 때만 동작 */
+	}
+
+	ret = devm_device_add_group(&pdev->dev, &window_pinch_group);
+	if (ret)
+		return ret;
+
+	p->dbg = debugfs_create_dir("window_dev", NULL);
+	debugfs_create_u32("current_sim", 0600, p->dbg, &p->sim_val);
+	debugfs_create_bool("current_sim_enable", 0600, p->dbg, &p->sim_enable);
+	return 0;
+}
+
+static int window_probe(struct platform_device *pdev)
+{
+	u64 t0 = topst_probe_start();
 	struct window_priv *priv;
+	int ret;
 
 	priv = devm_kzalloc(&pdev->dev, sizeof(*priv), GFP_KERNEL);
 	if (!priv)
@@ -169,6 +594,7 @@ static int window_probe(struct platform_device *pdev)
 
 	priv->dev = &pdev->dev;
 	mutex_init(&priv->lock);
+	init_waitqueue_head(&priv->wq);
 	priv->current_level = 0;
 
 	/* DT에서 GPIO 가져오기: in1-gpios, in2-gpios, limit-lower-gpios, limit-upper-gpios */
@@ -190,59 +616,43 @@ static int window_probe(struct platform_device *pdev)
 	if (IS_ERR(priv->limit_upper))
 		return PTR_ERR(priv->limit_upper);
 
-	/* character device 등록  */
-	if (major == 0) {
-		major = register_chrdev(0, DEVICE_NAME, &window_fops);
-		if (major < 0) {
-			dev_err(&pdev->dev, "register_chrdev failed: %d\n", major);
-			return major;
-		}
-	}
-	if (!window_class) {
-		window_class = class_create(THIS_MODULE, CLASS_NAME);
-		if (IS_ERR(window_class)) {
-			ret = PTR_ERR(window_class);
-			window_class = NULL;
-			unregister_chrdev(major, DEVICE_NAME);
-			major = 0;
-			return ret;
-		}
-	}
-	window_device = device_create(window_class, NULL, MKDEV(major, 0), NULL, DEVICE_NAME);
-	if (IS_ERR(window_device)) {
-		ret = PTR_ERR(window_device);
-		window_device = NULL;
-		class_destroy(window_class);
-		window_class = NULL;
-		unregister_chrdev(major, DEVICE_NAME);
-		major = 0;
+	/* sysfs 속성이 drvdata 를 쓰므로 먼저 */
+	platform_set_drvdata(pdev, priv);
+	ret = window_pinch_init(pdev, priv);
+	if (ret)
 		return ret;
+
+	priv->td = topst_dev_register(&pdev->dev, DEVICE_NAME, TOPST_EV_DEV_WINDOW,
+				      &window_ops, priv);
+	if (IS_ERR(priv->td)) {
+		ret = PTR_ERR(priv->td);
+		goto err_dbg;
 	}
 
-	
 	priv->thread = kthread_run(pwm_thread_fn, priv, "window_dev_thread");
 	if (IS_ERR(priv->thread)) {
 		ret = PTR_ERR(priv->thread);
-		device_destroy(window_class, MKDEV(major, 0));
-		window_device = NULL;
-		class_destroy(window_class);
-		window_class = NULL;
-		unregister_chrdev(major, DEVICE_NAME);
-		major = 0;
-		return ret;
+		topst_dev_unregister(priv->td);
+		goto err_dbg;
 	}
+	topst_pm_enable(priv->td, false);
 
-	platform_set_drvdata(pdev, priv);
-	g_priv = priv; 
-
-	dev_info(&pdev->dev, "window driver probed, /dev/%s (major=%d)\n", DEVICE_NAME, major);
+	dev_info(&pdev->dev, "window driver probed, /dev/%s, anti-pinch %s\n", DEVICE_NAME,
+		 priv->pinch.chan ? "on (motor-current)" : "off (no io-channel)");
+	topst_dev_ready(priv->td, t0);
 	return 0;
+
+err_dbg:
+	debugfs_remove_recursive(priv->pinch.dbg);
+	return ret;
 }
 
 static int window_remove(struct platform_device *pdev)
 {
 	struct window_priv *priv = platform_get_drvdata(pdev);
 
+	if (priv)
+		topst_pm_disable(priv->td);
 	if (priv && priv->thread)
 		kthread_stop(priv->thread);
 
@@ -252,20 +662,12 @@ static int window_remove(struct platform_device *pdev)
 		gpiod_set_value_cansleep(priv->in2, 0);
 	}
 
-	if (window_device) {
-		device_destroy(window_class, MKDEV(major, 0));
-		window_device = NULL;
-	}
-	if (window_class) {
-		class_destroy(window_class);
-		window_class = NULL;
-	}
-	if (major > 0) {
-		unregister_chrdev(major, DEVICE_NAME);
-		major = 0;
+	/* 스레드가 이벤트를 남길 수 있으므로 정지 후 노드 제거 */
+	if (priv) {
+		topst_dev_unregister(priv->td);
+		debugfs_remove_recursive(priv->pinch.dbg);
 	}
 
-	g_priv = NULL;
 	dev_info(&pdev->dev, "window driver removed\n");
 	return 0;
 }
@@ -283,10 +685,12 @@ static struct platform_driver window_platdrv = {
 	.driver = {
 		.name           = "telechips-window",
 		.of_match_table = window_of_match,
+		.probe_type     = PROBE_PREFER_ASYNCHRONOUS,
+		.pm             = &window_pm_ops,
 	},
 };
 
-module_platform_driver(window_platdrv);
+topst_platform_driver(window_platdrv);
 
 MODULE_LICENSE("GPL");
 MODULE_AUTHOR("telli");
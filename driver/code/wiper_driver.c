@@ -1,14 +1,13 @@
 // SPDX-License-Identifier: GPL-2.0
 #include <linux/module.h>
 #include <linux/init.h>
-#include <linux/fs.h>
-#include <linux/uaccess.h>
 #include <linux/ioctl.h>
-#include <linux/miscdevice.h>
 #include <linux/of.h>
 #include <linux/of_device.h>
 #include <linux/of_platform.h>
+#include <linux/pm_runtime.h>
 #include <linux/pwm.h>
+#include "topst_core.h"
 
 #define WIPER_MAGIC 'W'
 #define WIPER_SET_MODE _IOW(WIPER_MAGIC, 1, int)
@@ -18,54 +17,130 @@
 #define WIPER_MODE_FAST 1
 #define WIPER_MODE_SLOW 2
 
-static int wiper_mode = WIPER_MODE_OFF;
+/* 잠금 없이 xchg 로 갱신: 동시 SET 에서도 이벤트 old→new 가 실제 전이 순서와 맞음 */
+static atomic_t wiper_mode = ATOMIC_INIT(WIPER_MODE_OFF);
+static struct topst_dev *wiper_td;
+static bool wiper_sys_parked;   /* 시스템 suspend 가 park 시킴 (runtime suspend 아님) */
 
-static long wiper_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
+/* mailbox 가 최신값만, 최소 간격마다 부름 */
+static void wiper_apply(struct topst_dev *td, s32 val)
 {
-    int user_val;
-
-    switch (cmd) {
-        case WIPER_SET_MODE:
-            if (copy_from_user(&user_val, (int __user *)arg, sizeof(int)))
-                return -EFAULT;
-            if (user_val < WIPER_MODE_OFF || user_val > WIPER_MODE_SLOW)
-                return -EINVAL;
-            wiper_mode = user_val;
-            break;
-
-        case WIPER_GET_MODE:
-            if (copy_to_user((int __user *)arg, &wiper_mode, sizeof(int)))
-                return -EFAULT;
-            break;
-
-        default:
-            return -EINVAL;
-    }
+    int old = atomic_xchg(&wiper_mode, val);
 
+    if (old != val)
+        topst_dev_event(td, TOPST_EV_CAUSE_IOCTL, TOPST_EV_ATTR_STATE, old, val);
+    topst_pm_update(td);
+}
+
+static s32 wiper_state(struct topst_dev *td)
+{
+    return atomic_read(&wiper_mode);
+}
+
+/* OFF 는 간격 제한 없이 바로 */
+static bool wiper_urgent(struct topst_dev *td, s32 val)
+{
+    return val == WIPER_MODE_OFF;
+}
+
+static long wiper_set_mode(struct topst_dev *td, void *arg)
+{
+    int user_val = *(int *)arg;
+
+    if (user_val < WIPER_MODE_OFF || user_val > WIPER_MODE_SLOW)
+        return -EINVAL;
+    return topst_mbox_post(td, user_val);
+}
+
+static bool wiper_busy(struct topst_dev *td)
+{
+    return atomic_read(&wiper_mode) != WIPER_MODE_OFF;
+}
+
+static long wiper_get_mode(struct topst_dev *td, void *arg)
+{
+    *(int *)arg = atomic_read(&wiper_mode);
     return 0;
 }
 
-static const struct file_operations wiper_fops = {
-    .owner = THIS_MODULE,
-    .unlocked_ioctl = wiper_ioctl,
+static const struct topst_ioctl wiper_ioctls[] = {
+    TOPST_IOCTL(WIPER_SET_MODE, wiper_set_mode),
+    TOPST_IOCTL(WIPER_GET_MODE, wiper_get_mode),
 };
 
-static struct miscdevice wiper_miscdev = {
-    .minor = MISC_DYNAMIC_MINOR,
-    .name = "wiper_dev",
-    .fops = &wiper_fops,
-    .mode = 0666,
+static const struct topst_dev_ops wiper_ops = {
+    .owner           = THIS_MODULE,
+    .ioctls          = wiper_ioctls,
+    .nr_ioctls       = ARRAY_SIZE(wiper_ioctls),
+    .apply           = wiper_apply,
+    .state           = wiper_state,
+    .urgent          = wiper_urgent,
+    .min_interval_us = 20000,   /* 데몬은 어차피 왕복 시작마다 모드를 읽음 */
+    .busy            = wiper_busy,
+};
+
+/*
+ * 와이퍼 PWM 은 wiper_daemon 이 구동하므로 여기서는 상태만 알린다.
+ * 데몬은 parking/suspended 를 보면 90° 로 세운 뒤 PWM 을 끄고 active 까지 잠든다.
+ * 시스템 suspend 는 모드를 바꾸지 않으므로 resume 후 데몬이 이전 모드로 다시 돈다.
+ */
+static int __maybe_unused wiper_runtime_suspend(struct device *dev)
+{
+    if (wiper_busy(wiper_td))
+        return -EBUSY;
+    topst_pm_set_state(wiper_td, TOPST_PARK_SUSPENDED);
+    return 0;
+}
+
+static int __maybe_unused wiper_runtime_resume(struct device *dev)
+{
+    topst_pm_set_state(wiper_td, TOPST_PARK_ACTIVE);
+    return 0;
+}
+
+static int __maybe_unused wiper_suspend(struct device *dev)
+{
+    if (pm_runtime_suspended(dev))
+        return 0;
+    wiper_sys_parked = true;
+    topst_pm_set_state(wiper_td, TOPST_PARK_SUSPENDED);
+    return 0;
+}
+
+static int __maybe_unused wiper_resume(struct device *dev)
+{
+    if (!wiper_sys_parked)
+        return 0;
+    wiper_sys_parked = false;
+    topst_pm_set_state(wiper_td, TOPST_PARK_ACTIVE);
+    return 0;
+}
+
+static const struct dev_pm_ops wiper_pm_ops = {
+    SET_SYSTEM_SLEEP_PM_OPS(wiper_suspend, wiper_resume)
+    SET_RUNTIME_PM_OPS(wiper_runtime_suspend, wiper_runtime_resume, NULL)
 };
 
 static int wiper_probe(struct platform_device *pdev)
 {
+    u64 t0 = topst_probe_start();
+
+    wiper_td = topst_dev_register(&pdev->dev, "wiper_dev", TOPST_EV_DEV_WIPER,
+                                  &wiper_ops, NULL);
+    if (IS_ERR(wiper_td))
+        return PTR_ERR(wiper_td);
+    topst_pm_enable(wiper_td, true);
+
     dev_info(&pdev->dev, "wiper driver probed successfully\n");
-    return misc_register(&wiper_miscdev);
+    topst_dev_ready(wiper_td, t0);
+    return 0;
 }
 
 static int wiper_remove(struct platform_device *pdev)
 {
-    misc_deregister(&wiper_miscdev);
+    topst_pm_disable(wiper_td);
+    topst_dev_unregister(wiper_td);
+    wiper_td = NULL;
     return 0;
 }
 
@@ -81,10 +156,12 @@ static struct platform_driver wiper_driver = {
     .driver = {
         .name = "wiper_pwm_driver",
         .of_match_table = wiper_of_match,
+        .probe_type = PROBE_PREFER_ASYNCHRONOUS,
+        .pm = &wiper_pm_ops,
     },
 };
 
-module_platform_driver(wiper_driver);
+topst_platform_driver(wiper_driver);
 
 MODULE_LICENSE("GPL");
 MODULE_AUTHOR("telli");
@@ -0,0 +1,294 @@
+#!/bin/bash
+# sim/sim.sh
+#
+# TOPST 보드 없이 드라이버 + 데몬을 돌려 보는 HIL 시뮬레이터.
+#   GPIO : gpio-sim 라인 (topst-sim.dtso), 입력은 sim_gpioN/pull, 출력은 sim_gpioN/value
+#   PWM  : $SIM_DIR/pwm 가짜 sysfs 트리 (데몬은 TOPST_PWM_BASE 로 여기를 씀)
+#   SPI  : ambient_daemon --spi <FIFO>, sim_probe 가 프레임 단위로 받아 측정
+#
+# 사용:
+#   sim.sh dtb <base.dtb> <out.dtb>   overlay 를 합친 dtb (QEMU -dtb 등, configfs overlay 가 없을 때)
+#   sim.sh up                         gpio-sim/overlay/모듈 로드, 가짜 PWM 트리 생성
+#   sim.sh run [scenario...]          시나리오 실행 (기본 전부), 하나라도 FAIL 이면 종료 코드 1
+#   sim.sh list                       시나리오 목록
+#   sim.sh down                       정리
+#
+# 결과는 $SIM_DIR/results.log 에 누적 (회귀 비교용). 기준값은 아래 환경변수로 조정.
+
+set -u
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+ROOT=$(dirname "$HERE")
+SIM_DIR=${SIM_DIR:-/tmp/topst-sim}
+KO_DIR=${KO_DIR:-$ROOT/driver}
+BIN=${BIN:-$ROOT/user/code}
+OVERLAY_CFS=/sys/kernel/config/device-tree/overlays/topst-sim
+
+# 기준값
+WINDOW_STOP_MAX_US=${WINDOW_STOP_MAX_US:-25000}   # kthread 10ms 폴링 + 여유
+WINDOW_STOP_RUNS=${WINDOW_STOP_RUNS:-20}
+WIPER_FAST_MS=${WIPER_FAST_MS:-1080}              # 360 tick x 3ms
+WIPER_SLOW_MS=${WIPER_SLOW_MS:-1440}              # 360 tick x 4ms
+WIPER_TOL_PCT=${WIPER_TOL_PCT:-2}
+AMBIENT_FPS_MIN=${AMBIENT_FPS_MIN:-9.5}           # rainbow 10 fps
+AMBIENT_GAP_MAX_MS=${AMBIENT_GAP_MAX_MS:-150}
+HEADLAMP_RATE_MIN=${HEADLAMP_RATE_MIN:-55}        # 60 fps 요청
+PARK_SETTLE_S=${PARK_SETTLE_S:-3}                 # autosuspend 2s + 여유
+PARK_MEASURE_S=${PARK_MEASURE_S:-3}
+PARK_WAKEUPS_MAX=${PARK_WAKEUPS_MAX:-2}           # ambient 렌더 스레드의 1 Hz running 확인
+
+SCENARIOS="window-stop-upper window-stop-lower wiper-fast wiper-slow ambient-fps headlamp-mask park-wakeups"
+FAILED=0
+
+die() { echo "sim: $*" >&2; exit 1; }
+
+# ===== gpio-sim 라인 =====
+
+# 라인 이름 → "gpiochipN offset" (libgpiod 1.x gpiofind, 2.x gpioinfo)
+find_line() {
+	if command -v gpiofind >/dev/null; then
+		gpiofind "$1"
+	else
+		gpioinfo "$1" 2>/dev/null | awk '{ print $1, $2; exit }'
+	fi
+}
+
+# 라인 이름 → /sys/bus/gpio/devices/gpiochipN/sim_gpioK
+sim_line() {
+	local chip off
+	read -r chip off <<<"$(find_line "$1")"
+	[ -n "$off" ] || die "gpio line $1 not found (overlay loaded?)"
+	echo "/sys/bus/gpio/devices/$chip/sim_gpio$off"
+}
+
+# ===== setup =====
+
+cmd_dtb() {
+	[ $# -eq 2 ] || die "usage: sim.sh dtb <base.dtb> <out.dtb>"
+	mkdir -p "$SIM_DIR"
+	dtc -@ -q -I dts -O dtb -o "$SIM_DIR/topst-sim.dtbo" "$HERE/topst-sim.dtso" || exit 1
+	fdtoverlay -i "$1" -o "$2" "$SIM_DIR/topst-sim.dtbo" || exit 1
+	echo "sim: $2 (boot with this dtb, then sim.sh up)"
+}
+
+load_overlay() {
+	if [ -e /proc/device-tree/gpio-sim ]; then
+		return 0        # 합친 dtb 로 부팅함
+	fi
+	[ -d "$(dirname "$OVERLAY_CFS")" ] ||
+		die "no DT overlay configfs; boot with 'sim.sh dtb' output instead"
+	dtc -@ -q -I dts -O dtb -o "$SIM_DIR/topst-sim.dtbo" "$HERE/topst-sim.dtso" || exit 1
+	mkdir -p "$OVERLAY_CFS"
+	cat "$SIM_DIR/topst-sim.dtbo" > "$OVERLAY_CFS/dtbo" || die "overlay apply failed"
+}
+
+load_modules() {
+	if [ -f "$KO_DIR/topst_body.ko" ]; then
+		insmod "$KO_DIR/topst_body.ko"
+		return
+	fi
+	insmod "$KO_DIR/topst_core.ko" || exit 1
+	for m in ambient wiper window aircon headlamp; do
+		insmod "$KO_DIR/${m}_driver.ko" || exit 1
+	done
+}
+
+# /sys/class/pwm 과 같은 모양: export/unexport 는 그냥 파일, pwmN 은 미리 만들어 둠
+make_pwm_tree() {
+	local ch a
+	for ch in 0 1 2 3; do
+		mkdir -p "$SIM_DIR/pwm/pwmchip0/pwm$ch"
+		for a in period duty_cycle enable; do
+			echo 0 > "$SIM_DIR/pwm/pwmchip0/pwm$ch/$a"
+		done
+	done
+	: > "$SIM_DIR/pwm/pwmchip0/export"
+	: > "$SIM_DIR/pwm/pwmchip0/unexport"
+}
+
+cmd_up() {
+	[ "$(id -u)" = 0 ] || die "run as root"
+	mkdir -p "$SIM_DIR"
+	modprobe gpio-sim 2>/dev/null
+	load_overlay
+	load_modules
+	make_pwm_tree
+
+	# 리미트 스위치는 안 눌린 상태(HIGH)에서 시작
+	echo pull-up > "$(sim_line topst-win-limit-lower)/pull"
+	echo pull-up > "$(sim_line topst-win-limit-upper)/pull"
+
+	for i in $(seq 50); do
+		ls /dev/window_dev /dev/wiper_dev /dev/ambient_dev /dev/headlamp_dev >/dev/null 2>&1 && break
+		sleep 0.1
+	done
+	echo "sim: up ($SIM_DIR)"
+	grep . /sys/class/topst/*/stats/probe_ns 2>/dev/null
+}
+
+cmd_down() {
+	pkill -INT -x wiper_daemon 2>/dev/null
+	pkill -INT -x ambient_daemon 2>/dev/null
+	sleep 0.3
+	if [ -f "$KO_DIR/topst_body.ko" ]; then
+		rmmod topst_body 2>/dev/null
+	else
+		for m in headlamp aircon window wiper ambient; do
+			rmmod "${m}_driver" 2>/dev/null
+		done
+		rmmod topst_core 2>/dev/null
+	fi
+	[ -d "$OVERLAY_CFS" ] && rmdir "$OVERLAY_CFS"
+	rm -rf "$SIM_DIR"
+	echo "sim: down"
+}
+
+# ===== 결과 =====
+
+# report <scenario> <ok:0|1> <detail>
+report() {
+	local verdict=PASS
+	[ "$2" = 0 ] || { verdict=FAIL; FAILED=1; }
+	printf '%-4s %-18s %s\n' "$verdict" "$1" "$3"
+	printf '%s %s %s %s\n' "$(date +%FT%T)" "$verdict" "$1" "$3" >> "$SIM_DIR/results.log"
+}
+
+# "k1=v1 k2=v2 ..." 에서 값 하나
+field() { tr ' ' '\n' <<<"$1" | sed -n "s/^$2=//p"; }
+
+# awk 로 실수 비교: fcmp "<a> <op> <b>"
+fcmp() { awk "BEGIN { exit !($1) }"; }
+
+# ===== 시나리오 =====
+
+# 리미트 스위치 눌림(pull-down) → IN1/IN2 둘 다 0 이 될 때까지
+window_stop() {
+	local name=$1 dir=$2 limit=$3
+	local in1 in2 sw out lat sum=0 max=0 n=0 timeouts=0
+	in1=$(sim_line topst-win-in1)/value
+	in2=$(sim_line topst-win-in2)/value
+	sw=$(sim_line "$limit")
+
+	for i in $(seq "$WINDOW_STOP_RUNS"); do
+		echo pull-up > "$sw/pull"
+		"$BIN/window_setter" "$dir" >/dev/null
+		sleep 0.05
+		out=$("$BIN/sim_probe" edge "$sw/pull" pull-down 0 "$in1" "$in2")
+		lat=$(field "$out" latency_us)
+		if [ "$lat" = timeout ]; then
+			timeouts=$((timeouts + 1))
+			continue
+		fi
+		n=$((n + 1))
+		sum=$(awk "BEGIN { print $sum + $lat }")
+		fcmp "$lat > $max" && max=$lat
+	done
+	echo pull-up > "$sw/pull"
+	"$BIN/window_setter" stop >/dev/null
+
+	local avg
+	avg=$(awk "BEGIN { printf \"%.1f\", $n ? $sum / $n : 0 }")
+	fcmp "$timeouts == 0 && $max <= $WINDOW_STOP_MAX_US"
+	report "$name" $? "runs=$n avg_us=$avg max_us=$max timeouts=$timeouts (max <= $WINDOW_STOP_MAX_US)"
+}
+
+scn_window-stop-upper() { window_stop window-stop-upper open topst-win-limit-upper; }
+scn_window-stop-lower() { window_stop window-stop-lower close topst-win-limit-lower; }
+
+wiper_period() {
+	local name=$1 mode=$2 expect=$3 pid out avg
+	TOPST_PWM_BASE=$SIM_DIR/pwm "$BIN/wiper_daemon" > "$SIM_DIR/wiper_daemon.log" 2>&1 &
+	pid=$!
+	"$BIN/wiper_setter" "$mode" >/dev/null
+	sleep 0.5
+	# 왕복 3 번 이상 보이게
+	out=$("$BIN/sim_probe" pwm "$SIM_DIR/pwm/pwmchip0/pwm0/duty_cycle" $(( expect * 4 / 1000 + 1 )))
+	"$BIN/wiper_setter" off >/dev/null
+	kill -INT $pid; wait $pid
+
+	avg=$(field "$out" period_avg_ms)
+	fcmp "$(field "$out" periods) >= 2 && \
+	      $avg >= $expect * (100 - $WIPER_TOL_PCT) / 100 && $avg <= $expect * (100 + $WIPER_TOL_PCT) / 100"
+	report "$name" $? "period_avg_ms=$avg period_max_ms=$(field "$out" period_max_ms) (expect $expect +-$WIPER_TOL_PCT%)"
+}
+
+scn_wiper-fast() { wiper_period wiper-fast fast "$WIPER_FAST_MS"; }
+scn_wiper-slow() { wiper_period wiper-slow slow "$WIPER_SLOW_MS"; }
+
+scn_ambient-fps() {
+	local fifo=$SIM_DIR/spi.fifo probe pid out fps gap
+	rm -f "$fifo"; mkfifo "$fifo"
+	"$BIN/ambient_setter" brightness 100 >/dev/null
+	"$BIN/ambient_setter" color rainbow >/dev/null
+	"$BIN/sim_probe" spi "$fifo" "${LED_COUNT:-30}" 5 > "$SIM_DIR/spi.out" &
+	probe=$!
+	"$BIN/ambient_daemon" --spi "$fifo" > "$SIM_DIR/ambient_daemon.log" 2>&1 &
+	pid=$!
+	wait $probe
+	kill -INT $pid; wait $pid
+	out=$(cat "$SIM_DIR/spi.out")
+
+	fps=$(field "$out" fps)
+	gap=$(field "$out" interval_max_ms)
+	fcmp "$fps >= $AMBIENT_FPS_MIN && $gap <= $AMBIENT_GAP_MAX_MS && $(field "$out" bad) == 0"
+	report ambient-fps $? "fps=$fps interval_max_ms=$gap bad=$(field "$out" bad) (fps >= $AMBIENT_FPS_MIN)"
+}
+
+scn_headlamp-mask() {
+	local out hz seg
+	out=$("$BIN/headlamp_setter" mask-sweep 60 3 8 | head -1)
+	hz=$(sed -n 's/.*(\([0-9.]*\) Hz).*/\1/p' <<<"$out")
+	seg=$(sim_line topst-seg0)
+	fcmp "${hz:-0} >= $HEADLAMP_RATE_MIN"
+	report headlamp-mask $? "rate_hz=${hz:-0} seg0=$(cat "$seg/value") (>= $HEADLAMP_RATE_MIN) $(sed -n 's/.*ioctl/ioctl/p' <<<"$out")"
+}
+
+# 전부 끈 채 autosuspend 를 기다린 뒤 데몬/모터 쓰레드가 초당 몇 번 깨는지
+scn_park-wakeups() {
+	local pids="" p s out rate ok=0 detail="" states=""
+	"$BIN/wiper_setter" off >/dev/null
+	"$BIN/aircon_setter" off >/dev/null
+	"$BIN/window_setter" stop >/dev/null
+	"$BIN/ambient_setter" color off >/dev/null
+	TOPST_PWM_BASE=$SIM_DIR/pwm "$BIN/wiper_daemon" > "$SIM_DIR/wiper_daemon.log" 2>&1 &
+	pids="$pids $!"
+	TOPST_PWM_BASE=$SIM_DIR/pwm "$BIN/aircon_daemon" > "$SIM_DIR/aircon_daemon.log" 2>&1 &
+	pids="$pids $!"
+	"$BIN/ambient_daemon" --spi /dev/null > "$SIM_DIR/ambient_daemon.log" 2>&1 &
+	pids="$pids $!"
+	sleep "$PARK_SETTLE_S"
+
+	for s in wiper aircon window ambient; do
+		p=$(cat "/sys/class/topst/${s}_dev/park/state" 2>/dev/null)
+		[ "$p" = suspended ] || ok=1
+		states="$states $s=${p:-?}"
+	done
+	# comm 은 15 자로 잘림 (window_dev_thread)
+	for p in wiper_daemon aircon_daemon ambient_daemon window_dev_thre; do
+		out=$("$BIN/sim_probe" wakeups "$p" "$PARK_MEASURE_S")
+		rate=$(field "$out" per_sec)
+		fcmp "${rate:-999} <= $PARK_WAKEUPS_MAX" || ok=1
+		detail="$detail $p=${rate:-?}"
+	done
+	kill -INT $pids; wait $pids
+	report park-wakeups $ok "per_sec:$detail (<= $PARK_WAKEUPS_MAX) state:$states"
+}
+
+cmd_run() {
+	local s
+	[ -e /dev/window_dev ] || die "not up (sim.sh up)"
+	for s in ${*:-$SCENARIOS}; do
+		declare -F "scn_$s" >/dev/null || die "unknown scenario $s"
+		"scn_$s"
+	done
+	return $FAILED
+}
+
+case "${1:-}" in
+dtb)  shift; cmd_dtb "$@" ;;
+up)   cmd_up ;;
+down) cmd_down ;;
+run)  shift; cmd_run "$@" ;;
+list) tr ' ' '\n' <<<"$SCENARIOS" ;;
+*)    sed -n '4,16p' "$0" | sed 's/^# \{0,1\}//'; exit 1 ;;
+esac
@@ -7,26 +7,37 @@
 #include <string.h>
 #include <sys/ioctl.h>
 #include "pwm_utils.h"
+#include "rt_profile.h"
+#include "topst_park.h"
+#include "vehicle.h"
 
 #define DEVICE_PATH "/dev/aircon_dev"
 
 #define AIRCON_MAGIC 'A'
 #define AIRCON_GET_LEVEL _IOR(AIRCON_MAGIC, 2, int)
 
+struct aircon_status {
+    int level;
+    int manual;
+    unsigned int cool_state;
+    unsigned int cur_state;
+    unsigned int max_state;
+    unsigned int duty_pct;
+    int pwm_owned;
+    int boosting;
+};
+#define AIRCON_GET_STATUS _IOR(AIRCON_MAGIC, 3, struct aircon_status)
+
 #define AIRCON_LEVEL_OFF  0
 #define AIRCON_LEVEL_LOW  1
 #define AIRCON_LEVEL_MID  2
 #define AIRCON_LEVEL_HIGH 3
 
-#define PWM_CHIP         0
-#define PWM_CHANNEL      1  // wiper가 pwm0 쓰므로 여기서는 pwm1
-#define PWM_PERIOD_NS    20000000
-#define DUTY_LOW_NS      10000000   // 50%
-#define DUTY_MID_NS      16000000   // 80%
-#define DUTY_HIGH_NS     20000000   // 100%
-#define DUTY_BOOST_NS    20000000   // 100% 부스팅
+// PWM 채널/주기, 단계별 duty, boost 는 vehicle.h (variant)
+#define PWM_CHIP         vehicle.aircon.pwm_chip
+#define PWM_CHANNEL      vehicle.aircon.pwm_channel
 
-#define BOOST_DURATION_MS 1000
+#define POLL_MS           200
 
 static bool keep_running = true;
 
@@ -35,33 +46,75 @@ void handle_sigint(int sig) {
 }
 
 int level_to_duty(int level) {
-    switch (level) {
-        case AIRCON_LEVEL_LOW:  return DUTY_LOW_NS;
-        case AIRCON_LEVEL_MID:  return DUTY_MID_NS;
-        case AIRCON_LEVEL_HIGH: return DUTY_HIGH_NS;
-        default: return 0;
-    }
+    if (level < AIRCON_LEVEL_OFF || level > AIRCON_LEVEL_HIGH)
+        return 0;
+    return vehicle.aircon.duty_ns[level];
 }
 
-int main() {
+int main(int argc, char *argv[]) {
+    struct rt_profile rt;
+    rt_profile_init(&rt);
+    if (vehicle_setup(&argc, argv) < 0 || rt_parse_args(&rt, &argc, argv) < 0 || argc > 1) {
+        fprintf(stderr, "Usage: %s\n", argv[0]);
+        rt_usage(stderr);
+        vehicle_usage(stderr);
+        return EXIT_FAILURE;
+    }
+
     int fd = open(DEVICE_PATH, O_RDWR);
     if (fd < 0) {
         perror("open /dev/aircon_dev");
         return EXIT_FAILURE;
     }
 
+    // DT 에 pwms 가 있으면 드라이버(thermal cooling device)가 팬을 직접 구동
+    struct aircon_status st;
+    if (ioctl(fd, AIRCON_GET_STATUS, &st) == 0 && st.pwm_owned) {
+        printf("aircon_driver drives the fan PWM itself; daemon not needed.\n");
+        close(fd);
+        return 0;
+    }
+
     signal(SIGINT, handle_sigint);
 
     pwm_export(PWM_CHIP, PWM_CHANNEL);
-    pwm_set_period(PWM_CHIP, PWM_CHANNEL, PWM_PERIOD_NS);
+    pwm_set_period(PWM_CHIP, PWM_CHANNEL, vehicle.aircon.period_ns);
     pwm_enable(PWM_CHIP, PWM_CHANNEL, 0);
 
+    struct pwm_chan chan;
+    if (pwm_chan_open(&chan, PWM_CHIP, PWM_CHANNEL) < 0) {
+        close(fd);
+        return EXIT_FAILURE;
+    }
+    chan.enabled = 0;
+
     int prev_level = -1;
 
-    printf("Aircon daemon started.\n");
+    // 팬이 꺼진 채 suspend 되면 폴링을 멈추고 park/state 만 기다림
+    struct topst_park park;
+    park_open(&park, "aircon_dev");
+
+    rt_apply(&rt, "aircon_daemon");
+    rt_selftest(&rt, "aircon_daemon");
+
+    printf("Aircon daemon started (%s).\n", vehicle.name);
 
     while (keep_running) {
         int level;
+
+        if (park.state != PARK_ACTIVE) {
+            pwm_chan_update(&chan, 0, 0);
+            printf("Aircon parked (%s)\n", park_name(park.state));
+            if (park.state == PARK_PARKING)
+                park_ack(&park);
+            while (keep_running && park.state != PARK_ACTIVE)
+                park_wait(&park, -1);
+            if (keep_running)
+                printf("Aircon resumed\n");
+            prev_level = -1;    // 정지 상태에서 다시 기동하므로 boost 부터
+            continue;
+        }
+
         if (ioctl(fd, AIRCON_GET_LEVEL, &level) < 0) {
             perror("ioctl AIRCON_GET_LEVEL");
             break;
@@ -71,33 +124,32 @@ int main() {
             int duty = level_to_duty(level);
 
             if (level == AIRCON_LEVEL_OFF) {
-                pwm_set_duty_cycle(PWM_CHIP, PWM_CHANNEL, 0);
-                pwm_enable(PWM_CHIP, PWM_CHANNEL, 1);
+                pwm_chan_update(&chan, 0, 1);
                 printf("Aircon OFF\n");
 
-            } else if (level == AIRCON_LEVEL_LOW || level == AIRCON_LEVEL_MID) {
-                // Boost phase
-                pwm_set_duty_cycle(PWM_CHIP, PWM_CHANNEL, DUTY_BOOST_NS);
-                pwm_enable(PWM_CHIP, PWM_CHANNEL, 1);
-                printf("Aircon level %d → boost (%d ns)\n", level, DUTY_BOOST_NS);
-                usleep(BOOST_DURATION_MS * 1000);
+            } else if (duty < vehicle.aircon.boost_ns) {
+                // Boost phase (boost 보다 낮은 단계만)
+                pwm_chan_update(&chan, vehicle.aircon.boost_ns, 1);
+                printf("Aircon level %d → boost (%d ns)\n", level, vehicle.aircon.boost_ns);
+                usleep(vehicle.aircon.boost_ms * 1000);
 
                 // Normal phase
-                pwm_set_duty_cycle(PWM_CHIP, PWM_CHANNEL, duty);
+                pwm_chan_update(&chan, duty, 1);
                 printf("Aircon level %d → duty = %d ns\n", level, duty);
 
-            } else { // HIGH
-                pwm_set_duty_cycle(PWM_CHIP, PWM_CHANNEL, duty);
-                pwm_enable(PWM_CHIP, PWM_CHANNEL, 1);
+            } else { // HIGH (boost 이상)
+                pwm_chan_update(&chan, duty, 1);
                 printf("Aircon HIGH → duty = %d ns\n", duty);
             }
 
             prev_level = level;
         }
 
-        usleep(200000); // 200ms polling
+        park_wait(&park, POLL_MS); // 200ms polling, park 상태가 바뀌면 바로 깸
     }
 
+    park_close(&park);
+    pwm_chan_close(&chan);
     pwm_enable(PWM_CHIP, PWM_CHANNEL, 0);
     pwm_unexport(PWM_CHIP, PWM_CHANNEL);
     close(fd);
@@ -4,39 +4,89 @@
 #include <unistd.h>
 #include <string.h>
 #include <sys/ioctl.h>
+#include "setter_replay.h"
 
 #define AIRCON_MAGIC 'A'
 #define AIRCON_SET_LEVEL _IOW(AIRCON_MAGIC, 1, int)
 
+struct aircon_status {
+    int level;
+    int manual;
+    unsigned int cool_state;
+    unsigned int cur_state;
+    unsigned int max_state;
+    unsigned int duty_pct;
+    int pwm_owned;
+    int boosting;
+};
+#define AIRCON_GET_STATUS _IOR(AIRCON_MAGIC, 3, struct aircon_status)
+
+#define AIRCON_LEVEL_AUTO (-1)
 #define AIRCON_LEVEL_OFF  0
 #define AIRCON_LEVEL_LOW  1
 #define AIRCON_LEVEL_MID  2
 #define AIRCON_LEVEL_HIGH 3
 
 void usage(const char *progname) {
-    printf("Usage: %s [off|low|mid|high]\n", progname);
+    printf("Usage: %s [off|low|mid|high|auto|status]\n", progname);
+    printf("       %s --replay [file|-] [--max-rate] [--repeat N]\n", progname);
+    printf("       auto   : 수동 override 해제, thermal zone 이 팬 제어\n");
+}
+
+static int parse_level(const char *word, struct replay_cmd *out) {
+    out->req = AIRCON_SET_LEVEL;
+    if (strcmp(word, "off") == 0)
+        out->val = AIRCON_LEVEL_OFF;
+    else if (strcmp(word, "low") == 0)
+        out->val = AIRCON_LEVEL_LOW;
+    else if (strcmp(word, "mid") == 0)
+        out->val = AIRCON_LEVEL_MID;
+    else if (strcmp(word, "high") == 0)
+        out->val = AIRCON_LEVEL_HIGH;
+    else if (strcmp(word, "auto") == 0)
+        out->val = AIRCON_LEVEL_AUTO;
+    else
+        return -1;
+    return 0;
 }
 
 int main(int argc, char *argv[]) {
     int fd, level;
+    struct replay_cmd c;
+    struct aircon_status st;
+
+    if (argc >= 2 && strcmp(argv[1], "--replay") == 0)
+        return replay_main("/dev/aircon_dev", argc, argv, parse_level);
 
     if (argc != 2) {
         usage(argv[0]);
         return 1;
     }
 
-    if (strcmp(argv[1], "off") == 0)
-        level = AIRCON_LEVEL_OFF;
-    else if (strcmp(argv[1], "low") == 0)
-        level = AIRCON_LEVEL_LOW;
-    else if (strcmp(argv[1], "mid") == 0)
-        level = AIRCON_LEVEL_MID;
-    else if (strcmp(argv[1], "high") == 0)
-        level = AIRCON_LEVEL_HIGH;
-    else {
+    if (strcmp(argv[1], "status") == 0) {
+        fd = open("/dev/aircon_dev", O_RDONLY);
+        if (fd < 0) {
+            perror("open /dev/aircon_dev");
+            return 1;
+        }
+        if (ioctl(fd, AIRCON_GET_STATUS, &st) < 0) {
+            perror("ioctl AIRCON_GET_STATUS");
+            close(fd);
+            return 1;
+        }
+        printf("level %d (%s), state %u/%u (thermal %u), duty %u%%%s, pwm %s\n",
+               st.level, st.manual ? "manual" : "auto", st.cur_state, st.max_state,
+               st.cool_state, st.duty_pct, st.boosting ? " boost" : "",
+               st.pwm_owned ? "driver" : "daemon");
+        close(fd);
+        return 0;
+    }
+
+    if (parse_level(argv[1], &c) < 0) {
         usage(argv[0]);
         return 1;
     }
+    level = c.val;
 
     fd = open("/dev/aircon_dev", O_RDWR);
     if (fd < 0) {
@@ -0,0 +1,591 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
+#include "ambient_audio.h"
+
+#ifdef HAVE_ALSA
+#include <alsa/asoundlib.h>
+#endif
+
+#define FFT_M           (AUDIO_FFT_N / 2)     /* 내부 complex FFT 길이 */
+#define FFT_M_LOG2      8
+#define RING_BLOCKS     16
+#define RAW_RATE        48000
+
+/* band 레벨 (log2 Q4 단위) */
+#define LVL_RANGE       128     /* 표시 범위 8 bit ≈ 48 dB */
+#define LVL_SILENCE     96      /* peak 가 이보다 작으면 무음 */
+#define LVL_AGC_DECAY   1       /* 프레임당 peak 감소 (≈ 4.5 dB/s) */
+#define LVL_RELEASE     8       /* 출력 레벨 프레임당 감소 (0~255) */
+
+static int16_t hann_q15[AUDIO_FFT_N];
+static int16_t tw_cos[FFT_M], tw_sin[FFT_M];     /* W_N^k, k < N/2 */
+static uint16_t bitrev[FFT_M];
+static pthread_once_t tables_once = PTHREAD_ONCE_INIT;
+
+static void build_tables(void)
+{
+    for (int i = 0; i < AUDIO_FFT_N; i++)
+        hann_q15[i] = (int16_t)lrint(32767.0 * (0.5 - 0.5 * cos(2 * M_PI * i / AUDIO_FFT_N)));
+    for (int k = 0; k < FFT_M; k++) {
+        tw_cos[k] = (int16_t)lrint(32767.0 * cos(2 * M_PI * k / AUDIO_FFT_N));
+        tw_sin[k] = (int16_t)lrint(32767.0 * sin(2 * M_PI * k / AUDIO_FFT_N));
+    }
+    for (int i = 0; i < FFT_M; i++) {
+        unsigned r = 0;
+        for (int b = 0; b < FFT_M_LOG2; b++)
+            if (i & (1 << b))
+                r |= 1u << (FFT_M_LOG2 - 1 - b);
+        bitrev[i] = r;
+    }
+}
+
+/* ===== Q15 fixed-point real FFT ===== */
+
+/*
+ * 실수 N 점을 복소 N/2 점(z[k] = x[2k] + j x[2k+1])으로 접어 radix-2 FFT 후 분리.
+ * 매 단계 1/2 스케일이라 오버플로가 없고 결과는 DFT / (N/2).
+ */
+void audio_fft_mag2(const int16_t *in, uint32_t *mag2)
+{
+    int32_t re[FFT_M], im[FFT_M];
+
+    pthread_once(&tables_once, build_tables);
+
+    for (int k = 0; k < FFT_M; k++) {
+        int j = bitrev[k];
+        re[j] = (in[2 * k]     * hann_q15[2 * k])     >> 15;
+        im[j] = (in[2 * k + 1] * hann_q15[2 * k + 1]) >> 15;
+    }
+
+    for (int size = 2; size <= FFT_M; size <<= 1) {
+        int half = size >> 1, step = AUDIO_FFT_N / size;   /* W_M^j = W_N^(2j) */
+
+        for (int base = 0; base < FFT_M; base += size) {
+            for (int j = 0; j < half; j++) {
+                int32_t c = tw_cos[j * step], s = tw_sin[j * step];
+                int a = base + j, b = a + half;
+                /* t = x[b] * (c - js) */
+                int32_t tr = (re[b] * c + im[b] * s) >> 15;
+                int32_t ti = (im[b] * c - re[b] * s) >> 15;
+
+                re[b] = (re[a] - tr) >> 1;
+                im[b] = (im[a] - ti) >> 1;
+                re[a] = (re[a] + tr) >> 1;
+                im[a] = (im[a] + ti) >> 1;
+            }
+        }
+    }
+
+    /* X[k] = Fe[k] + W_N^k Fo[k], Fe = (Z[k] + Z*[M-k]) / 2, Fo = (Z[k] - Z*[M-k]) / 2j */
+    for (int k = 0; k < FFT_M; k++) {
+        int m = (FFT_M - k) & (FFT_M - 1);
+        int32_t fer = (re[k] + re[m]) >> 1, fei = (im[k] - im[m]) >> 1;
+        int32_t for_ = (im[k] + im[m]) >> 1, foi = (re[m] - re[k]) >> 1;
+        int32_t c = tw_cos[k], s = tw_sin[k];
+        int32_t xr = fer + ((for_ * c + foi * s) >> 15);
+        int32_t xi = fei + ((foi * c - for_ * s) >> 15);
+
+        mag2[k] = (uint32_t)(xr * xr) + (uint32_t)(xi * xi);
+    }
+}
+
+/* ===== 캡처 소스 ===== */
+
+struct audio_src {
+    int      fd;
+    int      channels;
+    int      rate;
+    int      paced;          /* 일반 파일: 실시간 속도로 읽고 끝나면 처음부터 */
+    off_t    data_off;
+    uint64_t next_ns;
+    uint8_t  pre[12];        /* 헤더가 아니었던 선두 바이트 (raw) */
+    int      pre_len;
+#ifdef HAVE_ALSA
+    snd_pcm_t *pcm;
+#endif
+};
+
+static volatile int audio_running;
+static pthread_t capture_tid, analysis_tid;
+static struct audio_src src;
+
+/* capture → analysis 블록 링 (SPSC). 차면 새 블록을 버림 */
+static int16_t ring_blk[RING_BLOCKS][AUDIO_HOP];
+static _Atomic unsigned ring_head, ring_tail;
+static sem_t ring_sem;
+
+/* analysis → render: band 8개 x 8bit 를 한 번에 교체 */
+static _Atomic uint64_t levels_packed;
+
+static struct {
+    _Atomic unsigned long blocks, overruns, xruns;
+    _Atomic unsigned long ffts, skipped, fft_ns, fft_ns_max;
+    uint64_t start_ns;
+} st;
+
+static uint64_t mono_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static int is_alsa_name(const char *name)
+{
+    return !strncmp(name, "hw:", 3) || !strncmp(name, "plughw:", 7) || !strcmp(name, "default");
+}
+
+/* stop 요청을 100ms 안에 볼 수 있도록 poll 로 기다리며 len 바이트를 채움 */
+static int fd_read_full(struct audio_src *s, void *buf, size_t len)
+{
+    uint8_t *p = buf;
+    size_t got = 0;
+
+    if (s->pre_len) {
+        size_t n = (size_t)s->pre_len < len ? (size_t)s->pre_len : len;
+        memcpy(p, s->pre, n);
+        memmove(s->pre, s->pre + n, s->pre_len - n);
+        s->pre_len -= n;
+        got = n;
+    }
+    while (got < len && audio_running) {
+        struct pollfd pfd = { .fd = s->fd, .events = POLLIN };
+        ssize_t n;
+
+        if (!s->paced && poll(&pfd, 1, 100) <= 0)
+            continue;
+        n = read(s->fd, p + got, len - got);
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+            return -1;
+        }
+        if (n == 0) {
+            if (s->paced)
+                lseek(s->fd, s->data_off, SEEK_SET);
+            else
+                usleep(100000);   /* FIFO writer 가 닫힘: 다시 열릴 때까지 */
+            continue;
+        }
+        got += n;
+    }
+    return got == len ? 0 : -1;
+}
+
+static uint32_t le32(const uint8_t *p) { return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24; }
+static uint16_t le16(const uint8_t *p) { return p[0] | p[1] << 8; }
+
+/* RIFF/WAVE 면 fmt/data 청크까지 읽고, 아니면 raw S16_LE mono 로 취급 */
+static int wav_parse(struct audio_src *s)
+{
+    uint8_t hdr[12], ch[8], fmt[16];
+
+    if (fd_read_full(s, hdr, sizeof(hdr)) < 0)
+        return -1;
+    if (memcmp(hdr, "RIFF", 4) || memcmp(hdr + 8, "WAVE", 4)) {
+        memcpy(s->pre, hdr, sizeof(hdr));
+        s->pre_len = sizeof(hdr);
+        s->channels = 1;
+        s->rate = RAW_RATE;
+        return 0;
+    }
+    for (;;) {
+        uint32_t len;
+
+        if (fd_read_full(s, ch, sizeof(ch)) < 0)
+            return -1;
+        len = le32(ch + 4);
+        if (!memcmp(ch, "data", 4))
+            break;
+        if (!memcmp(ch, "fmt ", 4) && len >= sizeof(fmt)) {
+            if (fd_read_full(s, fmt, sizeof(fmt)) < 0)
+                return -1;
+            if (le16(fmt) != 1 || le16(fmt + 14) != 16) {
+                fprintf(stderr, "[audio] WAV: 16-bit PCM 만 지원\n");
+                return -1;
+            }
+            s->channels = le16(fmt + 2);
+            s->rate = le32(fmt + 4);
+            len -= sizeof(fmt);
+        }
+        /* 나머지/모르는 청크는 건너뜀 (짝수 정렬) */
+        for (len += len & 1; len; ) {
+            uint8_t skip[64];
+            uint32_t n = len < sizeof(skip) ? len : sizeof(skip);
+            if (fd_read_full(s, skip, n) < 0)
+                return -1;
+            len -= n;
+        }
+    }
+    if (s->channels < 1 || s->channels > 8 || s->rate < 8000) {
+        fprintf(stderr, "[audio] WAV: 지원하지 않는 형식 (%d ch, %d Hz)\n", s->channels, s->rate);
+        return -1;
+    }
+    if (s->paced)
+        s->data_off = lseek(s->fd, 0, SEEK_CUR);
+    return 0;
+}
+
+static int src_open(struct audio_src *s, const char *name)
+{
+    struct stat sb;
+
+    memset(s, 0, sizeof(*s));
+    s->fd = -1;
+
+    if (is_alsa_name(name)) {
+#ifdef HAVE_ALSA
+        int err = snd_pcm_open(&s->pcm, name, SND_PCM_STREAM_CAPTURE, 0);
+        if (err == 0)
+            err = snd_pcm_set_params(s->pcm, SND_PCM_FORMAT_S16_LE, SND_PCM_ACCESS_RW_INTERLEAVED,
+                                     1, RAW_RATE, 1, 20000);
+        if (err < 0) {
+            fprintf(stderr, "[audio] %s: %s\n", name, snd_strerror(err));
+            return -1;
+        }
+        s->channels = 1;
+        s->rate = RAW_RATE;
+        return 0;
+#else
+        fprintf(stderr, "[audio] %s: ALSA 없이 빌드됨 (make ALSA=1)\n", name);
+        return -1;
+#endif
+    }
+
+    /* FIFO 는 writer 가 없어도 열리도록 O_NONBLOCK 으로 연 뒤 blocking 으로 되돌림 */
+    s->fd = open(name, O_RDONLY | O_NONBLOCK);
+    if (s->fd < 0) {
+        perror(name);
+        return -1;
+    }
+    fcntl(s->fd, F_SETFL, 0);
+    s->paced = fstat(s->fd, &sb) == 0 && S_ISREG(sb.st_mode);
+    return 0;
+}
+
+static void src_close(struct audio_src *s)
+{
+#ifdef HAVE_ALSA
+    if (s->pcm)
+        snd_pcm_close(s->pcm);
+#endif
+    if (s->fd >= 0)
+        close(s->fd);
+}
+
+/* AUDIO_HOP 프레임을 mono 로 읽음 */
+static int src_read(struct audio_src *s, int16_t *out)
+{
+#ifdef HAVE_ALSA
+    if (s->pcm) {
+        int got = 0;
+        while (got < AUDIO_HOP && audio_running) {
+            snd_pcm_sframes_t n;
+
+            if (snd_pcm_wait(s->pcm, 100) == 0)
+                continue;
+            n = snd_pcm_readi(s->pcm, out + got, AUDIO_HOP - got);
+            if (n < 0) {
+                atomic_fetch_add_explicit(&st.xruns, 1, memory_order_relaxed);
+                if (snd_pcm_recover(s->pcm, n, 1) < 0)
+                    return -1;
+                continue;
+            }
+            got += n;
+        }
+        return got == AUDIO_HOP ? 0 : -1;
+    }
+#endif
+    int16_t buf[AUDIO_HOP * 8];
+
+    if (fd_read_full(s, buf, AUDIO_HOP * s->channels * sizeof(int16_t)) < 0)
+        return -1;
+    for (int i = 0; i < AUDIO_HOP; i++) {
+        int32_t sum = 0;
+        for (int c = 0; c < s->channels; c++)
+            sum += buf[i * s->channels + c];
+        out[i] = sum / s->channels;
+    }
+
+    if (s->paced) {
+        struct timespec ts;
+
+        s->next_ns += (uint64_t)AUDIO_HOP * 1000000000ull / s->rate;
+        ts.tv_sec = s->next_ns / 1000000000ull;
+        ts.tv_nsec = s->next_ns % 1000000000ull;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+    }
+    return 0;
+}
+
+static void *capture_fn(void *arg)
+{
+    int16_t blk[AUDIO_HOP];
+
+    /* FIFO 는 writer 가 붙어야 헤더가 오므로 파싱도 캡처 스레드에서 */
+    if (src.fd >= 0 && wav_parse(&src) < 0) {
+        fprintf(stderr, "[audio] source header error, capture stopped\n");
+        return NULL;
+    }
+    printf("[audio] capture %d Hz, %d ch%s\n", src.rate, src.channels, src.paced ? " (file, looped)" : "");
+    src.next_ns = mono_ns();
+
+    while (audio_running) {
+        unsigned head, tail;
+
+        if (src_read(&src, blk) < 0)
+            break;
+        atomic_fetch_add_explicit(&st.blocks, 1, memory_order_relaxed);
+
+        head = atomic_load_explicit(&ring_head, memory_order_relaxed);
+        tail = atomic_load_explicit(&ring_tail, memory_order_acquire);
+        if (head - tail >= RING_BLOCKS) {
+            atomic_fetch_add_explicit(&st.overruns, 1, memory_order_relaxed);
+            continue;
+        }
+        memcpy(ring_blk[head % RING_BLOCKS], blk, sizeof(blk));
+        atomic_store_explicit(&ring_head, head + 1, memory_order_release);
+        sem_post(&ring_sem);
+    }
+    return arg;
+}
+
+/* log2(e) Q4 */
+static int log2_q4(uint64_t e)
+{
+    int n;
+
+    if (!e)
+        return 0;
+    n = 63 - __builtin_clzll(e);
+    return n * 16 + (int)(((e << (63 - n)) >> 59) & 0xf);
+}
+
+/* 60Hz ~ min(16kHz, fs/2) 를 로그 간격 band 로 나눈 FFT bin 경계 */
+static void band_edges(int edge[AUDIO_BANDS + 1], int rate)
+{
+    double hi = rate / 2.0 < 16000 ? rate / 2.0 : 16000;
+
+    for (int b = 0; b <= AUDIO_BANDS; b++) {
+        double f = 60.0 * pow(hi / 60.0, (double)b / AUDIO_BANDS);
+        edge[b] = (int)lrint(f * AUDIO_FFT_N / rate);
+        if (edge[b] < 1)
+            edge[b] = 1;
+        if (b && edge[b] <= edge[b - 1])
+            edge[b] = edge[b - 1] + 1;
+        if (edge[b] > AUDIO_FFT_N / 2)
+            edge[b] = AUDIO_FFT_N / 2;
+    }
+}
+
+static void *analysis_fn(void *arg)
+{
+    int16_t win[AUDIO_FFT_N] = { 0 };
+    uint32_t mag2[AUDIO_FFT_N / 2];
+    int edge[AUDIO_BANDS + 1];
+    int peak[AUDIO_BANDS] = { 0 };
+    int out[AUDIO_BANDS] = { 0 };
+    int rate = 0;
+
+    while (audio_running) {
+        struct timespec to;
+        unsigned head, tail;
+        uint64_t t0, packed = 0;
+
+        clock_gettime(CLOCK_REALTIME, &to);
+        to.tv_nsec += 100000000L;
+        if (to.tv_nsec >= 1000000000L) {
+            to.tv_sec++;
+            to.tv_nsec -= 1000000000L;
+        }
+        if (sem_timedwait(&ring_sem, &to) < 0) {
+            /* 입력이 끊기면 마지막 레벨로 멈춰 있지 않게 소등 */
+            if (errno == ETIMEDOUT) {
+                memset(out, 0, sizeof(out));
+                atomic_store_explicit(&levels_packed, 0, memory_order_release);
+            }
+            continue;
+        }
+
+        head = atomic_load_explicit(&ring_head, memory_order_acquire);
+        tail = atomic_load_explicit(&ring_tail, memory_order_relaxed);
+        if (head == tail)
+            continue;
+        /* rate 는 capture 가 첫 블록을 내기 전에 정함 (ring_head release 로 보임) */
+        if (rate != src.rate) {
+            rate = src.rate;
+            band_edges(edge, rate);
+        }
+
+        /* 밀렸으면 창 하나 분량만 남기고 버림: 프레임당 FFT 1회로 CPU 상한 고정 */
+        if (head - tail > AUDIO_FFT_N / AUDIO_HOP) {
+            unsigned skip = head - tail - AUDIO_FFT_N / AUDIO_HOP;
+            atomic_fetch_add_explicit(&st.skipped, skip, memory_order_relaxed);
+            tail += skip;
+        }
+        t0 = mono_ns();
+        for (; tail != head; tail++) {
+            memmove(win, win + AUDIO_HOP, (AUDIO_FFT_N - AUDIO_HOP) * sizeof(win[0]));
+            memcpy(win + AUDIO_FFT_N - AUDIO_HOP, ring_blk[tail % RING_BLOCKS],
+                   AUDIO_HOP * sizeof(win[0]));
+        }
+        atomic_store_explicit(&ring_tail, tail, memory_order_release);
+
+        audio_fft_mag2(win, mag2);
+
+        for (int b = 0; b < AUDIO_BANDS; b++) {
+            uint64_t e = 0;
+            int raw, lvl;
+
+            for (int k = edge[b]; k < edge[b + 1]; k++)
+                e += mag2[k];
+            raw = log2_q4(e);
+
+            /* band 별 AGC: 최근 peak 아래 LVL_RANGE 만큼을 0~255 로 */
+            peak[b] = raw > peak[b] - LVL_AGC_DECAY ? raw : peak[b] - LVL_AGC_DECAY;
+            if (peak[b] < LVL_SILENCE)
+                lvl = 0;
+            else
+                lvl = (raw - (peak[b] - LVL_RANGE)) * 255 / LVL_RANGE;
+            if (lvl < 0)
+                lvl = 0;
+            if (lvl > 255)
+                lvl = 255;
+
+            /* attack 즉시, release 천천히 */
+            out[b] = lvl > out[b] - LVL_RELEASE ? lvl : out[b] - LVL_RELEASE;
+            packed |= (uint64_t)out[b] << (8 * b);
+        }
+        atomic_store_explicit(&levels_packed, packed, memory_order_release);
+
+        uint64_t dt = mono_ns() - t0;
+        atomic_fetch_add_explicit(&st.ffts, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&st.fft_ns, dt, memory_order_relaxed);
+        if (dt > atomic_load_explicit(&st.fft_ns_max, memory_order_relaxed))
+            atomic_store_explicit(&st.fft_ns_max, dt, memory_order_relaxed);
+    }
+    return arg;
+}
+
+int audio_start(const char *name)
+{
+    pthread_once(&tables_once, build_tables);
+    if (src_open(&src, name) < 0)
+        return -1;
+
+    sem_init(&ring_sem, 0, 0);
+    st.start_ns = mono_ns();
+    audio_running = 1;
+    if (pthread_create(&capture_tid, NULL, capture_fn, NULL) != 0) {
+        audio_running = 0;
+        src_close(&src);
+        return -1;
+    }
+    if (pthread_create(&analysis_tid, NULL, analysis_fn, NULL) != 0) {
+        audio_stop();
+        return -1;
+    }
+    return 0;
+}
+
+void audio_stop(void)
+{
+    if (!audio_running)
+        return;
+    audio_running = 0;
+    pthread_join(capture_tid, NULL);
+    sem_post(&ring_sem);
+    if (analysis_tid)
+        pthread_join(analysis_tid, NULL);
+    src_close(&src);
+    atomic_store(&levels_packed, 0);
+}
+
+void audio_get_levels(uint8_t level[AUDIO_BANDS])
+{
+    uint64_t v = atomic_load_explicit(&levels_packed, memory_order_acquire);
+
+    for (int b = 0; b < AUDIO_BANDS; b++)
+        level[b] = v >> (8 * b);
+}
+
+void audio_print_stats(void)
+{
+    unsigned long ffts = atomic_load(&st.ffts);
+    double secs = (mono_ns() - st.start_ns) / 1e9;
+
+    if (!st.start_ns)
+        return;
+    printf("[audio] capture: blocks %lu (%.1f/s), overruns %lu, xruns %lu\n",
+           atomic_load(&st.blocks), secs > 0 ? atomic_load(&st.blocks) / secs : 0.0,
+           atomic_load(&st.overruns), atomic_load(&st.xruns));
+    if (ffts)
+        printf("[audio] analysis: %lu ffts, skipped blocks %lu, avg %.1f us, max %.1f us, cpu %.2f%%\n",
+               ffts, atomic_load(&st.skipped), atomic_load(&st.fft_ns) / 1e3 / ffts,
+               atomic_load(&st.fft_ns_max) / 1e3,
+               secs > 0 ? atomic_load(&st.fft_ns) / 1e7 / secs : 0.0);
+}
+
+/* ===== 검증 / 속도 ===== */
+
+int audio_bench(void)
+{
+    int16_t x[AUDIO_FFT_N];
+    uint32_t mag2[AUDIO_FFT_N / 2];
+    double sig = 0, err = 0, snr;
+    struct timespec t0, t1;
+    int iters = 20000;
+
+    pthread_once(&tables_once, build_tables);
+
+    /* 사인 3개 + 약한 잡음 */
+    srand(1);
+    for (int i = 0; i < AUDIO_FFT_N; i++) {
+        double v = 9000 * sin(2 * M_PI * 11.0 * i / AUDIO_FFT_N) +
+                   6000 * sin(2 * M_PI * 47.3 * i / AUDIO_FFT_N) +
+                   3000 * sin(2 * M_PI * 180.6 * i / AUDIO_FFT_N) +
+                   (rand() % 512 - 256);
+        x[i] = (int16_t)lrint(v);
+    }
+    audio_fft_mag2(x, mag2);
+
+    /* 같은 Q15 창을 씌운 입력의 double DFT / (N/2) 와 크기 비교 */
+    for (int k = 0; k < AUDIO_FFT_N / 2; k++) {
+        double re = 0, im = 0, ref, got;
+        for (int i = 0; i < AUDIO_FFT_N; i++) {
+            double w = (x[i] * hann_q15[i]) >> 15;
+            re += w * cos(2 * M_PI * k * i / AUDIO_FFT_N);
+            im -= w * sin(2 * M_PI * k * i / AUDIO_FFT_N);
+        }
+        ref = sqrt(re * re + im * im) / (AUDIO_FFT_N / 2);
+        got = sqrt((double)mag2[k]);
+        sig += ref * ref;
+        err += (got - ref) * (got - ref);
+    }
+    snr = 10 * log10(sig / (err > 0 ? err : 1e-12));
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < iters; i++) {
+        x[i & (AUDIO_FFT_N - 1)] ^= 1;
+        audio_fft_mag2(x, mag2);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    double us = ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / 1e3 / iters;
+    printf("audio FFT (Q15 real, N=%d): magnitude SNR vs double %.1f dB, %.2f us/frame"
+           " (%.2f%% CPU at %d Hz hop)\n", AUDIO_FFT_N, snr, us,
+           us * RAW_RATE / AUDIO_HOP / 1e4, RAW_RATE / AUDIO_HOP);
+    return snr >= 40.0 ? 0 : -1;
+}
@@ -0,0 +1,36 @@
+#ifndef AMBIENT_AUDIO_H
+#define AMBIENT_AUDIO_H
+
+#include <stdint.h>
+
+/*
+ * ambient "music" 모드용 오디오 분석.
+ *
+ *   capture 스레드 ── PCM 블록 링 ──> analysis 스레드 ── band 레벨(원자적 64bit) ──> render
+ *
+ * capture 는 블록 링이 차면 새 블록을 버리고(overrun), analysis 는 밀리면
+ * 최신 창만 FFT 한다. render 는 최신 레벨을 잠금 없이 읽기만 하므로
+ * 오디오 쪽이 멈추거나 느려도 SPI 출력 주기는 영향을 받지 않는다.
+ *
+ * 소스: "hw:0" / "plughw:..." / "default" → ALSA (make ALSA=1 로 빌드 시),
+ *       그 외 경로 → WAV 파일(헤더 파싱) 또는 raw S16_LE mono 48kHz FIFO.
+ *       일반 파일은 실시간 속도로 반복 재생한다.
+ */
+
+#define AUDIO_FFT_N     512       /* real FFT 길이 (Hann 창) */
+#define AUDIO_HOP       256       /* 블록 = 분석 간격 (48kHz 에서 5.3ms) */
+#define AUDIO_BANDS     8         /* 존 수(AMBIENT_MAX_ZONES)와 같게 */
+
+int  audio_start(const char *src);
+void audio_stop(void);
+/* 최신 band 레벨 0~255 (저역 → 고역). 아직 분석 결과가 없으면 전부 0 */
+void audio_get_levels(uint8_t level[AUDIO_BANDS]);
+/* 단계별 시간/버려진 블록 출력 */
+void audio_print_stats(void);
+
+/* Q15 real FFT: in[AUDIO_FFT_N] → mag2[AUDIO_FFT_N / 2] (|X[k]|^2, X = DFT / (N/2)) */
+void audio_fft_mag2(const int16_t *in, uint32_t *mag2);
+/* double DFT 기준과 비교(SNR) + FFT 1회 시간. SNR 이 기준 미달이면 -1 */
+int  audio_bench(void);
+
+#endif // AMBIENT_AUDIO_H
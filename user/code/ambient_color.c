@@ -0,0 +1,596 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "ambient_color.h"
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define COLOR_NEON 1
+#endif
+
+/* x / 100 == (x * 5243) >> 19, x <= 25500 (255 * 100) 에서 정확 */
+#define DIV100(x) (((uint32_t)(x) * 5243u) >> 19)
+
+static int clamp_brightness(int brightness)
+{
+    if (brightness < 0) return 0;
+    if (brightness > 100) return 100;
+    return brightness;
+}
+
+/* ===== scalar 기준 구현 (원래 ambient_daemon 코드) ===== */
+
+void hue_to_grb(uint8_t hue, uint8_t *g, uint8_t *r, uint8_t *b)
+{
+    int h = hue % 256;
+    if (h < 85) {
+        *r = h * 3;
+        *g = 255 - h * 3;
+        *b = 0;
+    } else if (h < 170) {
+        h -= 85;
+        *r = 255 - h * 3;
+        *g = 0;
+        *b = h * 3;
+    } else {
+        h -= 170;
+        *r = 0;
+        *g = h * 3;
+        *b = 255 - h * 3;
+    }
+}
+
+void color_rainbow_ref(uint8_t *grb, int n, uint8_t hue0, uint8_t step, int brightness)
+{
+    brightness = clamp_brightness(brightness);
+    for (int i = 0; i < n; i++) {
+        uint8_t rr, gg, bb;
+        hue_to_grb(hue0 + i * step, &gg, &rr, &bb);
+        grb[i*3 + 0] = (gg * brightness) / 100;
+        grb[i*3 + 1] = (rr * brightness) / 100;
+        grb[i*3 + 2] = (bb * brightness) / 100;
+    }
+}
+
+void color_scale_ref(uint8_t *buf, int len, int brightness)
+{
+    brightness = clamp_brightness(brightness);
+    for (int i = 0; i < len; i++)
+        buf[i] = (buf[i] * brightness) / 100;
+}
+
+void color_apply_lut_ref(uint8_t *buf, int len, const uint8_t lut[256])
+{
+    for (int i = 0; i < len; i++)
+        buf[i] = lut[buf[i]];
+}
+
+#ifdef COLOR_NEON
+/* ===== AArch64 NEON 경로 (16 LED / 16 바이트 단위) ===== */
+
+/* 꼬리 LED 용: 분기 없는 hue 변환 + 곱셈/시프트 나눗셈 */
+static inline void rainbow_px(uint8_t h, uint32_t br, uint8_t *out)
+{
+    uint8_t m0 = -(uint8_t)(h < 85);
+    uint8_t m2 = -(uint8_t)(h >= 170);
+    uint8_t m1 = ~(m0 | m2);
+    uint8_t t  = (uint8_t)(h - ((m2 & 170) | (m1 & 85))) * 3;
+    uint8_t nt = ~t;   /* 255 - t */
+
+    out[0] = DIV100(((m0 & nt) | (m2 & t)) * br);   /* G */
+    out[1] = DIV100(((m0 & t) | (m1 & nt)) * br);   /* R */
+    out[2] = DIV100(((m1 & t) | (m2 & nt)) * br);   /* B */
+}
+
+static inline uint8x16_t neon_scale(uint8x16_t c, uint16_t br)
+{
+    uint16x8_t lo = vmulq_n_u16(vmovl_u8(vget_low_u8(c)), br);
+    uint16x8_t hi = vmulq_n_u16(vmovl_high_u8(c), br);
+
+    /* (x * 5243) >> 16 >> 3 */
+    lo = vcombine_u16(vshrn_n_u32(vmull_n_u16(vget_low_u16(lo), 5243), 16),
+                      vshrn_n_u32(vmull_high_n_u16(lo, 5243), 16));
+    hi = vcombine_u16(vshrn_n_u32(vmull_n_u16(vget_low_u16(hi), 5243), 16),
+                      vshrn_n_u32(vmull_high_n_u16(hi, 5243), 16));
+    lo = vshrq_n_u16(lo, 3);
+    hi = vshrq_n_u16(hi, 3);
+    return vcombine_u8(vmovn_u16(lo), vmovn_u16(hi));
+}
+
+static int neon_rainbow(uint8_t *grb, int n, uint8_t hue0, uint8_t step, uint16_t br)
+{
+    static const uint8_t lane_idx[16] = { 0, 1, 2, 3, 4, 5, 6, 7,
+                                          8, 9, 10, 11, 12, 13, 14, 15 };
+    const uint8x16_t lanes = vmulq_u8(vld1q_u8(lane_idx), vdupq_n_u8(step));
+    const uint8x16_t c85 = vdupq_n_u8(85), c170 = vdupq_n_u8(170);
+    int i;
+
+    for (i = 0; i + 16 <= n; i += 16) {
+        uint8x16_t h  = vaddq_u8(vdupq_n_u8((uint8_t)(hue0 + i * step)), lanes);
+        uint8x16_t m0 = vcltq_u8(h, c85);
+        uint8x16_t m2 = vcgeq_u8(h, c170);
+        uint8x16_t m1 = vmvnq_u8(vorrq_u8(m0, m2));
+        uint8x16_t off = vorrq_u8(vandq_u8(m2, c170), vandq_u8(m1, c85));
+        uint8x16_t t  = vmulq_u8(vsubq_u8(h, off), vdupq_n_u8(3));
+        uint8x16_t nt = vmvnq_u8(t);
+        uint8x16x3_t px;
+
+        px.val[0] = neon_scale(vorrq_u8(vandq_u8(m0, nt), vandq_u8(m2, t)), br);
+        px.val[1] = neon_scale(vorrq_u8(vandq_u8(m0, t), vandq_u8(m1, nt)), br);
+        px.val[2] = neon_scale(vorrq_u8(vandq_u8(m1, t), vandq_u8(m2, nt)), br);
+        vst3q_u8(grb + i * 3, px);
+    }
+    return i;
+}
+
+static int neon_scale_buf(uint8_t *buf, int len, uint16_t br)
+{
+    int i;
+
+    for (i = 0; i + 16 <= len; i += 16)
+        vst1q_u8(buf + i, neon_scale(vld1q_u8(buf + i), br));
+    return i;
+}
+
+/* 256 엔트리 LUT = 64 엔트리 tbl 4개. 범위 밖 index 는 tbx 가 이전 값을 유지 */
+static int neon_lut(uint8_t *buf, int len, const uint8_t lut[256])
+{
+    uint8x16x4_t t[4];
+    int i;
+
+    for (int k = 0; k < 4; k++)
+        for (int j = 0; j < 4; j++)
+            t[k].val[j] = vld1q_u8(lut + k * 64 + j * 16);
+
+    for (i = 0; i + 16 <= len; i += 16) {
+        uint8x16_t idx = vld1q_u8(buf + i);
+        uint8x16_t v = vqtbl4q_u8(t[0], idx);
+        v = vqtbx4q_u8(v, t[1], vsubq_u8(idx, vdupq_n_u8(64)));
+        v = vqtbx4q_u8(v, t[2], vsubq_u8(idx, vdupq_n_u8(128)));
+        v = vqtbx4q_u8(v, t[3], vsubq_u8(idx, vdupq_n_u8(192)));
+        vst1q_u8(buf + i, v);
+    }
+    return i;
+}
+#endif /* COLOR_NEON */
+
+/* ===== 공개 함수 ===== */
+
+const char *color_impl_name(void)
+{
+#ifdef COLOR_NEON
+    return "neon";
+#else
+    return "portable";
+#endif
+}
+
+void color_fill(uint8_t *grb, int n, uint8_t r, uint8_t g, uint8_t b, int brightness)
+{
+    uint32_t br = clamp_brightness(brightness);
+    uint8_t px[3] = { DIV100(g * br), DIV100(r * br), DIV100(b * br) };
+
+    for (int i = 0; i < n; i++) {
+        grb[i*3 + 0] = px[0];
+        grb[i*3 + 1] = px[1];
+        grb[i*3 + 2] = px[2];
+    }
+}
+
+void color_rainbow(uint8_t *grb, int n, uint8_t hue0, uint8_t step, int brightness)
+{
+    uint32_t br = clamp_brightness(brightness);
+
+#ifdef COLOR_NEON
+    for (int i = neon_rainbow(grb, n, hue0, step, br); i < n; i++)
+        rainbow_px((uint8_t)(hue0 + i * step), br, grb + i * 3);
+#else
+    /*
+     * hue0 + i * step 은 256 / (step 의 최하위 비트) LED 주기로 반복되므로 한 주기만
+     * 계산하고 나머지는 앞부분을 복사. 주기 안은 분기가 거의 고정이라 scalar 변환이
+     * 분기 없는 마스크 계산이나 256 칸 hue 표보다 빠르다.
+     */
+    int period = step ? 256 / (step & -step) : 1;
+    int m = n < period ? n : period;
+
+    for (int i = 0; i < m; i++) {
+        uint8_t r, g, b;
+        hue_to_grb(hue0 + i * step, &g, &r, &b);
+        grb[i*3 + 0] = DIV100(g * br);
+        grb[i*3 + 1] = DIV100(r * br);
+        grb[i*3 + 2] = DIV100(b * br);
+    }
+    /* 복사량을 주기의 배수로 두 배씩: 복사 시작 i 가 늘 주기의 배수라 위상이 맞음 */
+    for (int i = m; i < n; ) {
+        int c = i < n - i ? i : n - i;
+
+        if (c >= period)
+            c -= c % period;
+        memcpy(grb + i * 3, grb, c * 3);
+        i += c;
+    }
+#endif
+}
+
+void color_scale(uint8_t *buf, int len, int brightness)
+{
+    uint32_t br = clamp_brightness(brightness);
+    int i = 0;
+
+#ifdef COLOR_NEON
+    i = neon_scale_buf(buf, len, br);
+#endif
+    for (; i < len; i++)
+        buf[i] = DIV100(buf[i] * br);
+}
+
+void color_apply_lut(uint8_t *buf, int len, const uint8_t lut[256])
+{
+    int i = 0;
+
+#ifdef COLOR_NEON
+    i = neon_lut(buf, len, lut);
+#endif
+    for (; i < len; i++)
+        buf[i] = lut[buf[i]];
+}
+
+/* 분기/나눗셈 없는 한 줄이라 -O2 에서도 컴파일러 벡터화에 맡김 */
+void color_blend(uint8_t *out, const uint8_t *from, const int16_t *delta, int len, int w)
+{
+    for (int i = 0; i < len; i++)
+        out[i] = from[i] + ((delta[i] * w) >> 8);
+}
+
+void color_build_gamma_lut(uint8_t lut[256], float gamma)
+{
+    for (int i = 0; i < 256; i++)
+        lut[i] = (uint8_t)(powf(i / 255.0f, gamma) * 255.0f + 0.5f);
+}
+
+/* ===== 출력 단계: 보정/gamma LUT + dither + SPI 인코딩 ===== */
+
+void color_spi_encode_ref(uint8_t byte, uint8_t *out)
+{
+    for (int i = 7; i >= 0; i--) {
+        uint8_t bit = (byte >> i) & 1;
+        uint8_t bits = bit ? 0b110 : 0b100;
+        for (int j = 2; j >= 0; j--)
+            *out++ = (bits >> j) & 1 ? 0xFF : 0x00;
+    }
+}
+
+void color_out_init(struct color_out *o, float gamma, const float gain_rgb[3], int dither)
+{
+    /* lut[] 는 G,R,B 순, gain_rgb 는 R,G,B 순 */
+    static const int gain_idx[3] = { 1, 0, 2 };
+
+    if (gamma <= 0.0f)
+        gamma = 1.0f;
+    for (int c = 0; c < 3; c++) {
+        float gain = gain_rgb ? gain_rgb[gain_idx[c]] : 1.0f;
+
+        if (gain < 0.0f) gain = 0.0f;
+        if (gain > 1.0f) gain = 1.0f;
+        for (int i = 0; i < 256; i++) {
+            float v = powf(i / 255.0f, gamma) * gain * (255.0f * 256.0f) + 0.5f;
+            o->lut[c][i] = v > 0xFF00 ? 0xFF00 : (uint16_t)v;
+        }
+    }
+    /* 밝기는 선형 조절이 눈에 고르게 보이도록 같은 gamma 를 태움 */
+    for (int b = 0; b <= 100; b++)
+        o->bright[b] = (uint32_t)(powf(b / 100.0f, gamma) * 65536.0f + 0.5f);
+    for (int v = 0; v < 256; v++)
+        color_spi_encode_ref(v, o->spi[v]);
+    o->dither = dither;
+}
+
+uint32_t color_out_scale(const struct color_out *o, int brightness)
+{
+    return o->bright[clamp_brightness(brightness)];
+}
+
+/* 보정+gamma+밝기 → 8.8 (lut <= 0xFF00, scale <= 65536 이라 32비트에서 넘치지 않음) */
+static inline uint32_t out_value(const struct color_out *o, int c, uint8_t in, uint32_t scale)
+{
+    return (o->lut[c][in] * scale) >> 16;
+}
+
+/*
+ * 8.8 값을 반올림하거나 (dither 면 누산기의 소수부를 더해 넘기고) 바로 SPI 표에서 복사.
+ * 인코딩이 바이트당 24바이트를 쓰는 동안 출력 값은 레지스터에만 있어 버퍼를 한 번만 지난다.
+ */
+static inline void out_encode(const struct color_out *o, uint8_t *spi, const uint8_t *in, int n,
+                              uint32_t scale, uint8_t *acc, const int order[3])
+{
+    if (o->dither && acc) {
+        for (int i = 0; i < n; i++, in += 3, acc += 3, spi += COLOR_SPI_BYTES_PER_LED) {
+            for (int c = 0; c < 3; c++) {
+                uint32_t v = out_value(o, c, in[order[c]], scale) + acc[c];
+
+                acc[c] = v;
+                memcpy(spi + c * 24, o->spi[v >> 8], 24);
+            }
+        }
+        return;
+    }
+    for (int i = 0; i < n; i++, in += 3, spi += COLOR_SPI_BYTES_PER_LED)
+        for (int c = 0; c < 3; c++)
+            memcpy(spi + c * 24, o->spi[(out_value(o, c, in[order[c]], scale) + 0x80) >> 8], 24);
+}
+
+void color_out_encode(const struct color_out *o, uint8_t *spi, const uint8_t *grb, int n,
+                      uint32_t scale, uint8_t *acc)
+{
+    static const int order[3] = { 0, 1, 2 };
+    out_encode(o, spi, grb, n, scale, acc, order);
+}
+
+void color_out_encode_rgb(const struct color_out *o, uint8_t *spi, const uint8_t *rgb, int n,
+                          uint32_t scale, uint8_t *acc)
+{
+    static const int order[3] = { 1, 0, 2 };
+    out_encode(o, spi, rgb, n, scale, acc, order);
+}
+
+/* ===== self-test / benchmark ===== */
+
+/* 비교용: 같은 보정+gamma+dither 를 바이트 버퍼에 한 번, SPI 인코딩으로 또 한 번 훑음 */
+static void out_two_pass(const struct color_out *o, uint8_t *spi, uint8_t *tmp, const uint8_t *grb,
+                         int n, uint32_t scale, uint8_t *acc)
+{
+    for (int i = 0; i < n * 3; i += 3) {
+        for (int c = 0; c < 3; c++) {
+            uint32_t v = out_value(o, c, grb[i + c], scale) + acc[i + c];
+
+            acc[i + c] = v;
+            tmp[i + c] = v >> 8;
+        }
+    }
+    for (int i = 0; i < n * 3; i++)
+        memcpy(spi + i * 24, o->spi[tmp[i]], 24);
+}
+
+int color_selftest(void)
+{
+    /* 16 의 배수가 아닌 길이로 NEON 본체 + 꼬리, 주기보다 긴 길이로 portable 복사 경로 확인 */
+    enum { N = 67, NLONG = 300 };
+    static const uint8_t steps[] = { 0, 1, 3, 4, 10, 37, 64, 255 };
+    uint8_t a[NLONG * 3], b[NLONG * 3], lut[256];
+    int bad = 0;
+
+    for (int br = -1; br <= 101; br++) {
+        for (unsigned s = 0; s < sizeof(steps); s++) {
+            for (int h = 0; h < 256; h++) {
+                color_rainbow_ref(a, N, h, steps[s], br);
+                color_rainbow(b, N, h, steps[s], br);
+                if (memcmp(a, b, N * 3) != 0)
+                    bad++;
+            }
+            color_rainbow_ref(a, NLONG, br, steps[s], br);
+            color_rainbow(b, NLONG, br, steps[s], br);
+            if (memcmp(a, b, NLONG * 3) != 0)
+                bad++;
+        }
+
+        for (int i = 0; i < N * 3; i++)
+            a[i] = b[i] = (uint8_t)(i * 97 + br);
+        /* 0~255 전 값이 나오도록 */
+        a[0] = b[0] = 255;
+        a[1] = b[1] = 0;
+        color_scale_ref(a, N * 3, br);
+        color_scale(b, N * 3, br);
+        if (memcmp(a, b, N * 3) != 0)
+            bad++;
+    }
+
+    for (int i = 0; i < 256; i++)
+        lut[i] = (uint8_t)(i * 131 + 7);
+    for (int off = 0; off < 256; off++) {
+        for (int i = 0; i < N * 3; i++)
+            a[i] = b[i] = (uint8_t)(i + off);
+        color_apply_lut_ref(a, N * 3, lut);
+        color_apply_lut(b, N * 3, lut);
+        if (memcmp(a, b, N * 3) != 0)
+            bad++;
+    }
+
+    /*
+     * 항등 출력 단계 == 원래 인코더, dither 는 256 프레임 합이 8.8 값과 정확히 같아야 하고
+     * 한 번에 인코딩한 결과가 두 번 훑는 구현과 같아야 함
+     */
+    {
+        static struct color_out out;
+        uint8_t px[3], spi[COLOR_SPI_BYTES_PER_LED], ref[COLOR_SPI_BYTES_PER_LED], acc[3];
+        static const float gain[3] = { 1.0f, 0.8f, 0.6f };
+
+        color_out_init(&out, 0.0f, NULL, 0);
+        for (int v = 0; v < 256; v++) {
+            px[0] = v; px[1] = 255 - v; px[2] = v * 7;
+            color_out_encode(&out, spi, px, 1, color_out_scale(&out, 100), NULL);
+            for (int c = 0; c < 3; c++)
+                color_spi_encode_ref(px[c], ref + c * 24);
+            if (memcmp(spi, ref, sizeof(spi)) != 0)
+                bad++;
+        }
+
+        color_out_init(&out, 2.2f, gain, 1);
+        for (int br = 1; br <= 100; br += 33) {
+            uint32_t scale = color_out_scale(&out, br);
+            for (int v = 0; v < 256; v += 5) {
+                uint32_t sum[3] = { 0, 0, 0 };
+                px[0] = px[1] = px[2] = v;
+                memset(acc, 0, sizeof(acc));
+                for (int f = 0; f < 256; f++) {
+                    color_out_encode(&out, spi, px, 1, scale, acc);
+                    for (int c = 0; c < 3; c++) {
+                        int d = 0;
+                        for (int k = 0; k < 8; k++)
+                            d = (d << 1) | (spi[c * 24 + k * 3 + 1] != 0);
+                        sum[c] += d;
+                    }
+                }
+                for (int c = 0; c < 3; c++)
+                    if (sum[c] != (uint32_t)(((uint64_t)out.lut[c][v] * scale) >> 16))
+                        bad++;
+            }
+        }
+
+        {
+            enum { NF = 40 };
+            uint8_t in[NF * 3], fa[NF * 3], fb[NF * 3], tmp[NF * 3];
+            static uint8_t sa[NF * COLOR_SPI_BYTES_PER_LED], sb[NF * COLOR_SPI_BYTES_PER_LED];
+
+            memset(fa, 0, sizeof(fa));
+            memset(fb, 0, sizeof(fb));
+            for (int i = 0; i < NF * 3; i++)
+                in[i] = (uint8_t)(i * 37);
+            for (int f = 0; f < 300; f++) {
+                uint32_t scale = color_out_scale(&out, f % 101);
+                color_out_encode(&out, sa, in, NF, scale, fa);
+                out_two_pass(&out, sb, tmp, in, NF, scale, fb);
+                if (memcmp(sa, sb, sizeof(sa)) != 0 || memcmp(fa, fb, sizeof(fa)) != 0)
+                    bad++;
+            }
+        }
+    }
+
+    printf("[color] selftest (%s): %s (%d mismatches)\n",
+           color_impl_name(), bad ? "FAIL" : "bit-exact", bad);
+    return bad;
+}
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void color_bench(int leds)
+{
+    const int iters = 2000;
+    uint8_t *buf = malloc(leds * 3);
+    uint8_t lut[256];
+    double t0, t_ref, t_vec;
+    volatile uint8_t sink = 0;
+
+    if (!buf) {
+        perror("malloc");
+        return;
+    }
+    color_build_gamma_lut(lut, 2.2f);
+
+    printf("[color] bench: %d LEDs, %d frames, impl=%s\n", leds, iters, color_impl_name());
+
+    t0 = now_sec();
+    for (int k = 0; k < iters; k++) {
+        color_rainbow_ref(buf, leds, k, 10, 73);
+        sink ^= buf[k % (leds * 3)];
+    }
+    t_ref = now_sec() - t0;
+    t0 = now_sec();
+    for (int k = 0; k < iters; k++) {
+        color_rainbow(buf, leds, k, 10, 73);
+        sink ^= buf[k % (leds * 3)];
+    }
+    t_vec = now_sec() - t0;
+    printf("  rainbow+scale : ref %8.2f us/frame, %s %8.2f us/frame, x%.1f\n",
+           t_ref * 1e6 / iters, color_impl_name(), t_vec * 1e6 / iters, t_ref / t_vec);
+
+    t0 = now_sec();
+    for (int k = 0; k < iters; k++) {
+        color_scale_ref(buf, leds * 3, 90);
+        sink ^= buf[k % (leds * 3)];
+    }
+    t_ref = now_sec() - t0;
+    t0 = now_sec();
+    for (int k = 0; k < iters; k++) {
+        color_scale(buf, leds * 3, 90);
+        sink ^= buf[k % (leds * 3)];
+    }
+    t_vec = now_sec() - t0;
+    printf("  scale         : ref %8.2f us/frame, %s %8.2f us/frame, x%.1f\n",
+           t_ref * 1e6 / iters, color_impl_name(), t_vec * 1e6 / iters, t_ref / t_vec);
+
+    t0 = now_sec();
+    for (int k = 0; k < iters; k++) {
+        color_apply_lut_ref(buf, leds * 3, lut);
+        sink ^= buf[k % (leds * 3)];
+    }
+    t_ref = now_sec() - t0;
+    t0 = now_sec();
+    for (int k = 0; k < iters; k++) {
+        color_apply_lut(buf, leds * 3, lut);
+        sink ^= buf[k % (leds * 3)];
+    }
+    t_vec = now_sec() - t0;
+    printf("  gamma LUT     : ref %8.2f us/frame, %s %8.2f us/frame, x%.1f\n",
+           t_ref * 1e6 / iters, color_impl_name(), t_vec * 1e6 / iters, t_ref / t_vec);
+
+    /*
+     * 출력 단계 (보정+gamma+밝기+dither → SPI): 바이트 버퍼를 거쳐 두 번 훑기 vs 인코딩 루프에
+     * 합친 것. 둘 다 같은 SPI 표를 쓰므로 차이는 중간 버퍼 쓰기/읽기뿐. 원래 비트 단위 인코더도 같이
+     */
+    {
+        static struct color_out out;
+        static const float gain[3] = { 1.0f, 0.85f, 0.7f };
+        uint8_t *spi = malloc((size_t)leds * COLOR_SPI_BYTES_PER_LED);
+        uint8_t *acc = calloc(leds, 3);
+        uint8_t *tmp = malloc(leds * 3);
+        double t_old;
+
+        if (!spi || !acc || !tmp) {
+            perror("malloc");
+            free(spi);
+            free(acc);
+            free(tmp);
+            free(buf);
+            return;
+        }
+        color_out_init(&out, 2.2f, gain, 1);
+        color_rainbow(buf, leds, 0, 10, 100);
+
+        t0 = now_sec();
+        for (int k = 0; k < iters; k++) {
+            color_apply_lut(buf, leds * 3, lut);
+            for (int i = 0; i < leds * 3; i++)
+                color_spi_encode_ref(buf[i], spi + i * 24);
+            sink ^= spi[k % (leds * COLOR_SPI_BYTES_PER_LED)];
+        }
+        t_old = now_sec() - t0;
+        /* 차이가 작아 번갈아 여러 번 재고 가장 빠른 회차끼리 비교 */
+        t_ref = t_vec = 1e9;
+        for (int r = 0; r < 10; r++) {
+            double t;
+
+            t0 = now_sec();
+            for (int k = 0; k < iters / 10; k++) {
+                color_out_encode(&out, spi, buf, leds, color_out_scale(&out, 73), acc);
+                sink ^= spi[k % (leds * COLOR_SPI_BYTES_PER_LED)];
+            }
+            t = (now_sec() - t0) * 10;
+            if (t < t_vec)
+                t_vec = t;
+            t0 = now_sec();
+            for (int k = 0; k < iters / 10; k++) {
+                out_two_pass(&out, spi, tmp, buf, leds, color_out_scale(&out, 73), acc);
+                sink ^= spi[k % (leds * COLOR_SPI_BYTES_PER_LED)];
+            }
+            t = (now_sec() - t0) * 10;
+            if (t < t_ref)
+                t_ref = t;
+        }
+        printf("  out stage     : gamma LUT + bit encoder %8.2f us/frame\n", t_old * 1e6 / iters);
+        printf("                  calib+gamma+dither: 2 pass %8.2f us/frame, fused %8.2f us/frame, x%.2f\n",
+               t_ref * 1e6 / iters, t_vec * 1e6 / iters, t_ref / t_vec);
+        free(spi);
+        free(acc);
+        free(tmp);
+    }
+
+    (void)sink;
+    free(buf);
+}
@@ -0,0 +1,66 @@
+#ifndef AMBIENT_COLOR_H
+#define AMBIENT_COLOR_H
+
+#include <stdint.h>
+
+/*
+ * ambient 색 생성 파이프라인. 출력은 LED 당 G,R,B 3바이트.
+ * AArch64 에서는 NEON, 그 외에는 portable C 경로를 쓰며 두 경로 모두
+ * *_ref (원래 데몬의 scalar 코드)와 bit-exact 하다. portable 의 rainbow 는
+ * hue 가 반복되는 한 주기만 scalar 로 계산하고 나머지는 memcpy 로 두 배씩 복사,
+ * scale 은 나눗셈 대신 곱셈/시프트.
+ */
+
+/* 단색 n 개, brightness 0~100 */
+void color_fill(uint8_t *grb, int n, uint8_t r, uint8_t g, uint8_t b, int brightness);
+/* LED i 의 hue = hue0 + i * step (mod 256) */
+void color_rainbow(uint8_t *grb, int n, uint8_t hue0, uint8_t step, int brightness);
+/* buf[i] = buf[i] * brightness / 100 */
+void color_scale(uint8_t *buf, int len, int brightness);
+/* buf[i] = lut[buf[i]] */
+void color_apply_lut(uint8_t *buf, int len, const uint8_t lut[256]);
+void color_build_gamma_lut(uint8_t lut[256], float gamma);
+/* crossfade 한 step: out = from + delta * w / 256 (w 0~256, delta = to - from) */
+void color_blend(uint8_t *out, const uint8_t *from, const int16_t *delta, int len, int w);
+
+/* scalar 기준 구현 */
+void hue_to_grb(uint8_t hue, uint8_t *g, uint8_t *r, uint8_t *b);
+void color_rainbow_ref(uint8_t *grb, int n, uint8_t hue0, uint8_t step, int brightness);
+void color_scale_ref(uint8_t *buf, int len, int brightness);
+void color_apply_lut_ref(uint8_t *buf, int len, const uint8_t lut[256]);
+
+/*
+ * 최종 출력 단계: 채널별 보정 gain x gamma 를 시작 시 8.8 고정소수점 LUT 로 한 번 만들고
+ * WS281x SPI 인코딩(비트당 3바이트, 바이트 → 24바이트 표)과 같은 루프에서 적용한다
+ * (버퍼를 따로 훑지 않음, --bench 의 "2 pass" 가 따로 훑는 경우).
+ * 밝기도 여기서 곱하므로 8비트로 먼저 잘리지 않고, dither 를 켜면 남은 소수부를
+ * LED 채널별 누산기로 다음 프레임에 넘긴다 (temporal sigma-delta).
+ */
+#define COLOR_SPI_BYTES_PER_LED (3 * 24)
+
+struct color_out {
+    uint16_t lut[3][256];     /* G,R,B 순. 0~255 → 8.8, 최대 0xFF00 */
+    uint32_t bright[101];     /* 밝기 0~100 → 배율 (65536 = 1.0), gamma 적용 */
+    uint8_t  spi[256][COLOR_SPI_BYTES_PER_LED / 3];   /* 출력 바이트 → SPI 24바이트 */
+    int      dither;
+};
+
+/* gamma <= 0 이면 1.0, gain_rgb 는 R,G,B 순 0~1 (NULL = 보정 없음). 기본값이면 항등 */
+void color_out_init(struct color_out *o, float gamma, const float gain_rgb[3], int dither);
+uint32_t color_out_scale(const struct color_out *o, int brightness);
+/* LED n 개 → spi. acc 는 LED 당 3바이트 누산기 (dither 가 꺼져 있으면 NULL 가능) */
+void color_out_encode(const struct color_out *o, uint8_t *spi, const uint8_t *grb, int n,
+                      uint32_t scale, uint8_t *acc);
+/* 입력이 R,G,B 순 (stream 프레임) */
+void color_out_encode_rgb(const struct color_out *o, uint8_t *spi, const uint8_t *rgb, int n,
+                          uint32_t scale, uint8_t *acc);
+/* 원래 데몬의 비트 단위 인코더 */
+void color_spi_encode_ref(uint8_t byte, uint8_t *out);
+
+const char *color_impl_name(void);
+/* 기준 구현과 전수 비교, 불일치 개수 반환 (0 = bit-exact) */
+int color_selftest(void);
+/* leds 개 스트립 기준 ref 대비 속도 출력 */
+void color_bench(int leds);
+
+#endif // AMBIENT_COLOR_H
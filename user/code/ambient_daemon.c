@@ -1,3 +1,4 @@
+    #define _GNU_SOURCE
     #include <stdio.h>
     #include <stdlib.h>
     #include <string.h>
@@ -6,21 +7,169 @@
     #include <stdint.h>
     #include <signal.h>
     #include <pthread.h>
+    #include <semaphore.h>
+    #include <stdatomic.h>
+    #include <errno.h>
+    #include <time.h>
+    #include <poll.h>
     #include <sys/ioctl.h>
+    #include <linux/types.h>
     #include <linux/spi/spidev.h>
+    #include "ambient_color.h"
+    #include "ambient_audio.h"
+    #include "ambient_stream.h"
+    #include "uring_io.h"
+    #include "rt_profile.h"
+    #include "topst_park.h"
+    #include "vehicle.h"
 
-    #define LED_COUNT 30
-    #define SPI_DEV "/dev/spidev1.0"
+    /* LED 수, SPI 버스/속도는 vehicle.h (variant). 배열은 LED_MAX (variant 빌드면 같은 값) */
+    #define LED_COUNT vehicle.ambient.leds
+    #define LED_MAX   VEH_LEDS_MAX
+    #define MAX_SPI_BUSES VEH_MAX_SPI
     #define AMBIENT_DEV "/dev/ambient_dev"
     #define FPS 10
+    #define MUSIC_FPS 60        /* music 모드가 보이는 동안 */
+    #define DITHER_FPS 120      /* --dither: 소수부를 시간으로 펴려면 정적인 장면도 계속 전송 */
+    #define PARK_TX_WAIT_MS 100 /* park 전 꺼진 프레임이 SPI 로 나갈 때까지 */
+    #define PARK_WAIT_MS 1000   /* 잠든 동안 running 확인 (SIGINT 가 다른 스레드로 갈 수 있음) */
 
     #define AMBIENT_MAGIC 'L'
     #define AMBIENT_GET_MODE        _IOR(AMBIENT_MAGIC, 2, char *)
     #define AMBIENT_GET_BRIGHTNESS  _IOR(AMBIENT_MAGIC, 4, int)
 
+    /* 멀티 존 (ambient_driver.c 와 동일) */
+    #define AMBIENT_MAX_ZONES  8
+
+    struct ambient_zone {
+        __u16 first;
+        __u16 count;
+        __s32 brightness;
+        char  mode[16];
+    };
+
+    struct ambient_zones {
+        __u32               nr;
+        struct ambient_zone bg;
+        struct ambient_zone zone[AMBIENT_MAX_ZONES];
+    };
+
+    #define AMBIENT_GET_ZONES       _IOR(AMBIENT_MAGIC, 7, struct ambient_zones)
+
+    /* 존 + 마지막 APPLY_SCENE (ambient_driver.c 와 동일) */
+    struct ambient_state {
+        struct ambient_zones zones;
+        __u32                scene;
+        __u32                scene_seq;
+        __u32                transition_ms;
+    };
+
+    #define AMBIENT_GET_STATE       _IOR(AMBIENT_MAGIC, 11, struct ambient_state)
+
+    /* segment 0 = 배경, 1..AMBIENT_MAX_ZONES = 존 */
+    #define NSEG (AMBIENT_MAX_ZONES + 1)
+    #define SPI_BYTES_PER_LED (3 * 24)
+
+    #define SPI_FRAME_BYTES (LED_COUNT * SPI_BYTES_PER_LED)
+    #define SPI_FRAME_MAX   (LED_MAX * SPI_BYTES_PER_LED)
+
     static volatile int running = 1;
     static uint8_t hue = 0;
 
+    static uint8_t owner[LED_MAX];                        /* LED 별 segment */
+    static uint8_t spi_data[SPI_FRAME_MAX];               /* render 쪽에서 유지되는 인코딩 버퍼 */
+    static uint8_t grb_tmp[LED_MAX * 3];                  /* segment 렌더링 scratch */
+    static uint8_t band_level[AUDIO_BANDS];               /* 이번 프레임의 오디오 band 레벨 */
+
+    /* 외부 프레임 입력 ("stream" 모드) */
+    static struct ambient_stream_server stream;
+    static const struct ambient_stream_slot *stream_cur;  /* 지금 쥐고 있는 프레임, 없으면 NULL */
+    static unsigned long stream_frames, stream_lost, stream_ring_dropped;
+    static unsigned long stream_conn_base;                /* 현재 연결 시작 시점의 lost + dropped */
+
+    /* 출력 단계 (보정 + gamma + dither, 인코딩과 한 루프) */
+    static struct color_out out;
+    static int     out_bright = 0;                        /* --gamma/--calib/--dither: 밝기도 출력 단계에서 */
+    static uint8_t dither_acc[LED_MAX * 3];               /* LED 채널별 sigma-delta 누산기 */
+
+    /* /sys/class/topst/ambient_dev/park/state: 꺼진 상태로 suspend 되면 렌더 루프를 얼림 */
+    static struct topst_park park;
+
+    /*
+     * render → transmit 프레임 링 (single producer / single consumer).
+     * 슬롯 3개를 미리 할당하고 producer/consumer 가 각각 하나씩 쥔 채
+     * 나머지 하나를 mailbox 로 원자적 교환한다. 전송이 밀리면 mailbox 에
+     * 남아 있던 프레임을 새 프레임으로 덮어쓴다 (drop-oldest, 대기열 깊이 1 —
+     * LED 출력은 오래된 프레임을 늦게 내보내는 것보다 최신만 내보내는 편이 낫다).
+     */
+    #define RING_SLOTS   3
+    #define SLOT_FRESH   0x100u
+    #define SLOT_IDX(v)  ((v) & 0xffu)
+
+    struct frame_ring {
+        uint8_t          frame[RING_SLOTS][SPI_FRAME_MAX];
+        _Atomic unsigned mailbox;     /* 슬롯 index | SLOT_FRESH */
+        unsigned         prod_slot;   /* render 스레드 전용 */
+        unsigned         cons_slot;   /* transmit 스레드 전용 */
+        sem_t            ready;       /* 새 프레임 도착 알림 */
+        /* stream 프레임이 실린 슬롯: publish 시각/순번 (아니면 0). 슬롯 소유자만 접근 */
+        uint64_t         origin_ns[RING_SLOTS];
+        uint64_t         origin_seq[RING_SLOTS];
+
+        /* 통계 */
+        _Atomic unsigned long rendered, produced, sent, dropped;
+        _Atomic unsigned long render_ns, tx_ns;
+        _Atomic unsigned long render_ns_max, tx_ns_max;
+        /* stream: publish → SPI write 완료 */
+        _Atomic unsigned long stream_sent, stream_lat_ns, stream_lat_max, stream_lat_last;
+        _Atomic unsigned long stream_shown_seq;
+    };
+
+    static struct frame_ring ring;
+
+    static void ring_init(struct frame_ring *rg) {
+        atomic_init(&rg->mailbox, 0);
+        rg->cons_slot = 1;
+        rg->prod_slot = 2;
+        sem_init(&rg->ready, 0, 0);
+    }
+
+    /* 채운 prod_slot 을 공개하고 다음에 쓸 슬롯을 돌려받음. 보내지 못한 프레임을 덮었으면 1 */
+    static int ring_publish(struct frame_ring *rg) {
+        unsigned old = atomic_exchange_explicit(&rg->mailbox, rg->prod_slot | SLOT_FRESH,
+                                                memory_order_acq_rel);
+        rg->prod_slot = SLOT_IDX(old);
+        atomic_fetch_add_explicit(&rg->produced, 1, memory_order_relaxed);
+        if (old & SLOT_FRESH) {
+            atomic_fetch_add_explicit(&rg->dropped, 1, memory_order_relaxed);
+            return 1;
+        }
+        sem_post(&rg->ready);
+        return 0;
+    }
+
+    /* 최신 프레임을 꺼냄. 없으면 0 */
+    static int ring_take(struct frame_ring *rg) {
+        if (!(atomic_load_explicit(&rg->mailbox, memory_order_acquire) & SLOT_FRESH))
+            return 0;
+        unsigned old = atomic_exchange_explicit(&rg->mailbox, rg->cons_slot,
+                                                memory_order_acq_rel);
+        rg->cons_slot = SLOT_IDX(old);
+        return 1;
+    }
+
+    static uint64_t now_ns(void) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+    }
+
+    /* 단일 writer 통계의 최댓값 갱신 */
+    static void stat_max(_Atomic unsigned long *m, unsigned long v) {
+        if (v > atomic_load_explicit(m, memory_order_relaxed))
+            atomic_store_explicit(m, v, memory_order_relaxed);
+    }
+
     void handle_sigint(int sig) {
         running = 0;
     }
@@ -36,111 +185,900 @@
         else                                 { *r = 0;   *g = 0;   *b = 0;   }
     }
 
-    void hue_to_grb(uint8_t hue, uint8_t *g, uint8_t *r, uint8_t *b) {
-        int h = hue % 256;
-        if (h < 85) {
-            *r = h * 3;
-            *g = 255 - h * 3;
-            *b = 0;
-        } else if (h < 170) {
-            h -= 85;
-            *r = 255 - h * 3;
-            *g = 0;
-            *b = h * 3;
+    /* 색 생성에 쓸 밝기. 출력 단계가 켜져 있으면 최대로 만들고 밝기는 인코딩 때 곱함 */
+    static int gen_brightness(int brightness) {
+        return out_bright ? 100 : brightness;
+    }
+
+    static uint32_t out_scale(int brightness) {
+        return color_out_scale(&out, out_bright ? brightness : 100);
+    }
+
+    /* 다음 LED 부터 segment s 소유가 끊기는 곳 (s < 0 이면 hi) */
+    static int owned_run_end(int i, int hi, int s) {
+        if (s < 0)
+            return hi;
+        while (i < hi && owner[i] == s)
+            i++;
+        return i;
+    }
+
+    static int is_music(const struct ambient_zone *z) {
+        return strcmp(z->mode, "music") == 0;
+    }
+
+    static int is_stream(const struct ambient_zone *z) {
+        return strcmp(z->mode, "stream") == 0;
+    }
+
+    static int is_animated(const struct ambient_zone *z) {
+        return strcmp(z->mode, "rainbow") == 0 || is_music(z);
+    }
+
+    /* band b 의 색: 저역 빨강 → 고역 초록/파랑, 밝기는 레벨에 비례 */
+    static void fill_band(uint8_t *grb, int n, int b, int brightness) {
+        uint8_t rr, gg, bb;
+        hue_to_grb((uint8_t)(85 + b * 256 / AUDIO_BANDS), &gg, &rr, &bb);
+        color_fill(grb, n, rr, gg, bb, brightness * band_level[b] / 255);
+    }
+
+    /*
+     * 프레임의 유효 LED 수. slot 은 producer 가 마음대로 쓸 수 있는 공유 메모리라
+     * 한 번만 읽고 rgb[] 크기와 스트립 길이 안으로 자른다.
+     */
+    static int stream_leds(const struct ambient_stream_slot *sf) {
+        uint32_t n;
+
+        if (!sf)
+            return 0;
+        n = *(const volatile uint32_t *)&sf->leds;
+        if (n > AMBIENT_STREAM_MAX_LEDS)
+            n = AMBIENT_STREAM_MAX_LEDS;
+        if (n > (uint32_t)LED_COUNT)
+            n = LED_COUNT;
+        return n;
+    }
+
+    /*
+     * 외부 프레임을 공유 메모리에서 바로 인코딩 (RGB → GRB, 출력 단계는 인코딩 루프 안).
+     * s < 0 이면 소유 검사 없이 [lo, hi) 전부. 프레임 밖/없으면 소등.
+     */
+    static void render_stream(uint8_t *frame, int lo, int hi, int s, int brightness) {
+        static const uint8_t black[LED_MAX * 3];
+        const struct ambient_stream_slot *sf = stream_cur;
+        int n = stream_leds(sf);
+        uint32_t scale = color_out_scale(&out, brightness);
+
+        /* 외부 프레임은 원본 그대로라 밝기는 항상 출력 단계에서 곱함 */
+        for (int i = lo; i < hi; ) {
+            if (s >= 0 && owner[i] != s) {
+                i++;
+                continue;
+            }
+            int end = owned_run_end(i, hi, s);
+            int lit = end < n ? end : n;
+
+            if (lit > i)
+                color_out_encode_rgb(&out, frame + i * SPI_BYTES_PER_LED, sf->rgb + i * 3,
+                                     lit - i, scale, dither_acc + i * 3);
+            else
+                lit = i;
+            if (end > lit)
+                color_out_encode(&out, frame + lit * SPI_BYTES_PER_LED, black,
+                                 end - lit, scale, dither_acc + lit * 3);
+            i = end;
+        }
+    }
+
+    /* 존이면 존 번호의 band 하나, 배경이면 band 들을 스트립에 나란히 */
+    static void render_music(uint8_t *grb, int n, int s, int brightness) {
+        if (s > 0) {
+            fill_band(grb, n, (s - 1) % AUDIO_BANDS, brightness);
+            return;
+        }
+        for (int b = 0; b < AUDIO_BANDS; b++) {
+            int from = n * b / AUDIO_BANDS, to = n * (b + 1) / AUDIO_BANDS;
+            fill_band(grb + from * 3, to - from, b, brightness);
+        }
+    }
+
+    /*
+     * 최신 상태 조회. scene 이 없는 드라이버면 존만 (scene_seq 0 고정),
+     * 존 ioctl 도 없는 구 드라이버면 전역 모드만 배경으로 사용
+     */
+    static void fetch_state(int dev_fd, struct ambient_zones *st, struct ambient_state *sc) {
+        if (ioctl(dev_fd, AMBIENT_GET_STATE, sc) == 0) {
+            *st = sc->zones;
+            return;
+        }
+        sc->scene_seq = 0;
+        sc->transition_ms = 0;
+        if (ioctl(dev_fd, AMBIENT_GET_ZONES, st) == 0)
+            return;
+
+        memset(st, 0, sizeof(*st));
+        strcpy(st->bg.mode, "off");
+        ioctl(dev_fd, AMBIENT_GET_MODE, st->bg.mode);
+        ioctl(dev_fd, AMBIENT_GET_BRIGHTNESS, &st->bg.brightness);
+    }
+
+    static void build_owner_map(const struct ambient_zones *st) {
+        memset(owner, 0, sizeof(owner));
+        for (int z = 0; z < AMBIENT_MAX_ZONES; z++) {
+            int end = st->zone[z].first + st->zone[z].count;
+            if (end > LED_COUNT)
+                end = LED_COUNT;
+            for (int i = st->zone[z].first; i < end; i++)
+                owner[i] = z + 1;
+        }
+    }
+
+    static int same_geometry(const struct ambient_zones *a, const struct ambient_zones *b) {
+        for (int z = 0; z < AMBIENT_MAX_ZONES; z++) {
+            if (a->zone[z].first != b->zone[z].first ||
+                a->zone[z].count != b->zone[z].count)
+                return 0;
+        }
+        return 1;
+    }
+
+    static int same_look(const struct ambient_zone *a, const struct ambient_zone *b) {
+        return a->brightness == b->brightness && strcmp(a->mode, b->mode) == 0;
+    }
+
+    /* segment s 의 [lo, hi) 를 grb 에 생성 (stream 제외) */
+    static void render_look(uint8_t *grb, int lo, int hi, int s, const struct ambient_zone *z, int br) {
+        if (is_music(z)) {
+            render_music(grb, hi - lo, s, br);
+        } else if (is_animated(z)) {
+            color_rainbow(grb, hi - lo, hue + lo * 10, 10, br);
         } else {
-            h -= 170;
-            *r = 0;
-            *g = h * 3;
-            *b = 255 - h * 3;
+            uint8_t rr, gg, bb;
+            map_color(z->mode, &rr, &gg, &bb);
+            color_fill(grb, hi - lo, rr, gg, bb, br);
         }
     }
 
-    void encode_byte(uint8_t byte, uint8_t *out_buf) {
-        for (int i = 7; i >= 0; i--) {
-            uint8_t bit = (byte >> i) & 1;
-            uint8_t bits = bit ? 0b110 : 0b100;
-            for (int j = 2; j >= 0; j--) {
-                *out_buf++ = (bits >> j) & 1 ? 0xFF : 0x00;
+    /* segment 하나를 다시 그려 인코딩 버퍼에 패치 */
+    static void render_segment(int s, const struct ambient_zone *z) {
+        int lo = 0, hi = LED_COUNT;
+
+        if (s > 0) {
+            lo = z->first;
+            hi = z->first + z->count;
+            if (hi > LED_COUNT)
+                hi = LED_COUNT;
+        }
+        if (lo >= hi)
+            return;
+
+        if (is_stream(z)) {
+            render_stream(spi_data, lo, hi, s, z->brightness);
+            return;
+        }
+
+        /* 구간 전체를 벡터 경로로 생성한 뒤 이 segment 소유 LED 만 출력 단계 + 인코딩 */
+        render_look(grb_tmp, lo, hi, s, z, gen_brightness(z->brightness));
+
+        uint32_t scale = out_scale(z->brightness);
+        for (int i = lo; i < hi; ) {
+            if (owner[i] != s) {
+                i++;
+                continue;
             }
+            int end = owned_run_end(i, hi, s);
+            color_out_encode(&out, spi_data + i * SPI_BYTES_PER_LED, grb_tmp + (i - lo) * 3,
+                             end - i, scale, dither_acc + i * 3);
+            i = end;
         }
     }
 
-    void encode_leds(uint8_t *grb_data, uint8_t *spi_data, int led_count) {
-        for (int i = 0; i < led_count; i++) {
-            encode_byte(grb_data[i*3 + 0], spi_data + i*3*24 + 0);   // G
-            encode_byte(grb_data[i*3 + 1], spi_data + i*3*24 + 24);  // R
-            encode_byte(grb_data[i*3 + 2], spi_data + i*3*24 + 48);  // B
+    /*
+     * 한 논리 스트립을 여러 spidev 버스로 나눠 보냄. 버스마다 연속된 LED 구간을 맡고
+     * 링 슬롯의 해당 구간을 그대로 write 한다 (복사 없음). 버스가 둘 이상이면
+     * 버스마다 worker 스레드를 두고 frame_start 배리어에서 같이 출발,
+     * frame_done 배리어에서 모두 끝나기를 기다린 뒤 다음 프레임으로 넘어간다.
+     */
+    struct spi_bus {
+        const char      *path;
+        int              fd;
+        int              first, count;     /* LED 구간 */
+        pthread_t        thread;
+        struct uring_io  u;
+        uint64_t         last_ns;          /* 이번 프레임 write 시간 (worker → 배리어 → coordinator) */
+        _Atomic unsigned long frames, errors, ns, ns_max;
+    };
+
+    static struct spi_bus buses[MAX_SPI_BUSES];
+    static int nbus;
+    static pthread_barrier_t frame_start, frame_done;
+    static unsigned tx_slot;               /* 이번 프레임 슬롯, frame_start 전에 coordinator 가 기록 */
+    static _Atomic unsigned long skew_ns, skew_ns_max;  /* 프레임마다 가장 느린 버스 - 가장 빠른 버스 */
+
+    /* 링 슬롯 3개와 이 버스 fd 를 io_uring 에 등록. 실패하면 일반 write */
+    static int tx_uring_setup(struct uring_io *u, int spi_fd) {
+        struct iovec iov[RING_SLOTS];
+
+        if (uring_init(u, 4) < 0)
+            return -1;
+        for (int i = 0; i < RING_SLOTS; i++) {
+            iov[i].iov_base = ring.frame[i];
+            iov[i].iov_len = SPI_FRAME_BYTES;
+        }
+        if (uring_register_files(u, &spi_fd, 1) < 0 ||
+            uring_register_buffers(u, iov, RING_SLOTS) < 0) {
+            uring_exit(u);
+            return -1;
         }
+        return 0;
     }
 
-    int main() {
-        signal(SIGINT, handle_sigint);
-        signal(SIGTERM, handle_sigint);
+    /* 버스 구간만 write (등록 버퍼 안의 주소라 WRITE_FIXED 그대로 사용) */
+    static ssize_t tx_write(struct spi_bus *b, unsigned slot) {
+        const uint8_t *p = ring.frame[slot] + b->first * SPI_BYTES_PER_LED;
+        unsigned len = b->count * SPI_BYTES_PER_LED;
 
-        int spi_fd = open(SPI_DEV, O_WRONLY);
-        if (spi_fd < 0) {
-            perror("open spi device");
-            return 1;
+        if (uring_available(&b->u)) {
+            int ret;
+            uring_queue_write(&b->u, 0, slot, p, len, 0);
+            ret = uring_submit_wait(&b->u);
+            if (ret == 0)
+                return len;
+            if (ret != -EINVAL && ret != -EOPNOTSUPP) {
+                errno = -ret;
+                return -1;
+            }
+            /* spidev 에 write_iter 가 없는 커널: 이후로는 write() */
+            fprintf(stderr, "[ambient_daemon] %s: io_uring SPI write unsupported, using write()\n", b->path);
+            uring_exit(&b->u);
         }
+        return write(b->fd, p, len);
+    }
+
+    static void bus_send(struct spi_bus *b, unsigned slot) {
+        uint64_t t0 = now_ns();
+
+        if (tx_write(b, slot) != b->count * SPI_BYTES_PER_LED) {
+            atomic_fetch_add_explicit(&b->errors, 1, memory_order_relaxed);
+            perror(b->path);
+        }
+        b->last_ns = now_ns() - t0;
+        atomic_fetch_add_explicit(&b->frames, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&b->ns, b->last_ns, memory_order_relaxed);
+        stat_max(&b->ns_max, b->last_ns);
+    }
 
-        uint32_t speed = 25000000;
-        if (ioctl(spi_fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed) < 0) {
-            perror("SPI: set speed failed");
+    /* 버스 worker: 배리어에서 출발 신호를 기다렸다가 자기 구간 전송 */
+    static void *bus_thread_fn(void *arg) {
+        struct spi_bus *b = arg;
+
+        for (;;) {
+            pthread_barrier_wait(&frame_start);
+            if (!running)
+                break;
+            bus_send(b, tx_slot);
+            pthread_barrier_wait(&frame_done);
         }
+        return NULL;
+    }
+
+    /* transmit 스레드(coordinator): 프레임이 오면 버스들에 나눠 blocking write */
+    static void *tx_thread_fn(void *arg) {
+        int uring_ok = 0;
 
-        printf("[ambient_daemon] Started. Reading from /dev/ambient_dev");
+        for (int i = 0; i < nbus; i++)
+            uring_ok += tx_uring_setup(&buses[i].u, buses[i].fd) == 0;
+        if (uring_ok)
+            printf("[ambient_daemon] SPI transmit via io_uring (registered fd/buffers) on %d/%d bus(es)\n",
+                   uring_ok, nbus);
+
+        if (nbus > 1) {
+            pthread_barrier_init(&frame_start, NULL, nbus + 1);
+            pthread_barrier_init(&frame_done, NULL, nbus + 1);
+            for (int i = 0; i < nbus; i++)
+                pthread_create(&buses[i].thread, NULL, bus_thread_fn, &buses[i]);
+        }
 
         while (running) {
-            int dev_fd = open(AMBIENT_DEV, O_RDONLY);
-            if (dev_fd < 0) {
-                perror("open ambient device");
+            if (sem_wait(&ring.ready) < 0) {
+                if (errno == EINTR)
+                    continue;
                 break;
             }
+            if (!ring_take(&ring))
+                continue;
 
-            char mode_buf[16] = "off";
-            int brightness = 0;
+            uint64_t t0 = now_ns();
+            if (nbus == 1) {
+                bus_send(&buses[0], ring.cons_slot);
+            } else {
+                uint64_t lo = UINT64_MAX, hi = 0;
 
-            ioctl(dev_fd, AMBIENT_GET_MODE, mode_buf);
-            ioctl(dev_fd, AMBIENT_GET_BRIGHTNESS, &brightness);
-            close(dev_fd);
+                tx_slot = ring.cons_slot;
+                pthread_barrier_wait(&frame_start);
+                pthread_barrier_wait(&frame_done);
+                for (int i = 0; i < nbus; i++) {
+                    if (buses[i].last_ns < lo) lo = buses[i].last_ns;
+                    if (buses[i].last_ns > hi) hi = buses[i].last_ns;
+                }
+                atomic_fetch_add_explicit(&skew_ns, hi - lo, memory_order_relaxed);
+                stat_max(&skew_ns_max, hi - lo);
+            }
+            uint64_t t1 = now_ns(), dt = t1 - t0;
+            atomic_fetch_add_explicit(&ring.tx_ns, dt, memory_order_relaxed);
+            stat_max(&ring.tx_ns_max, dt);
+
+            if (ring.origin_ns[ring.cons_slot]) {
+                uint64_t lat = t1 - ring.origin_ns[ring.cons_slot];
+                atomic_fetch_add_explicit(&ring.stream_sent, 1, memory_order_relaxed);
+                atomic_fetch_add_explicit(&ring.stream_lat_ns, lat, memory_order_relaxed);
+                stat_max(&ring.stream_lat_max, lat);
+                atomic_store_explicit(&ring.stream_lat_last, lat, memory_order_relaxed);
+                atomic_store_explicit(&ring.stream_shown_seq, ring.origin_seq[ring.cons_slot],
+                                      memory_order_relaxed);
+            }
+            atomic_fetch_add_explicit(&ring.sent, 1, memory_order_relaxed);
+        }
+
+        if (nbus > 1) {
+            /* running == 0 상태로 한 번 더 출발시켜 worker 종료 */
+            pthread_barrier_wait(&frame_start);
+            for (int i = 0; i < nbus; i++)
+                pthread_join(buses[i].thread, NULL);
+            pthread_barrier_destroy(&frame_start);
+            pthread_barrier_destroy(&frame_done);
+        }
+        for (int i = 0; i < nbus; i++)
+            uring_exit(&buses[i].u);
+        return arg;
+    }
+
+    /* "--spi dev[:leds]" 목록 → 버스별 LED 구간. 개수를 안 준 버스는 남은 LED 를 균등 분배 */
+    static int add_bus(const char *arg) {
+        static char paths[MAX_SPI_BUSES][64];
+        char *colon;
+
+        if (nbus >= MAX_SPI_BUSES) {
+            fprintf(stderr, "too many SPI buses (max %d)\n", MAX_SPI_BUSES);
+            return -1;
+        }
+        snprintf(paths[nbus], sizeof(paths[nbus]), "%s", arg);
+        colon = strchr(paths[nbus], ':');
+        buses[nbus].count = 0;
+        if (colon) {
+            *colon = '\0';
+            buses[nbus].count = atoi(colon + 1);
+            if (buses[nbus].count <= 0)
+                return -1;
+        }
+        buses[nbus].path = paths[nbus];
+        buses[nbus].fd = -1;
+        nbus++;
+        return 0;
+    }
+
+    static int layout_buses(void) {
+        int fixed = 0, auto_n = 0, first = 0;
+
+        /* --spi 가 없으면 variant 의 버스 목록 */
+        for (int i = 0, n = nbus; n == 0 && i < vehicle.ambient.nspi; i++) {
+            if (add_bus(vehicle.ambient.spi[i]) < 0) {
+                fprintf(stderr, "variant %s: bad ambient.spi %s\n", vehicle.name, vehicle.ambient.spi[i]);
+                return -1;
+            }
+        }
+        for (int i = 0; i < nbus; i++) {
+            fixed += buses[i].count;
+            auto_n += buses[i].count == 0;
+        }
+        if (fixed > LED_COUNT || (!auto_n && fixed != LED_COUNT) ||
+            (auto_n && LED_COUNT - fixed < auto_n)) {
+            fprintf(stderr, "SPI bus LED counts (%d) do not add up to %d\n", fixed, LED_COUNT);
+            return -1;
+        }
+        for (int i = 0, k = 0; i < nbus; i++) {
+            if (buses[i].count == 0) {
+                int rest = LED_COUNT - fixed;
+                buses[i].count = rest * (k + 1) / auto_n - rest * k / auto_n;
+                k++;
+            }
+            buses[i].first = first;
+            first += buses[i].count;
+        }
+        return 0;
+    }
+
+    static int open_buses(void) {
+        uint32_t speed = vehicle.ambient.spi_hz;
+
+        for (int i = 0; i < nbus; i++) {
+            buses[i].fd = open(buses[i].path, O_WRONLY);
+            if (buses[i].fd < 0) {
+                perror(buses[i].path);
+                return -1;
+            }
+            if (ioctl(buses[i].fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed) < 0) {
+                perror("SPI: set speed failed");
+            }
+            printf("[ambient_daemon] %s: LED %d..%d\n", buses[i].path,
+                   buses[i].first, buses[i].first + buses[i].count - 1);
+        }
+        return 0;
+    }
+
+    static void close_buses(void) {
+        for (int i = 0; i < nbus; i++)
+            if (buses[i].fd >= 0)
+                close(buses[i].fd);
+    }
+
+    static void ts_add(struct timespec *ts, long ns) {
+        ts->tv_nsec += ns;
+        while (ts->tv_nsec >= 1000000000L) {
+            ts->tv_sec++;
+            ts->tv_nsec -= 1000000000L;
+        }
+    }
+
+    static uint64_t ts_ns(const struct timespec *ts) {
+        return (uint64_t)ts->tv_sec * 1000000000ull + ts->tv_nsec;
+    }
+
+    /* 새 stream 프레임을 가져와 stream_cur 갱신. 연결이 바뀌거나 끊기면 stream_cur 무효화 */
+    static int stream_poll(void) {
+        const struct ambient_stream_shm *shm = stream.shm;
+        uint64_t lost;
+
+        ambient_stream_service(&stream);
+        if (stream.shm != shm) {
+            stream_cur = NULL;
+            stream_conn_base = stream_lost + stream_ring_dropped;
+        }
+
+        const struct ambient_stream_slot *sf = ambient_stream_take(&stream, &lost);
+        if (!sf)
+            return 0;
+        stream_cur = sf;
+        stream_frames++;
+        stream_lost += lost;
+        return 1;
+    }
+
+    /* 채운 prod_slot 에 stream 출처를 기록하고 공개 */
+    static void publish_frame(int with_stream) {
+        unsigned slot = ring.prod_slot;
+
+        ring.origin_ns[slot] = with_stream && stream_cur ? stream_cur->t_publish_ns : 0;
+        ring.origin_seq[slot] = with_stream && stream_cur ? stream_cur->seq : 0;
+        if (ring_publish(&ring) && ring.origin_ns[ring.prod_slot])
+            stream_ring_dropped++;   /* 덮어쓴 프레임이 stream 프레임 */
+    }
+
+    /*
+     * scene crossfade: APPLY_SCENE 으로 scene_seq 가 바뀌면 이전 화면(from)에서 새 상태(to)로
+     * 섞는다. 시작할 때 ease 가중치 표(step 수만큼)와 LED 채널별 차이(to - from)를 한 번
+     * 계산해 두고, 프레임마다 from + delta * w[k] >> 8 한 줄 뒤 출력 단계로 인코딩한다.
+     * to 에 움직이는 segment(rainbow/music/stream)가 있으면 to/delta 만 프레임마다 다시.
+     * 밝기는 from/to 에 미리 곱하고 출력 단계는 100% 로 — 끝나면 평소 경로로 전부 다시 그림.
+     */
+    #define XFADE_FPS        60
+    #define XFADE_MAX_MS     10000   /* ambient_driver.c AMBIENT_MAX_TRANSITION_MS */
+    #define XFADE_MAX_STEPS  (XFADE_MAX_MS * DITHER_FPS / 1000)
+
+    static struct {
+        int      steps, k;                    /* k = 다음 step (1..steps), steps 0 = 꺼짐 */
+        int      live;                        /* to 를 프레임마다 다시 그림 */
+        uint16_t w[XFADE_MAX_STEPS + 1];      /* step → 가중치 0~256 (smoothstep) */
+        uint8_t  from[LED_MAX * 3], to[LED_MAX * 3], mix[LED_MAX * 3];
+        int16_t  delta[LED_MAX * 3];
+        unsigned long fades, frames;
+    } xf;
+
+    /* stream 프레임 [lo, hi) → 밝기 곱한 GRB, 프레임 밖은 소등 */
+    static void stream_to_grb(uint8_t *grb, int lo, int hi, int brightness) {
+        const struct ambient_stream_slot *sf = stream_cur;
+        int n = stream_leds(sf);
+
+        for (int i = lo; i < hi; i++, grb += 3) {
+            if (i >= n) {
+                grb[0] = grb[1] = grb[2] = 0;
+                continue;
+            }
+            grb[0] = sf->rgb[i * 3 + 1] * brightness / 100;
+            grb[1] = sf->rgb[i * 3 + 0] * brightness / 100;
+            grb[2] = sf->rgb[i * 3 + 2] * brightness / 100;
+        }
+    }
+
+    /* 상태 전체를 밝기까지 곱한 GRB 로. 존끼리 겹치지 않으므로 배경 위에 존을 덮어 그림 */
+    static int render_full(const struct ambient_zones *st, uint8_t *grb) {
+        int live = 0;
+
+        for (int s = 0; s < NSEG; s++) {
+            const struct ambient_zone *z = s ? &st->zone[s - 1] : &st->bg;
+            int lo = s ? z->first : 0, hi = s ? z->first + z->count : LED_COUNT;
+
+            if (hi > LED_COUNT)
+                hi = LED_COUNT;
+            if (lo >= hi)
+                continue;
+            if (is_stream(z))
+                stream_to_grb(grb + lo * 3, lo, hi, z->brightness);
+            else
+                render_look(grb + lo * 3, lo, hi, s, z, z->brightness);
+            live |= is_animated(z) || is_stream(z);
+        }
+        return live;
+    }
+
+    static void xfade_target(const struct ambient_zones *to) {
+        xf.live = render_full(to, xf.to);
+        for (int i = 0; i < LED_COUNT * 3; i++)
+            xf.delta[i] = xf.to[i] - xf.from[i];
+    }
+
+    static void xfade_start(const struct ambient_zones *from, const struct ambient_zones *to,
+                            unsigned ms, int fps) {
+        int steps = ms * fps / 1000;
+
+        if (steps < 1)
+            steps = 1;
+        if (steps > XFADE_MAX_STEPS)
+            steps = XFADE_MAX_STEPS;
+        /* 진행 중에 또 바뀌면 지금 보이는 혼합 화면에서 이어서 */
+        if (xf.steps)
+            memcpy(xf.from, xf.mix, LED_COUNT * 3);
+        else
+            render_full(from, xf.from);
+        for (int k = 0; k <= steps; k++) {
+            float t = (float)k / steps;
+            xf.w[k] = (uint16_t)(256.0f * t * t * (3.0f - 2.0f * t) + 0.5f);
+        }
+        xfade_target(to);
+        xf.steps = steps;
+        xf.k = 1;
+        xf.fades++;
+    }
+
+    /* 한 step 을 prod_slot 에 인코딩해 공개. 마지막 step 이면 끔 */
+    static void xfade_frame(const struct ambient_zones *to) {
+        if (xf.live)
+            xfade_target(to);
+        color_blend(xf.mix, xf.from, xf.delta, LED_COUNT * 3, xf.w[xf.k]);
+        color_out_encode(&out, ring.frame[ring.prod_slot], xf.mix, LED_COUNT,
+                         color_out_scale(&out, 100), dither_acc);
+        publish_frame(0);
+        xf.frames++;
+        if (++xf.k > xf.steps)
+            xf.steps = 0;
+    }
+
+    /*
+     * parking/suspended: 스트립을 끈 프레임을 내보내고 (parking 이면 ack) active 까지 잠듦.
+     * 드라이버 상태(모드/존)는 그대로라 깨어난 뒤 전부 다시 그리면 복원된다.
+     */
+    static void park_strip(void) {
+        unsigned long sent = atomic_load_explicit(&ring.sent, memory_order_relaxed);
+
+        memset(grb_tmp, 0, sizeof(grb_tmp));
+        color_out_encode(&out, ring.frame[ring.prod_slot], grb_tmp, LED_COUNT, 0, NULL);
+        publish_frame(0);
+        for (int i = 0; i < PARK_TX_WAIT_MS && running &&
+             atomic_load_explicit(&ring.sent, memory_order_relaxed) == sent; i++)
+            usleep(1000);
+
+        printf("\n[ambient_daemon] parked (%s)", park_name(park.state));
+        fflush(stdout);
+        if (park.state == PARK_PARKING)
+            park_ack(&park);
+        while (running && park.state != PARK_ACTIVE)
+            park_wait(&park, PARK_WAIT_MS);
+        if (running)
+            printf("\n[ambient_daemon] resumed");
+    }
+
+    /* render 스레드: 상태 조회 → dirty segment 인코딩 → 링에 공개 */
+    static void render_loop(int dev_fd) {
+        struct ambient_zones cur, prev;
+        struct ambient_state sc;
+        unsigned scene_seq = 0;
+        int first_frame = 1, spi_stale = 0;
+        struct timespec next;
+
+        clock_gettime(CLOCK_MONOTONIC, &next);
+
+        while (running) {
+            if (park.state != PARK_ACTIVE) {
+                park_strip();
+                /* spi_data 와 스트립이 어긋났으니 전부 다시 그리고 tick 재정렬 */
+                first_frame = 1;
+                xf.steps = 0;
+                memset(dither_acc, 0, sizeof(dither_acc));
+                clock_gettime(CLOCK_MONOTONIC, &next);
+                continue;
+            }
+
+            uint64_t t0 = now_ns();
+
+            fetch_state(dev_fd, &cur, &sc);
+            int stream_new = stream_poll();
+
+            /* APPLY_SCENE: 이전 화면이 있고 transition 이 있으면 crossfade, 아니면 아래에서 바로 */
+            if (sc.scene_seq != scene_seq) {
+                if (!first_frame && sc.transition_ms)
+                    xfade_start(&prev, &cur, sc.transition_ms, out.dither ? DITHER_FPS : XFADE_FPS);
+                scene_seq = sc.scene_seq;
+            }
+
+            /* 존 구간이 바뀌거나 spi_data 를 건너뛰었으면 전부 다시 그림 */
+            int all_dirty = first_frame || spi_stale || !same_geometry(&cur, &prev);
+            if (all_dirty)
+                build_owner_map(&cur);
 
-            if (brightness < 0) brightness = 0;
-            if (brightness > 100) brightness = 100;
-
-            uint8_t grb_data[LED_COUNT * 3];
-            if (strcmp(mode_buf, "rainbow") == 0) {
-                for (int i = 0; i < LED_COUNT; i++) {
-                    uint8_t rr, gg, bb;
-                    hue_to_grb(hue + i * 10, &gg, &rr, &bb);
-                    grb_data[i*3 + 0] = (gg * brightness) / 100;
-                    grb_data[i*3 + 1] = (rr * brightness) / 100;
-                    grb_data[i*3 + 2] = (bb * brightness) / 100;
+            int dirty = 0, animated = 0, music = 0, streaming = 0, zones_active = 0, fading = 0;
+
+            /* 오디오 쪽은 기다리지 않고 최신 레벨만 가져옴 */
+            audio_get_levels(band_level);
+            for (int z = 0; z < AMBIENT_MAX_ZONES; z++)
+                zones_active |= cur.zone[z].count != 0;
+
+            if (xf.steps) {
+                xfade_frame(&cur);
+                if (xf.live)
+                    hue += 3;
+                fading = 1;
+                spi_stale = 1;      /* 끝나면 spi_data 를 전부 다시 그림 */
+                goto frame_done;
+            }
+
+            if (is_stream(&cur.bg) && !zones_active) {
+                /* 스트립 전체가 외부 프레임: 공유 메모리 → 전송 슬롯으로 바로 인코딩 */
+                streaming = 1;
+                if (stream_new || all_dirty || out.dither || !same_look(&cur.bg, &prev.bg)) {
+                    render_stream(ring.frame[ring.prod_slot], 0, LED_COUNT, -1, cur.bg.brightness);
+                    publish_frame(1);
+                    spi_stale = 1;
+                }
+                goto frame_done;
+            }
+            spi_stale = 0;
+
+            for (int s = 0; s < NSEG; s++) {
+                const struct ambient_zone *z = s ? &cur.zone[s - 1] : &cur.bg;
+                const struct ambient_zone *pz = s ? &prev.zone[s - 1] : &prev.bg;
+
+                if (s > 0 && z->count == 0)
+                    continue;
+                if (is_animated(z))
+                    animated = 1;
+                if (is_music(z))
+                    music = 1;
+                if (is_stream(z)) {
+                    streaming = 1;
+                    if (stream_new) {
+                        render_segment(s, z);
+                        dirty = 1;
+                        continue;
+                    }
                 }
+                /* 정적인 존은 바뀌지 않았으면 건드리지 않음 (dither 중에는 매 프레임 다시 양자화) */
+                if (!all_dirty && !out.dither && !is_animated(z) && same_look(z, pz))
+                    continue;
+
+                render_segment(s, z);
+                dirty = 1;
+            }
+            if (animated)
                 hue += 3;
-            } else {
-                uint8_t rr, gg, bb;
-                map_color(mode_buf, &rr, &gg, &bb);
-                uint8_t br = (rr * brightness) / 100;
-                uint8_t bg = (gg * brightness) / 100;
-                uint8_t bb2 = (bb * brightness) / 100;
-                for (int i = 0; i < LED_COUNT; i++) {
-                    grb_data[i*3 + 0] = bg;
-                    grb_data[i*3 + 1] = br;
-                    grb_data[i*3 + 2] = bb2;
+
+            /* WS281x 는 마지막 프레임을 유지하므로 변경이 없으면 전송도 생략 */
+            if (dirty) {
+                memcpy(ring.frame[ring.prod_slot], spi_data, SPI_FRAME_BYTES);
+                publish_frame(streaming && stream_new);
+            }
+
+        frame_done:;
+            uint64_t dt = now_ns() - t0;
+            atomic_fetch_add_explicit(&ring.render_ns, dt, memory_order_relaxed);
+            stat_max(&ring.render_ns_max, dt);
+            atomic_fetch_add_explicit(&ring.rendered, 1, memory_order_relaxed);
+
+            /* producer 피드백 */
+            if (stream.shm) {
+                atomic_store_explicit(&stream.shm->shown_seq,
+                                      atomic_load_explicit(&ring.stream_shown_seq, memory_order_relaxed),
+                                      memory_order_relaxed);
+                atomic_store_explicit(&stream.shm->latency_ns,
+                                      atomic_load_explicit(&ring.stream_lat_last, memory_order_relaxed),
+                                      memory_order_relaxed);
+                atomic_store_explicit(&stream.shm->dropped,
+                                      stream_lost + stream_ring_dropped - stream_conn_base,
+                                      memory_order_relaxed);
+            }
+
+            prev = cur;
+            first_frame = 0;
+
+            long period = 1000000000L / (out.dither ? DITHER_FPS : fading ? XFADE_FPS :
+                                         music ? MUSIC_FPS : FPS);
+            if ((streaming && stream.shm) || park.fd >= 0) {
+                /* 주기 tick, doorbell, park 상태 변화 중 먼저 오는 쪽에 깨어남 */
+                struct pollfd pfd[2];
+                int npfd = 0;
+                uint64_t now = now_ns();
+                struct timespec rel = { 0, 0 };
+
+                if (park.fd >= 0)
+                    pfd[npfd++] = (struct pollfd){ .fd = park.fd, .events = POLLPRI };
+                if (streaming && stream.shm) {
+                    pfd[npfd++] = (struct pollfd){ .fd = stream.efd, .events = POLLIN };
+                    if (now >= ts_ns(&next))
+                        ts_add(&next, period);
+                } else {
+                    ts_add(&next, period);
                 }
+                if (ts_ns(&next) > now) {
+                    rel.tv_sec = (ts_ns(&next) - now) / 1000000000ull;
+                    rel.tv_nsec = (ts_ns(&next) - now) % 1000000000ull;
+                }
+                if (ppoll(pfd, npfd, &rel, NULL) > 0 && park.fd >= 0 && (pfd[0].revents & POLLPRI))
+                    park_state(&park);
+            } else {
+                /* 고정 주기 (render 시간과 무관) */
+                ts_add(&next, period);
+                clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
             }
+        }
+    }
+
+    static void usage(const char *progname) {
+        printf("Usage: %s [--gamma <g>] [--calib <r,g,b>] [--dither]\n", progname);
+        printf("       출력 단계: gamma, 채널별 gain(0~1, 스트립 배치 보정), %d fps temporal dither\n", DITHER_FPS);
+        printf("       %s --bench [leds]   색 파이프라인 bit-exact 검사 + 속도 비교\n", progname);
+        printf("       %s --audio <hw:0|file.wav|fifo>   music 모드 오디오 입력\n", progname);
+        printf("       %s --audio-bench    fixed-point FFT 정확도/속도\n", progname);
+        printf("       %s --spi <dev>[:leds] ...   스트립을 여러 SPI 버스로 나눠 병렬 전송 (최대 %d, 기본 variant 의 ambient.spi)\n",
+               progname, MAX_SPI_BUSES);
+        rt_usage(stdout);
+        vehicle_usage(stdout);
+    }
 
-            uint8_t spi_data[LED_COUNT * 24 * 3] = {0};
-            encode_leds(grb_data, spi_data, LED_COUNT);
-            ssize_t ret = write(spi_fd, spi_data, sizeof(spi_data));
-            if (ret != sizeof(spi_data)) {
-                perror("spi write failed");
+    int main(int argc, char *argv[]) {
+        const char *audio_src = NULL;
+        float gamma = 1.0f, gain[3] = { 1.0f, 1.0f, 1.0f };
+        int dither = 0;
+        struct rt_profile rt;
+        rt_profile_init(&rt);
+        if (vehicle_setup(&argc, argv) < 0 || rt_parse_args(&rt, &argc, argv) < 0) {
+            usage(argv[0]);
+            return 1;
+        }
+
+        for (int i = 1; i < argc; i++) {
+            if (strcmp(argv[i], "--bench") == 0) {
+                int leds = (i + 1 < argc) ? atoi(argv[i + 1]) : 1024;
+                if (color_selftest() != 0)
+                    return 1;
+                color_bench(leds > 0 ? leds : 1024);
+                return 0;
+            } else if (strcmp(argv[i], "--audio-bench") == 0) {
+                return audio_bench() == 0 ? 0 : 1;
+            } else if (strcmp(argv[i], "--audio") == 0 && i + 1 < argc) {
+                audio_src = argv[++i];
+            } else if (strcmp(argv[i], "--spi") == 0 && i + 1 < argc) {
+                if (add_bus(argv[++i]) < 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+            } else if (strcmp(argv[i], "--gamma") == 0 && i + 1 < argc) {
+                gamma = atof(argv[++i]);
+                out_bright = 1;
+            } else if (strcmp(argv[i], "--calib") == 0 && i + 1 < argc) {
+                if (sscanf(argv[++i], "%f,%f,%f", &gain[0], &gain[1], &gain[2]) != 3) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                out_bright = 1;
+            } else if (strcmp(argv[i], "--dither") == 0) {
+                dither = 1;
+                out_bright = 1;
+            } else {
+                usage(argv[0]);
+                return 1;
             }
+        }
+
+        /* LUT 는 여기서 한 번만 만듦. 옵션이 없으면 항등 */
+        color_out_init(&out, gamma, gain, dither);
+
+        signal(SIGINT, handle_sigint);
+        signal(SIGTERM, handle_sigint);
+
+        if (layout_buses() < 0 || open_buses() < 0) {
+            close_buses();
+            return 1;
+        }
+
+        int dev_fd = open(AMBIENT_DEV, O_RDONLY);
+        if (dev_fd < 0) {
+            perror("open ambient device");
+            close_buses();
+            return 1;
+        }
+
+        /* 구 드라이버(park/ 없음)면 fd -1, 항상 active */
+        park_open(&park, "ambient_dev");
+
+        /* 외부 프레임 producer 접속 대기 (실패해도 stream 모드만 빈 화면) */
+        if (ambient_stream_listen(&stream, LED_COUNT) < 0)
+            fprintf(stderr, "[ambient_daemon] stream input disabled\n");
 
-            usleep(1000000 / FPS);
+        ring_init(&ring);
+
+        /* tx 스레드가 affinity/정책/mlock 을 물려받도록 생성 전에 적용 */
+        rt_apply(&rt, "ambient_daemon");
+        rt_selftest(&rt, "ambient_daemon");
+
+        /* capture → analysis → render(이 스레드) → tx: 단계마다 스레드, 사이는 잠금 없는 최신값 전달 */
+        if (audio_src && audio_start(audio_src) < 0) {
+            close(dev_fd);
+            close_buses();
+            return 1;
+        }
+
+        pthread_t tx_thread;
+        if (pthread_create(&tx_thread, NULL, tx_thread_fn, NULL) != 0) {
+            perror("pthread_create");
+            close(dev_fd);
+            close_buses();
+            return 1;
+        }
+
+        printf("[ambient_daemon] Started (%s, %d LEDs). Reading from /dev/ambient_dev", vehicle.name, LED_COUNT);
+
+        render_loop(dev_fd);
+
+        sem_post(&ring.ready);  /* transmit 스레드 깨워서 종료 */
+        pthread_join(tx_thread, NULL);
+        audio_stop();
+
+        unsigned long rendered = atomic_load(&ring.rendered);
+        unsigned long sent = atomic_load(&ring.sent);
+        printf("\n[ambient_daemon] frames: rendered %lu, produced %lu, sent %lu, dropped %lu\n",
+               rendered, atomic_load(&ring.produced), sent, atomic_load(&ring.dropped));
+        if (rendered && sent)
+            printf("[ambient_daemon] render avg %.1f / max %.1f us, spi frame avg %.1f / max %.1f us\n",
+                   atomic_load(&ring.render_ns) / 1e3 / rendered,
+                   atomic_load(&ring.render_ns_max) / 1e3,
+                   atomic_load(&ring.tx_ns) / 1e3 / sent,
+                   atomic_load(&ring.tx_ns_max) / 1e3);
+        for (int i = 0; i < nbus; i++) {
+            unsigned long bf = atomic_load(&buses[i].frames);
+            if (bf)
+                printf("[ambient_daemon]   bus %s (%d LEDs): avg %.1f / max %.1f us, errors %lu\n",
+                       buses[i].path, buses[i].count, atomic_load(&buses[i].ns) / 1e3 / bf,
+                       atomic_load(&buses[i].ns_max) / 1e3, atomic_load(&buses[i].errors));
+        }
+        if (nbus > 1 && sent)
+            printf("[ambient_daemon]   bus skew (slowest - fastest): avg %.1f / max %.1f us\n",
+                   atomic_load(&skew_ns) / 1e3 / sent, atomic_load(&skew_ns_max) / 1e3);
+        audio_print_stats();
+        if (xf.fades)
+            printf("[ambient_daemon] scene crossfades %lu (%lu frames)\n", xf.fades, xf.frames);
+        if (stream_frames) {
+            unsigned long ss = atomic_load(&ring.stream_sent);
+            printf("[ambient_daemon] stream: frames %lu, lost %lu (producer overwrote), dropped %lu (ring), sent %lu\n",
+                   stream_frames, stream_lost, stream_ring_dropped, ss);
+            if (ss)
+                printf("[ambient_daemon] stream latency publish->spi done: avg %.1f us, max %.1f us\n",
+                       atomic_load(&ring.stream_lat_ns) / 1e3 / ss,
+                       atomic_load(&ring.stream_lat_max) / 1e3);
         }
+        ambient_stream_shutdown(&stream);
 
-        close(spi_fd);
+        park_close(&park);
+        close(dev_fd);
+        close_buses();
         printf("[ambient_daemon] Terminated.");
         return 0;
     }
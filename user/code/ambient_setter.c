@@ -0,0 +1,331 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <ctype.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <linux/types.h>
+#include "ambient_stream.h"
+#include "vehicle.h"
+
+#define DEVICE_PATH "/dev/ambient_dev"
+
+#define AMBIENT_MAGIC 'L'
+#define AMBIENT_SET_MODE        _IOW(AMBIENT_MAGIC, 1, char *)
+#define AMBIENT_SET_BRIGHTNESS  _IOW(AMBIENT_MAGIC, 3, int)
+
+#define AMBIENT_MAX_ZONES  8
+
+struct ambient_zone {
+    __u16 first;
+    __u16 count;
+    __s32 brightness;
+    char  mode[16];
+};
+
+struct ambient_zone_arg {
+    __u32               id;
+    struct ambient_zone zone;
+};
+
+#define AMBIENT_SET_ZONE        _IOW(AMBIENT_MAGIC, 5, struct ambient_zone_arg)
+#define AMBIENT_GET_ZONE        _IOWR(AMBIENT_MAGIC, 6, struct ambient_zone_arg)
+
+/* scene (ambient_driver.c 와 동일) */
+#define AMBIENT_MAX_SCENES 8
+
+struct ambient_scene {
+    __u32               transition_ms;
+    struct ambient_zone bg;
+    struct ambient_zone zone[AMBIENT_MAX_ZONES];
+};
+
+struct ambient_scene_arg {
+    __u32                id;
+    struct ambient_scene scene;
+};
+
+#define AMBIENT_SET_SCENE       _IOW(AMBIENT_MAGIC, 8, struct ambient_scene_arg)
+#define AMBIENT_GET_SCENE       _IOWR(AMBIENT_MAGIC, 9, struct ambient_scene_arg)
+#define AMBIENT_APPLY_SCENE     _IOW(AMBIENT_MAGIC, 10, __u32)
+
+#define SCENE_MAX_ARGS (4 + AMBIENT_MAX_ZONES)
+
+void usage(const char *progname) {
+    printf("Usage: %s color <red|green|blue|yellow|cyan|magenta|white|rainbow|music|stream|off>\n", progname);
+    printf("       %s brightness <0-100>\n", progname);
+    printf("       %s zone <id|name> <first> <count> <color> <brightness>\n", progname);
+    printf("       %s zone <name> <color> <brightness>   variant 의 LED 구간 그대로\n", progname);
+    printf("       %s zone <id|name> off\n", progname);
+    printf("       %s zone <id|name>\n", progname);
+    printf("       %s stream-test [fps] [seconds]   stream 모드 시험용 프레임 producer\n", progname);
+    printf("       %s scene <id>                     올려 둔 scene 으로 한 번에 전환 (데몬이 crossfade)\n", progname);
+    printf("       %s scene-set <id> <transition_ms> <bg_color> <bg_brightness> [<zone>=<color>:<brightness> ...]\n", progname);
+    printf("       %s scene-load <file>              줄마다 scene-set 인자 (# 주석)\n", progname);
+    printf("       %s scene-get <id>\n", progname);
+    printf("  존 이름 (%s):", vehicle.name);
+    for (int i = 0; i < vehicle.ambient.nzone; i++)
+        printf(" %s=%d(LED %u..%u)", vehicle.ambient.zone[i].name, i, vehicle.ambient.zone[i].first,
+               vehicle.ambient.zone[i].first + vehicle.ambient.zone[i].count - 1);
+    printf("\n");
+    vehicle_usage(stdout);
+}
+
+/* 흐르는 그라데이션을 공유 메모리 slot 에 제자리로 그려 publish */
+static int stream_test(int fps, int secs) {
+    struct ambient_stream st;
+    struct timespec next;
+    int frames = fps * secs;
+
+    if (ambient_stream_connect(&st) < 0)
+        return 1;
+    /* slot->rgb 는 AMBIENT_STREAM_MAX_LEDS 개: daemon 이 알려 준 값도 그 안으로 */
+    unsigned leds = st.shm->strip_leds;
+    if (leds > st.shm->max_leds)
+        leds = st.shm->max_leds;
+    if (leds > AMBIENT_STREAM_MAX_LEDS)
+        leds = AMBIENT_STREAM_MAX_LEDS;
+    printf("stream: %u LEDs, %d fps, %d s\n", leds, fps, secs);
+
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    for (int f = 0; f < frames; f++) {
+        struct ambient_stream_slot *slot = ambient_stream_begin(&st);
+
+        for (unsigned i = 0; i < leds; i++) {
+            uint8_t v = (uint8_t)(i * 256 / leds + f * 4);
+            slot->rgb[i * 3 + 0] = v;
+            slot->rgb[i * 3 + 1] = 255 - v;
+            slot->rgb[i * 3 + 2] = v / 2;
+        }
+        if (ambient_stream_publish(&st, leds) < 0) {
+            perror("stream publish");
+            break;
+        }
+        next.tv_nsec += 1000000000L / fps;
+        while (next.tv_nsec >= 1000000000L) {
+            next.tv_sec++;
+            next.tv_nsec -= 1000000000L;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+    }
+    usleep(100000);
+    printf("stream: published %d, shown up to #%lu, dropped %lu, last latency %.1f us\n", frames,
+           (unsigned long)atomic_load(&st.shm->shown_seq), (unsigned long)atomic_load(&st.shm->dropped),
+           atomic_load(&st.shm->latency_ns) / 1e3);
+    ambient_stream_close(&st);
+    return 0;
+}
+
+/* 존 이름 (variant 의 ambient.zone) 또는 번호 */
+static int parse_zone_id(const char *s) {
+    int id = vehicle_zone_id(s);
+    return id >= 0 ? id : atoi(s);
+}
+
+/*
+ * scene-set 인자 → scene. 존은 variant 의 존 이름/번호로 고르고 LED 구간도 variant 에서.
+ *   <id> <transition_ms> <bg_color> <bg_brightness> [<zone>=<color>:<brightness> ...]
+ */
+static int parse_scene(int argc, char **argv, struct ambient_scene_arg *sa) {
+    memset(sa, 0, sizeof(*sa));
+    if (argc < 4 || argc > SCENE_MAX_ARGS) {
+        fprintf(stderr, "scene: <id> <transition_ms> <bg_color> <bg_brightness> [<zone>=<color>:<brightness> ...]\n");
+        return -1;
+    }
+    sa->id = atoi(argv[0]);
+    sa->scene.transition_ms = atoi(argv[1]);
+    strncpy(sa->scene.bg.mode, argv[2], sizeof(sa->scene.bg.mode) - 1);
+    sa->scene.bg.brightness = atoi(argv[3]);
+
+    for (int i = 4; i < argc; i++) {
+        char name[16], mode[16];
+        int brightness, id;
+
+        if (sscanf(argv[i], "%15[^=]=%15[^:]:%d", name, mode, &brightness) != 3) {
+            fprintf(stderr, "bad zone '%s' (<zone>=<color>:<brightness>)\n", argv[i]);
+            return -1;
+        }
+        id = vehicle_zone_id(name);
+        if (id < 0 && isdigit((unsigned char)name[0]))
+            id = atoi(name);
+        if (id < 0 || id >= vehicle.ambient.nzone) {
+            fprintf(stderr, "zone '%s' is not in variant %s\n", name, vehicle.name);
+            return -1;
+        }
+        sa->scene.zone[id].first = vehicle.ambient.zone[id].first;
+        sa->scene.zone[id].count = vehicle.ambient.zone[id].count;
+        strcpy(sa->scene.zone[id].mode, mode);
+        sa->scene.zone[id].brightness = brightness;
+    }
+    return 0;
+}
+
+static int scene_upload(int fd, int argc, char **argv) {
+    struct ambient_scene_arg sa;
+
+    if (parse_scene(argc, argv, &sa) < 0)
+        return -1;
+    if (ioctl(fd, AMBIENT_SET_SCENE, &sa) < 0) {
+        fprintf(stderr, "scene %u: %s\n", sa.id, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+/* 부팅 때 한 번: 파일의 scene 을 전부 올림 */
+static int scene_load(int fd, const char *path) {
+    FILE *fp = fopen(path, "r");
+    char line[256];
+    int lineno = 0, n = 0;
+
+    if (!fp) {
+        perror(path);
+        return -1;
+    }
+    while (fgets(line, sizeof(line), fp)) {
+        char *args[SCENE_MAX_ARGS + 1], *tok, *save;
+        int nargs = 0;
+
+        lineno++;
+        line[strcspn(line, "#\r\n")] = '\0';
+        for (tok = strtok_r(line, " \t", &save); tok && nargs <= SCENE_MAX_ARGS;
+             tok = strtok_r(NULL, " \t", &save))
+            args[nargs++] = tok;
+        if (nargs == 0)
+            continue;
+        if (scene_upload(fd, nargs, args) < 0) {
+            fprintf(stderr, "%s:%d: scene not loaded\n", path, lineno);
+            fclose(fp);
+            return -1;
+        }
+        n++;
+    }
+    fclose(fp);
+    printf("%d scene(s) loaded from %s.\n", n, path);
+    return 0;
+}
+
+static void print_zone(const char *name, const struct ambient_zone *z) {
+    printf("  %-9s LED %u..%u %s %d%%\n", name, z->first, z->first + z->count - 1,
+           z->mode, z->brightness);
+}
+
+int main(int argc, char *argv[]) {
+    int fd, ret = 0;
+
+    if (vehicle_setup(&argc, argv) < 0)
+        return 1;
+    if (argc >= 2 && strcmp(argv[1], "stream-test") == 0) {
+        int fps = argc > 2 ? atoi(argv[2]) : 60;
+        int secs = argc > 3 ? atoi(argv[3]) : 5;
+        return stream_test(fps > 0 ? fps : 60, secs > 0 ? secs : 5);
+    }
+
+    if (argc < 3) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    fd = open(DEVICE_PATH, O_RDWR);
+    if (fd < 0) {
+        perror("open " DEVICE_PATH);
+        return 1;
+    }
+
+    if (strcmp(argv[1], "color") == 0 && argc == 3) {
+        char mode[16] = {0};
+        strncpy(mode, argv[2], sizeof(mode) - 1);
+        ret = ioctl(fd, AMBIENT_SET_MODE, mode);
+        if (ret == 0)
+            printf("Ambient mode set to %s.\n", mode);
+    } else if (strcmp(argv[1], "brightness") == 0 && argc == 3) {
+        int brightness = atoi(argv[2]);
+        ret = ioctl(fd, AMBIENT_SET_BRIGHTNESS, &brightness);
+        if (ret == 0)
+            printf("Ambient brightness set to %d.\n", brightness);
+    } else if (strcmp(argv[1], "scene") == 0 && argc == 3) {
+        __u32 id = atoi(argv[2]);
+        ret = ioctl(fd, AMBIENT_APPLY_SCENE, &id);
+        if (ret == 0)
+            printf("Ambient scene %u applied.\n", id);
+    } else if (strcmp(argv[1], "scene-set") == 0) {
+        if (scene_upload(fd, argc - 2, argv + 2) < 0) {
+            close(fd);
+            return 1;
+        }
+        printf("Ambient scene %s loaded.\n", argv[2]);
+    } else if (strcmp(argv[1], "scene-load") == 0 && argc == 3) {
+        if (scene_load(fd, argv[2]) < 0) {
+            close(fd);
+            return 1;
+        }
+    } else if (strcmp(argv[1], "scene-get") == 0 && argc == 3) {
+        struct ambient_scene_arg sa = { .id = atoi(argv[2]) };
+        ret = ioctl(fd, AMBIENT_GET_SCENE, &sa);
+        if (ret == 0) {
+            printf("Scene %u: transition %u ms, background %s %d%%\n", sa.id,
+                   sa.scene.transition_ms, sa.scene.bg.mode, sa.scene.bg.brightness);
+            for (int i = 0; i < AMBIENT_MAX_ZONES; i++) {
+                char name[16];
+                if (sa.scene.zone[i].count == 0)
+                    continue;
+                if (i < vehicle.ambient.nzone)
+                    snprintf(name, sizeof(name), "%s", vehicle.ambient.zone[i].name);
+                else
+                    snprintf(name, sizeof(name), "zone %d", i);
+                print_zone(name, &sa.scene.zone[i]);
+            }
+        }
+    } else if (strcmp(argv[1], "zone") == 0) {
+        struct ambient_zone_arg za;
+
+        memset(&za, 0, sizeof(za));
+        za.id = parse_zone_id(argv[2]);
+
+        if (argc == 3) {
+            ret = ioctl(fd, AMBIENT_GET_ZONE, &za);
+            if (ret == 0)
+                printf("Zone %u: first=%u count=%u mode=%s brightness=%d\n", za.id,
+                       za.zone.first, za.zone.count, za.zone.mode, za.zone.brightness);
+        } else if (argc == 4 && strcmp(argv[3], "off") == 0) {
+            ret = ioctl(fd, AMBIENT_SET_ZONE, &za);   /* count 0 = 존 해제 */
+            if (ret == 0)
+                printf("Zone %u removed.\n", za.id);
+        } else if (argc == 7 || (argc == 5 && vehicle_zone_id(argv[2]) >= 0)) {
+            if (argc == 5) {
+                const struct veh_zone *vz = &vehicle.ambient.zone[za.id];
+                za.zone.first = vz->first;
+                za.zone.count = vz->count;
+            } else {
+                za.zone.first = atoi(argv[3]);
+                za.zone.count = atoi(argv[4]);
+            }
+            strncpy(za.zone.mode, argv[argc - 2], sizeof(za.zone.mode) - 1);
+            za.zone.brightness = atoi(argv[argc - 1]);
+            ret = ioctl(fd, AMBIENT_SET_ZONE, &za);
+            if (ret == 0)
+                printf("Zone %u set: LED %u..%u %s %d%%\n", za.id, za.zone.first,
+                       za.zone.first + za.zone.count - 1, za.zone.mode, za.zone.brightness);
+        } else {
+            usage(argv[0]);
+            close(fd);
+            return 1;
+        }
+    } else {
+        usage(argv[0]);
+        close(fd);
+        return 1;
+    }
+
+    if (ret < 0) {
+        perror("ioctl");
+        close(fd);
+        return 1;
+    }
+
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,287 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "ambient_stream.h"
+
+#define SLOT_IDX(v)  ((v) & 0xffu)
+
+static const char *sock_path(void)
+{
+    const char *p = getenv("AMBIENT_STREAM_SOCK");
+    return p && *p ? p : AMBIENT_STREAM_SOCK;
+}
+
+static uint64_t mono_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void sock_addr(struct sockaddr_un *sa)
+{
+    memset(sa, 0, sizeof(*sa));
+    sa->sun_family = AF_UNIX;
+    strncpy(sa->sun_path, sock_path(), sizeof(sa->sun_path) - 1);
+}
+
+/* ===== producer ===== */
+
+int ambient_stream_connect(struct ambient_stream *s)
+{
+    struct sockaddr_un sa;
+    char byte;
+    struct iovec iov = { .iov_base = &byte, .iov_len = 1 };
+    union {
+        char            buf[CMSG_SPACE(2 * sizeof(int))];
+        struct cmsghdr  align;
+    } ctrl;
+    struct msghdr msg = {
+        .msg_iov = &iov, .msg_iovlen = 1,
+        .msg_control = ctrl.buf, .msg_controllen = sizeof(ctrl.buf),
+    };
+    struct cmsghdr *cm;
+    int fds[2], ret;
+
+    memset(s, 0, sizeof(*s));
+    s->efd = -1;
+    s->sock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (s->sock < 0)
+        return -1;
+    sock_addr(&sa);
+    if (connect(s->sock, (struct sockaddr *)&sa, sizeof(sa)) < 0) {
+        perror(sa.sun_path);
+        goto err;
+    }
+
+    /* daemon 이 [memfd, eventfd] 를 보내 줌 */
+    do {
+        ret = recvmsg(s->sock, &msg, MSG_CMSG_CLOEXEC);
+    } while (ret < 0 && errno == EINTR);
+    cm = CMSG_FIRSTHDR(&msg);
+    if (ret <= 0 || !cm || cm->cmsg_type != SCM_RIGHTS ||
+        cm->cmsg_len != CMSG_LEN(2 * sizeof(int))) {
+        fprintf(stderr, "ambient_stream: bad handshake\n");
+        goto err;
+    }
+    memcpy(fds, CMSG_DATA(cm), sizeof(fds));
+    s->efd = fds[1];
+    s->shm = mmap(NULL, sizeof(*s->shm), PROT_READ | PROT_WRITE, MAP_SHARED, fds[0], 0);
+    close(fds[0]);
+    if (s->shm == MAP_FAILED) {
+        s->shm = NULL;
+        goto err;
+    }
+    if (s->shm->magic != AMBIENT_STREAM_MAGIC || s->shm->version != AMBIENT_STREAM_VERSION) {
+        fprintf(stderr, "ambient_stream: version mismatch\n");
+        goto err;
+    }
+    s->prod_slot = 2;   /* daemon: mailbox 0, consumer 1 */
+    return 0;
+err:
+    ambient_stream_close(s);
+    return -1;
+}
+
+struct ambient_stream_slot *ambient_stream_begin(struct ambient_stream *s)
+{
+    return &s->shm->slot[s->prod_slot];
+}
+
+int ambient_stream_publish(struct ambient_stream *s, uint32_t leds)
+{
+    struct ambient_stream_slot *slot = &s->shm->slot[s->prod_slot];
+    unsigned old;
+
+    slot->leds = leds < AMBIENT_STREAM_MAX_LEDS ? leds : AMBIENT_STREAM_MAX_LEDS;
+    slot->seq = ++s->seq;
+    slot->t_publish_ns = mono_ns();
+    old = atomic_exchange_explicit(&s->shm->mailbox, s->prod_slot | AMBIENT_STREAM_FRESH,
+                                   memory_order_acq_rel);
+    s->prod_slot = SLOT_IDX(old);
+
+    /* 이전 프레임이 아직 안 가져가졌으면 daemon 은 이미 깨어 있음 */
+    if (!(old & AMBIENT_STREAM_FRESH)) {
+        uint64_t one = 1;
+        if (write(s->efd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+            return -1;
+    }
+    return 0;
+}
+
+void ambient_stream_close(struct ambient_stream *s)
+{
+    if (s->shm)
+        munmap(s->shm, sizeof(*s->shm));
+    if (s->efd >= 0)
+        close(s->efd);
+    if (s->sock >= 0)
+        close(s->sock);
+    s->shm = NULL;
+    s->efd = s->sock = -1;
+}
+
+/* ===== daemon ===== */
+
+static void drop_conn(struct ambient_stream_server *sv)
+{
+    if (sv->conn < 0)
+        return;
+    munmap(sv->shm, sizeof(*sv->shm));
+    close(sv->efd);
+    close(sv->conn);
+    sv->shm = NULL;
+    sv->efd = sv->conn = -1;
+}
+
+int ambient_stream_listen(struct ambient_stream_server *sv, uint32_t strip_leds)
+{
+    struct sockaddr_un sa;
+
+    memset(sv, 0, sizeof(*sv));
+    sv->conn = sv->efd = -1;
+    sv->lfd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (sv->lfd < 0)
+        return -1;
+    sock_addr(&sa);
+    unlink(sa.sun_path);
+    if (bind(sv->lfd, (struct sockaddr *)&sa, sizeof(sa)) < 0 || listen(sv->lfd, 4) < 0) {
+        perror(sa.sun_path);
+        close(sv->lfd);
+        sv->lfd = -1;
+        return -1;
+    }
+    /* HMI 등 비 root producer 도 접속 */
+    chmod(sa.sun_path, 0666);
+    /* 스트립이 slot 보다 길면 앞쪽 slot 만큼만 외부 프레임을 받음 */
+    sv->strip_leds = strip_leds < AMBIENT_STREAM_MAX_LEDS ? strip_leds : AMBIENT_STREAM_MAX_LEDS;
+    return 0;
+}
+
+/* 새 producer 에게 전용 링 하나를 만들어 넘김 */
+static int new_conn(struct ambient_stream_server *sv, int conn)
+{
+    struct ambient_stream_shm *shm;
+    char byte = 0;
+    struct iovec iov = { .iov_base = &byte, .iov_len = 1 };
+    union {
+        char            buf[CMSG_SPACE(2 * sizeof(int))];
+        struct cmsghdr  align;
+    } ctrl;
+    struct msghdr msg = {
+        .msg_iov = &iov, .msg_iovlen = 1,
+        .msg_control = ctrl.buf, .msg_controllen = sizeof(ctrl.buf),
+    };
+    struct cmsghdr *cm;
+    int fds[2];
+
+    fds[0] = memfd_create("ambient_stream", MFD_CLOEXEC);
+    if (fds[0] < 0)
+        return -1;
+    if (ftruncate(fds[0], sizeof(*shm)) < 0)
+        goto err_memfd;
+    shm = mmap(NULL, sizeof(*shm), PROT_READ | PROT_WRITE, MAP_SHARED, fds[0], 0);
+    if (shm == MAP_FAILED)
+        goto err_memfd;
+    fds[1] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fds[1] < 0)
+        goto err_map;
+
+    shm->magic = AMBIENT_STREAM_MAGIC;
+    shm->version = AMBIENT_STREAM_VERSION;
+    shm->strip_leds = sv->strip_leds;
+    shm->max_leds = AMBIENT_STREAM_MAX_LEDS;
+    atomic_init(&shm->mailbox, 0);
+
+    cm = CMSG_FIRSTHDR(&msg);
+    cm->cmsg_level = SOL_SOCKET;
+    cm->cmsg_type = SCM_RIGHTS;
+    cm->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cm), fds, sizeof(fds));
+    if (sendmsg(conn, &msg, MSG_NOSIGNAL) < 0)
+        goto err_efd;
+    close(fds[0]);
+
+    drop_conn(sv);
+    sv->conn = conn;
+    sv->efd = fds[1];
+    sv->shm = shm;
+    sv->cons_slot = 1;
+    sv->last_seq = 0;
+    return 0;
+
+err_efd:
+    close(fds[1]);
+err_map:
+    munmap(shm, sizeof(*shm));
+err_memfd:
+    close(fds[0]);
+    return -1;
+}
+
+void ambient_stream_service(struct ambient_stream_server *sv)
+{
+    char byte;
+    int conn;
+
+    if (sv->lfd < 0)
+        return;
+
+    /* producer 가 닫았으면 정리 (SEQPACKET: 0 = EOF) */
+    if (sv->conn >= 0 && recv(sv->conn, &byte, 1, MSG_DONTWAIT) == 0)
+        drop_conn(sv);
+
+    while ((conn = accept4(sv->lfd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+        if (new_conn(sv, conn) < 0) {
+            perror("ambient_stream: setup");
+            close(conn);
+        }
+    }
+}
+
+const struct ambient_stream_slot *ambient_stream_take(struct ambient_stream_server *sv, uint64_t *lost)
+{
+    const struct ambient_stream_slot *slot;
+    uint64_t cnt;
+    unsigned old;
+
+    *lost = 0;
+    if (!sv->shm)
+        return NULL;
+
+    /* doorbell 을 먼저 비워야 교환 직후 들어온 publish 의 doorbell 을 놓치지 않음 */
+    if (read(sv->efd, &cnt, sizeof(cnt)) < 0 && errno != EAGAIN)
+        return NULL;
+    if (!(atomic_load_explicit(&sv->shm->mailbox, memory_order_acquire) & AMBIENT_STREAM_FRESH))
+        return NULL;
+    old = atomic_exchange_explicit(&sv->shm->mailbox, sv->cons_slot, memory_order_acq_rel);
+    sv->cons_slot = SLOT_IDX(old) % AMBIENT_STREAM_SLOTS;
+
+    slot = &sv->shm->slot[sv->cons_slot];
+    if (sv->last_seq && slot->seq > sv->last_seq + 1)
+        *lost = slot->seq - sv->last_seq - 1;
+    sv->last_seq = slot->seq;
+    return slot;
+}
+
+void ambient_stream_shutdown(struct ambient_stream_server *sv)
+{
+    struct sockaddr_un sa;
+
+    drop_conn(sv);
+    if (sv->lfd >= 0) {
+        close(sv->lfd);
+        sock_addr(&sa);
+        unlink(sa.sun_path);
+    }
+    sv->lfd = -1;
+}
@@ -0,0 +1,85 @@
+#ifndef AMBIENT_STREAM_H
+#define AMBIENT_STREAM_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+/*
+ * ambient "stream" 모드 외부 프레임 입력 (HMI, 화면 동기화 등).
+ *
+ * producer 가 unix socket 에 접속하면 ambient_daemon 이 memfd 공유 메모리 링과
+ * eventfd(doorbell)를 SCM_RIGHTS 로 넘겨준다. producer 는 slot 의 rgb[] 에
+ * 제자리로 그리고 publish 하며, daemon 은 최신 slot 을 SPI 인코딩 버퍼로
+ * 바로 인코딩한다 (중간 복사 없음).
+ *
+ * slot 교환은 render → transmit 링과 같은 3-slot mailbox (latest-wins):
+ * producer/daemon 이 각자 slot 하나씩 쥐고 나머지 하나를 mailbox 로 원자적 교환.
+ * 연결은 한 번에 하나, 새 producer 가 접속하면 이전 연결은 닫힌다.
+ */
+
+#define AMBIENT_STREAM_SOCK      "/run/ambient_stream.sock"   /* 환경변수 AMBIENT_STREAM_SOCK 로 변경 */
+#define AMBIENT_STREAM_MAGIC     0x534d4241u                  /* "ABMS" */
+#define AMBIENT_STREAM_VERSION   1
+#define AMBIENT_STREAM_SLOTS     3
+#define AMBIENT_STREAM_MAX_LEDS  1024
+#define AMBIENT_STREAM_FRESH     0x100u
+
+struct ambient_stream_slot {
+    uint64_t seq;                /* producer publish 순번 (1부터) */
+    uint64_t t_publish_ns;       /* CLOCK_MONOTONIC, publish 시각 */
+    uint32_t leds;               /* 유효 LED 수 */
+    uint32_t reserved;
+    uint8_t  rgb[AMBIENT_STREAM_MAX_LEDS * 3];
+};
+
+struct ambient_stream_shm {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t strip_leds;         /* producer 가 채울 LED 수 (<= max_leds) */
+    uint32_t max_leds;
+    _Atomic uint32_t mailbox;    /* slot index | AMBIENT_STREAM_FRESH */
+
+    /* daemon 이 갱신 (producer 피드백용) */
+    _Atomic uint64_t shown_seq;  /* 마지막으로 SPI 에 나간 프레임 */
+    _Atomic uint64_t dropped;    /* 전송되지 못하고 덮어써진 프레임 수 */
+    _Atomic uint64_t latency_ns; /* 마지막 프레임 publish → SPI write 완료 */
+
+    struct ambient_stream_slot slot[AMBIENT_STREAM_SLOTS] __attribute__((aligned(64)));
+};
+
+/* ===== producer ===== */
+
+struct ambient_stream {
+    int                        sock, efd;
+    struct ambient_stream_shm *shm;
+    unsigned                   prod_slot;
+    uint64_t                   seq;
+};
+
+int  ambient_stream_connect(struct ambient_stream *s);
+/* 이번 프레임을 그릴 slot (rgb[] 에 R,G,B 순으로 제자리 기록) */
+struct ambient_stream_slot *ambient_stream_begin(struct ambient_stream *s);
+/* leds 개를 공개하고 doorbell */
+int  ambient_stream_publish(struct ambient_stream *s, uint32_t leds);
+void ambient_stream_close(struct ambient_stream *s);
+
+/* ===== daemon ===== */
+
+struct ambient_stream_server {
+    int                        lfd;        /* listen socket */
+    int                        conn;       /* 현재 producer, 없으면 -1 */
+    int                        efd;
+    struct ambient_stream_shm *shm;
+    unsigned                   cons_slot;
+    uint64_t                   last_seq;
+    uint32_t                   strip_leds;
+};
+
+int  ambient_stream_listen(struct ambient_stream_server *sv, uint32_t strip_leds);
+/* 새 접속 수락 / 끊긴 producer 정리. 블록하지 않음 */
+void ambient_stream_service(struct ambient_stream_server *sv);
+/* doorbell 을 비우고 최신 프레임을 가져옴. 새 프레임이 없으면 NULL, *lost 에 건너뛴 프레임 수 */
+const struct ambient_stream_slot *ambient_stream_take(struct ambient_stream_server *sv, uint64_t *lost);
+void ambient_stream_shutdown(struct ambient_stream_server *sv);
+
+#endif // AMBIENT_STREAM_H
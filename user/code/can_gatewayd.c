@@ -0,0 +1,464 @@
+// SPDX-License-Identifier: GPL-2.0
+// can_gatewayd: SocketCAN 프레임 → 액추에이터 ioctl 게이트웨이
+//
+//  - CAN_RAW_FILTER 로 map 에 있는 ID 만 수신
+//  - recvmmsg 로 한 번에 여러 프레임 수신, 배치 안에서는 신호별 최신 값만 적용
+//  - 장치 fd 는 시작 시 한 번만 열어 유지
+//  - 커널 수신 타임스탬프 → ioctl 완료까지 지연 측정
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include "rt_profile.h"
+
+/* 각 드라이버 ioctl (드라이버 소스와 동일) */
+#define WIPER_SET_MODE          _IOW('W', 1, int)
+#define AIRCON_SET_LEVEL        _IOW('A', 1, int)
+#define WINDOW_SET_STATE        _IOW('M', 0, int)
+#define HEADLAMP_SET_STATE      _IOW('H', 0, int)
+#define AMBIENT_SET_BRIGHTNESS  _IOW('L', 3, int)
+
+#define MAX_SIGNALS   32
+#define MAX_VALMAP    16
+#define BATCH         32
+#define LAT_SAMPLES   4096
+#define REPORT_SEC    10
+
+struct actuator {
+    const char    *name;
+    const char    *path;
+    unsigned long  req;
+    int            min, max;
+    int            fd;
+};
+
+static struct actuator actuators[] = {
+    { "wiper",    "/dev/wiper_dev",    WIPER_SET_MODE,         0, 2,   -1 },
+    { "aircon",   "/dev/aircon_dev",   AIRCON_SET_LEVEL,       0, 3,   -1 },
+    { "window",   "/dev/window_dev",   WINDOW_SET_STATE,       0, 2,   -1 },
+    { "headlamp", "/dev/headlamp_dev", HEADLAMP_SET_STATE,     0, 1,   -1 },
+    { "ambient",  "/dev/ambient_dev",  AMBIENT_SET_BRIGHTNESS, 0, 100, -1 },
+};
+#define NACT (sizeof(actuators) / sizeof(actuators[0]))
+
+/* map 한 줄: CAN ID 의 start_bit 부터 length 비트 (Intel/little-endian) */
+struct signal_map {
+    canid_t          id;
+    int              start_bit;
+    int              length;
+    struct actuator *act;
+    int              nval;              /* 0 이면 raw 값 그대로 */
+    int              raw[MAX_VALMAP];
+    int              arg[MAX_VALMAP];
+
+    /* 런타임 상태 */
+    int              last_applied;      /* -1 = 아직 없음 */
+    bool             pending;
+    int              pending_val;
+    struct timespec  pending_ts;        /* 적용될 프레임의 커널 수신 시각 */
+};
+
+static struct signal_map sigs[MAX_SIGNALS];
+static int nsigs;
+
+static volatile sig_atomic_t running = 1;
+static bool dry_run;
+static bool verbose;
+
+/* 통계 */
+static unsigned long st_frames, st_batches, st_applied, st_coalesced, st_redundant, st_errors;
+static uint32_t lat_us[LAT_SAMPLES];
+static unsigned long lat_n;
+
+static void handle_sigint(int sig)
+{
+    running = 0;
+}
+
+static struct actuator *find_actuator(const char *name)
+{
+    for (unsigned i = 0; i < NACT; i++)
+        if (strcmp(actuators[i].name, name) == 0)
+            return &actuators[i];
+    return NULL;
+}
+
+/*
+ * map 파일 형식 (# 주석):
+ *   <can_id> <start_bit> <length> <device> [raw:arg ...]
+ * 예) 0x3A0 0 2 wiper 0:0 1:2 2:1
+ */
+static int load_map(const char *path)
+{
+    FILE *fp = fopen(path, "r");
+    char line[256];
+    int lineno = 0;
+
+    if (!fp) {
+        perror(path);
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), fp)) {
+        struct signal_map *m;
+        char *tok, *save;
+
+        lineno++;
+        line[strcspn(line, "#\r\n")] = '\0';
+        tok = strtok_r(line, " \t", &save);
+        if (!tok)
+            continue;
+        if (nsigs == MAX_SIGNALS) {
+            fprintf(stderr, "%s:%d: too many signals\n", path, lineno);
+            break;
+        }
+
+        m = &sigs[nsigs];
+        memset(m, 0, sizeof(*m));
+        m->id = strtoul(tok, NULL, 0);
+        if (m->id > CAN_SFF_MASK)
+            m->id |= CAN_EFF_FLAG;
+
+        tok = strtok_r(NULL, " \t", &save);
+        m->start_bit = tok ? atoi(tok) : -1;
+        tok = strtok_r(NULL, " \t", &save);
+        m->length = tok ? atoi(tok) : -1;
+        tok = strtok_r(NULL, " \t", &save);
+        m->act = tok ? find_actuator(tok) : NULL;
+
+        if (m->start_bit < 0 || m->length < 1 || m->length > 32 ||
+            m->start_bit + m->length > 64 || !m->act) {
+            fprintf(stderr, "%s:%d: bad signal definition\n", path, lineno);
+            fclose(fp);
+            return -1;
+        }
+
+        while ((tok = strtok_r(NULL, " \t", &save)) && m->nval < MAX_VALMAP) {
+            if (sscanf(tok, "%i:%i", &m->raw[m->nval], &m->arg[m->nval]) != 2) {
+                fprintf(stderr, "%s:%d: bad value map '%s'\n", path, lineno, tok);
+                fclose(fp);
+                return -1;
+            }
+            /* 범위 밖 arg 는 런타임에 ioctl EINVAL 만 반복하므로 로드할 때 거부 */
+            if (m->arg[m->nval] < m->act->min || m->arg[m->nval] > m->act->max) {
+                fprintf(stderr, "%s:%d: value map '%s': %s arg must be %d..%d\n",
+                        path, lineno, tok, m->act->name, m->act->min, m->act->max);
+                fclose(fp);
+                return -1;
+            }
+            m->nval++;
+        }
+        m->last_applied = -1;
+        nsigs++;
+    }
+
+    fclose(fp);
+    return nsigs > 0 ? 0 : -1;
+}
+
+static int open_can(const char *ifname)
+{
+    struct sockaddr_can addr = { .can_family = AF_CAN };
+    struct can_filter filters[MAX_SIGNALS];
+    int one = 1;
+    int s;
+
+    s = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    if (s < 0) {
+        perror("socket(PF_CAN)");
+        return -1;
+    }
+
+    addr.can_ifindex = if_nametoindex(ifname);
+    if (!addr.can_ifindex) {
+        perror(ifname);
+        close(s);
+        return -1;
+    }
+
+    /* 관심 ID 만 커널에서 걸러서 받음 */
+    for (int i = 0; i < nsigs; i++) {
+        filters[i].can_id = sigs[i].id;
+        filters[i].can_mask = (sigs[i].id & CAN_EFF_FLAG) ?
+                              (CAN_EFF_FLAG | CAN_EFF_MASK) : (CAN_EFF_FLAG | CAN_SFF_MASK);
+    }
+    if (setsockopt(s, SOL_CAN_RAW, CAN_RAW_FILTER, filters, nsigs * sizeof(filters[0])) < 0)
+        perror("CAN_RAW_FILTER");
+
+    if (setsockopt(s, SOL_SOCKET, SO_TIMESTAMPNS, &one, sizeof(one)) < 0)
+        perror("SO_TIMESTAMPNS");
+
+    if (bind(s, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        perror("bind");
+        close(s);
+        return -1;
+    }
+    return s;
+}
+
+static int open_actuators(void)
+{
+    for (int i = 0; i < nsigs; i++) {
+        struct actuator *a = sigs[i].act;
+
+        if (dry_run || a->fd >= 0)
+            continue;
+        a->fd = open(a->path, O_RDWR);
+        if (a->fd < 0) {
+            perror(a->path);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static uint64_t frame_bits(const struct can_frame *f)
+{
+    uint64_t v = 0;
+
+    for (int i = 0; i < f->can_dlc && i < 8; i++)
+        v |= (uint64_t)f->data[i] << (8 * i);
+    return v;
+}
+
+/* raw 신호 → ioctl 인자. 매핑에 없거나 범위 밖이면 -1 */
+static int decode_value(const struct signal_map *m, uint32_t raw)
+{
+    if (m->nval == 0)
+        return ((int)raw >= m->act->min && (int)raw <= m->act->max) ? (int)raw : -1;
+
+    for (int i = 0; i < m->nval; i++)
+        if ((uint32_t)m->raw[i] == raw)
+            return m->arg[i];
+    return -1;
+}
+
+static void handle_frame(const struct can_frame *f, const struct timespec *ts)
+{
+    uint64_t bits = frame_bits(f);
+
+    for (int i = 0; i < nsigs; i++) {
+        struct signal_map *m = &sigs[i];
+        uint32_t raw;
+        int val;
+
+        if (m->id != f->can_id)
+            continue;
+        if (m->start_bit + m->length > f->can_dlc * 8)
+            continue;
+
+        raw = (bits >> m->start_bit) & ((m->length == 32) ? 0xffffffffu : ((1u << m->length) - 1));
+        val = decode_value(m, raw);
+        if (val < 0)
+            continue;
+
+        /* 같은 배치에서 덮어쓰이면 coalesced */
+        if (m->pending)
+            st_coalesced++;
+        m->pending = true;
+        m->pending_val = val;
+        m->pending_ts = *ts;
+    }
+}
+
+static void record_latency(const struct timespec *rx)
+{
+    struct timespec now;
+    int64_t us;
+
+    clock_gettime(CLOCK_REALTIME, &now);   /* SO_TIMESTAMPNS 는 REALTIME 기준 */
+    us = (now.tv_sec - rx->tv_sec) * 1000000LL + (now.tv_nsec - rx->tv_nsec) / 1000;
+    if (us < 0)
+        us = 0;
+    lat_us[lat_n++ % LAT_SAMPLES] = us > UINT32_MAX ? UINT32_MAX : (uint32_t)us;
+}
+
+static void apply_pending(void)
+{
+    for (int i = 0; i < nsigs; i++) {
+        struct signal_map *m = &sigs[i];
+        int val;
+
+        if (!m->pending)
+            continue;
+        m->pending = false;
+
+        /* 이미 적용된 값이면 ioctl 생략 */
+        if (m->pending_val == m->last_applied) {
+            st_redundant++;
+            continue;
+        }
+
+        val = m->pending_val;
+        if (!dry_run && ioctl(m->act->fd, m->act->req, &val) < 0) {
+            if (st_errors++ < 10)
+                fprintf(stderr, "ioctl %s=%d: %s\n", m->act->name, m->pending_val, strerror(errno));
+            continue;
+        }
+        record_latency(&m->pending_ts);
+        m->last_applied = m->pending_val;
+        st_applied++;
+        if (verbose)
+            printf("[can_gatewayd] %03X -> %s = %d\n",
+                   m->id & CAN_EFF_MASK, m->act->name, m->pending_val);
+    }
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void report(void)
+{
+    static uint32_t sorted[LAT_SAMPLES];
+    unsigned long n = lat_n < LAT_SAMPLES ? lat_n : LAT_SAMPLES;
+
+    printf("[can_gatewayd] frames %lu, batches %lu (%.1f/batch), applied %lu, "
+           "coalesced %lu, redundant %lu, errors %lu\n",
+           st_frames, st_batches, st_batches ? (double)st_frames / st_batches : 0.0,
+           st_applied, st_coalesced, st_redundant, st_errors);
+    if (n == 0)
+        return;
+
+    memcpy(sorted, lat_us, n * sizeof(sorted[0]));
+    qsort(sorted, n, sizeof(sorted[0]), cmp_u32);
+    printf("[can_gatewayd] frame->ioctl latency us (last %lu): p50 %u p99 %u max %u\n",
+           n, sorted[n / 2], sorted[(n * 99) / 100], sorted[n - 1]);
+    fflush(stdout);
+}
+
+static void usage(const char *progname)
+{
+    fprintf(stderr,
+            "Usage: %s -i <ifname> -c <map file> [-n] [-v]\n"
+            "  -n : dry-run (장치 ioctl 생략, vcan 단독 시험용)\n"
+            "  -v : 적용되는 명령 출력\n", progname);
+    rt_usage(stderr);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *ifname = NULL, *map_path = NULL;
+    struct mmsghdr msgs[BATCH];
+    struct iovec iov[BATCH];
+    struct can_frame frames[BATCH];
+    union {
+        char            buf[CMSG_SPACE(sizeof(struct timespec))];
+        struct cmsghdr  align;
+    } ctrl[BATCH];
+    struct sigaction sa = { .sa_handler = handle_sigint };
+    struct timespec last_report;
+    struct rt_profile rt;
+    int opt, s;
+
+    rt_profile_init(&rt);
+    if (rt_parse_args(&rt, &argc, argv) < 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    while ((opt = getopt(argc, argv, "i:c:nvh")) != -1) {
+        switch (opt) {
+        case 'i': ifname = optarg; break;
+        case 'c': map_path = optarg; break;
+        case 'n': dry_run = true; break;
+        case 'v': verbose = true; break;
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (!ifname || !map_path) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (load_map(map_path) < 0)
+        return EXIT_FAILURE;
+    if (open_actuators() < 0)
+        return EXIT_FAILURE;
+    s = open_can(ifname);
+    if (s < 0)
+        return EXIT_FAILURE;
+
+    /* recvmmsg 가 시그널에 깨어나도록 SA_RESTART 없이 등록 */
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    for (int i = 0; i < BATCH; i++) {
+        iov[i].iov_base = &frames[i];
+        iov[i].iov_len = sizeof(frames[i]);
+        memset(&msgs[i], 0, sizeof(msgs[i]));
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    rt_apply(&rt, "can_gatewayd");
+    rt_selftest(&rt, "can_gatewayd");
+
+    printf("[can_gatewayd] %d signals on %s%s\n", nsigs, ifname, dry_run ? " (dry-run)" : "");
+    clock_gettime(CLOCK_MONOTONIC, &last_report);
+
+    while (running) {
+        struct timespec now;
+        int n;
+
+        for (int i = 0; i < BATCH; i++) {
+            msgs[i].msg_hdr.msg_control = ctrl[i].buf;
+            msgs[i].msg_hdr.msg_controllen = sizeof(ctrl[i].buf);
+        }
+
+        /* 최소 1개가 올 때까지 대기 후, 쌓여 있는 만큼 한 번에 */
+        n = recvmmsg(s, msgs, BATCH, MSG_WAITFORONE, NULL);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("recvmmsg");
+            break;
+        }
+
+        st_batches++;
+        for (int i = 0; i < n; i++) {
+            struct timespec ts = { 0, 0 };
+            struct cmsghdr *c;
+
+            if (msgs[i].msg_len < sizeof(struct can_frame))
+                continue;
+            for (c = CMSG_FIRSTHDR(&msgs[i].msg_hdr); c; c = CMSG_NXTHDR(&msgs[i].msg_hdr, c))
+                if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_TIMESTAMPNS)
+                    memcpy(&ts, CMSG_DATA(c), sizeof(ts));
+            if (ts.tv_sec == 0)
+                clock_gettime(CLOCK_REALTIME, &ts);
+
+            st_frames++;
+            handle_frame(&frames[i], &ts);
+        }
+        apply_pending();
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (now.tv_sec - last_report.tv_sec >= REPORT_SEC) {
+            report();
+            last_report = now;
+        }
+    }
+
+    report();
+    close(s);
+    for (unsigned i = 0; i < NACT; i++)
+        if (actuators[i].fd >= 0)
+            close(actuators[i].fd);
+    return 0;
+}
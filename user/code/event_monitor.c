@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: GPL-2.0
+// 각 /dev/*_dev 의 상태 전이 이벤트 로그를 poll + read 로 일괄 수신해 출력
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+
+/* driver/code/topst_event.h 와 동일한 레이아웃 */
+struct topst_event {
+    int64_t  ktime_ns;
+    uint32_t seq;
+    uint32_t overflow;
+    uint16_t device;
+    uint16_t cause;
+    uint16_t attr;
+    uint16_t reserved;
+    int32_t  old_val;
+    int32_t  new_val;
+};
+
+#define TOPST_EV_ATTR_MODE 1
+#define TOPST_EV_ATTR_PARK 3
+#define TOPST_EV_ATTR_SCENE 4
+
+#define BATCH 64
+
+static const char *const dev_paths[] = {
+    "/dev/ambient_dev",
+    "/dev/wiper_dev",
+    "/dev/window_dev",
+    "/dev/aircon_dev",
+    "/dev/headlamp_dev",
+};
+#define NDEV (sizeof(dev_paths) / sizeof(dev_paths[0]))
+
+static const char *const dev_names[] = { "?", "ambient", "wiper", "window", "aircon", "headlamp" };
+static const char *const cause_names[] = { "?", "ioctl", "limit-upper", "limit-lower", "thermal", "pinch", "pm" };
+static const char *const park_names[] = { "active", "parking", "parked", "suspended" };
+#define NPARK (sizeof(park_names) / sizeof(park_names[0]))
+
+static volatile int running = 1;
+
+static void handle_sigint(int sig)
+{
+    running = 0;
+}
+
+static void print_event(const struct topst_event *ev)
+{
+    const char *dev = ev->device < sizeof(dev_names) / sizeof(dev_names[0]) ?
+                      dev_names[ev->device] : "?";
+    const char *cause = ev->cause < sizeof(cause_names) / sizeof(cause_names[0]) ?
+                        cause_names[ev->cause] : "?";
+
+    if (ev->attr == TOPST_EV_ATTR_MODE) {
+        char o[5] = {0}, n[5] = {0};
+        memcpy(o, &ev->old_val, 4);
+        memcpy(n, &ev->new_val, 4);
+        printf("%lld.%09lld %-8s #%u %-11s mode %s -> %s\n",
+               (long long)(ev->ktime_ns / 1000000000), (long long)(ev->ktime_ns % 1000000000),
+               dev, ev->seq, cause, o, n);
+    } else if (ev->attr == TOPST_EV_ATTR_PARK &&
+               (unsigned)ev->old_val < NPARK && (unsigned)ev->new_val < NPARK) {
+        printf("%lld.%09lld %-8s #%u %-11s park %s -> %s\n",
+               (long long)(ev->ktime_ns / 1000000000), (long long)(ev->ktime_ns % 1000000000),
+               dev, ev->seq, cause, park_names[ev->old_val], park_names[ev->new_val]);
+    } else if (ev->attr == TOPST_EV_ATTR_SCENE) {
+        printf("%lld.%09lld %-8s #%u %-11s scene %d -> %d\n",
+               (long long)(ev->ktime_ns / 1000000000), (long long)(ev->ktime_ns % 1000000000),
+               dev, ev->seq, cause, ev->old_val, ev->new_val);
+    } else {
+        printf("%lld.%09lld %-8s #%u %-11s attr%u %d -> %d\n",
+               (long long)(ev->ktime_ns / 1000000000), (long long)(ev->ktime_ns % 1000000000),
+               dev, ev->seq, cause, ev->attr, ev->old_val, ev->new_val);
+    }
+}
+
+int main(void)
+{
+    struct pollfd pfd[NDEV];
+    uint32_t last_overflow[NDEV] = {0};
+    struct topst_event evs[BATCH];
+    int n = 0;
+
+    signal(SIGINT, handle_sigint);
+    signal(SIGTERM, handle_sigint);
+
+    for (unsigned i = 0; i < NDEV; i++) {
+        pfd[i].fd = open(dev_paths[i], O_RDONLY | O_NONBLOCK);
+        pfd[i].events = POLLIN;
+        if (pfd[i].fd < 0)
+            perror(dev_paths[i]);
+        else
+            n++;
+    }
+    if (n == 0)
+        return EXIT_FAILURE;
+
+    while (running && n > 0) {
+        if (poll(pfd, NDEV, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("poll");
+            break;
+        }
+
+        for (unsigned i = 0; i < NDEV; i++) {
+            ssize_t r;
+
+            if (pfd[i].fd < 0)
+                continue;
+            /* 드라이버 제거됨: 남은 이벤트를 다 읽은 뒤 닫는다 */
+            if ((pfd[i].revents & (POLLHUP | POLLERR)) && !(pfd[i].revents & POLLIN)) {
+                printf("!! %s: device removed\n", dev_paths[i]);
+                close(pfd[i].fd);
+                pfd[i].fd = -1;
+                n--;
+                continue;
+            }
+            if (!(pfd[i].revents & POLLIN))
+                continue;
+
+            /* 한 번의 read 로 최대 BATCH 개 수신 */
+            r = read(pfd[i].fd, evs, sizeof(evs));
+            if (r < 0) {
+                if (errno != EAGAIN)
+                    perror(dev_paths[i]);
+                continue;
+            }
+            for (int k = 0; k < r / (ssize_t)sizeof(evs[0]); k++) {
+                if (evs[k].overflow != last_overflow[i]) {
+                    printf("!! %s: %u events dropped\n", dev_paths[i],
+                           evs[k].overflow - last_overflow[i]);
+                    last_overflow[i] = evs[k].overflow;
+                }
+                print_event(&evs[k]);
+            }
+        }
+        fflush(stdout);
+    }
+
+    for (unsigned i = 0; i < NDEV; i++)
+        if (pfd[i].fd >= 0)
+            close(pfd[i].fd);
+    return 0;
+}
@@ -3,21 +3,129 @@
 #include <unistd.h>
 #include <sys/ioctl.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include "setter_replay.h"
 
 #define DEVICE_PATH "/dev/headlamp_dev"
 #define HEADLAMP_MAGIC 'H'
 #define HEADLAMP_SET_STATE _IOW(HEADLAMP_MAGIC, 0, int)
 #define HEADLAMP_GET_STATE _IOR(HEADLAMP_MAGIC, 1, int)
+#define HEADLAMP_SET_MASK _IOW(HEADLAMP_MAGIC, 2, uint32_t)
+#define HEADLAMP_GET_MASK _IOR(HEADLAMP_MAGIC, 3, uint32_t)
+
+static int parse_state(const char *word, struct replay_cmd *out) {
+    if (strcmp(word, "0") == 0 || strcmp(word, "off") == 0) {
+        out->req = HEADLAMP_SET_STATE;
+        out->val = 0;
+    } else if (strcmp(word, "1") == 0 || strcmp(word, "on") == 0) {
+        out->req = HEADLAMP_SET_STATE;
+        out->val = 1;
+    } else if (strncmp(word, "mask=", 5) == 0) {
+        out->req = HEADLAMP_SET_MASK;
+        out->val = (int)strtoul(word + 5, NULL, 0);
+    } else if (strcmp(word, "get") == 0) {
+        out->req = HEADLAMP_GET_STATE;
+        out->val = 0;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/*
+ * 카메라 프레임 주기로 mask 를 흘려 보는 시험용: 끄는 구간(4 세그먼트)이
+ * 좌→우로 움직이는 패턴. ioctl 왕복 시간과 실제 달성 rate 출력.
+ */
+static int mask_sweep(int fd, int fps, int seconds, int nseg) {
+    struct timespec next;
+    uint64_t t0, lat, lat_sum = 0, lat_max = 0;
+    long period_ns = 1000000000L / fps;
+    int frames = fps * seconds, i;
+
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    t0 = now_ns();
+    for (i = 0; i < frames; i++) {
+        int pos = i % nseg;
+        uint32_t all = nseg >= 32 ? 0xffffffffu : (1u << nseg) - 1;
+        uint32_t mask = all & ~(0xfu << pos);
+        uint64_t t = now_ns();
+
+        if (ioctl(fd, HEADLAMP_SET_MASK, &mask) < 0) {
+            perror("ioctl HEADLAMP_SET_MASK failed");
+            return 1;
+        }
+        lat = now_ns() - t;
+        lat_sum += lat;
+        if (lat > lat_max)
+            lat_max = lat;
+
+        next.tv_nsec += period_ns;
+        while (next.tv_nsec >= 1000000000L) {
+            next.tv_sec++;
+            next.tv_nsec -= 1000000000L;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+    }
+    printf("mask updates %d in %.2f s (%.1f Hz), ioctl avg %.1f / max %.1f us\n", frames,
+           (now_ns() - t0) / 1e9, frames * 1e9 / (now_ns() - t0),
+           lat_sum / 1e3 / frames, lat_max / 1e3);
+    return 0;
+}
+
+static int mask_main(int argc, char *argv[]) {
+    uint32_t mask;
+    int fd, ret = 0;
+
+    fd = open(DEVICE_PATH, O_RDWR);
+    if (fd < 0) {
+        perror("Open device failed");
+        return 1;
+    }
+    if (strcmp(argv[1], "mask-sweep") == 0) {
+        int fps = argc > 2 ? atoi(argv[2]) : 60;
+        int seconds = argc > 3 ? atoi(argv[3]) : 5;
+        int nseg = argc > 4 ? atoi(argv[4]) : 16;
+        ret = mask_sweep(fd, fps > 0 ? fps : 60, seconds > 0 ? seconds : 5,
+                         nseg > 4 && nseg <= 32 ? nseg : 16);
+    } else if (argc == 3) {
+        mask = strtoul(argv[2], NULL, 0);
+        if (ioctl(fd, HEADLAMP_SET_MASK, &mask) < 0) {
+            perror("ioctl HEADLAMP_SET_MASK failed");
+            ret = 1;
+        }
+    }
+    if (ret == 0 && ioctl(fd, HEADLAMP_GET_MASK, &mask) == 0)
+        printf("Headlamp segment mask: 0x%08x\n", mask);
+    close(fd);
+    return ret;
+}
 
 int main(int argc, char *argv[]) {
     int fd;
     int state;
     int ret;
 
+    if (argc >= 2 && strcmp(argv[1], "--replay") == 0)
+        return replay_main(DEVICE_PATH, argc, argv, parse_state);
+    if (argc >= 2 && (strcmp(argv[1], "mask") == 0 || strcmp(argv[1], "mask-sweep") == 0))
+        return mask_main(argc, argv);
+
     if (argc != 2) {
         printf("Usage: %s <0|1>\n", argv[0]);
         printf("  0: Turn off headlamp\n");
         printf("  1: Turn on headlamp\n");
+        printf("       %s mask [0xMASK]                  세그먼트 mask 설정/조회 (bit n = segment n)\n", argv[0]);
+        printf("       %s mask-sweep [fps] [sec] [segs]  이동 패턴 (기본 60 fps 5초 16 세그먼트)\n", argv[0]);
+        printf("       %s --replay [file|-] [--max-rate] [--repeat N]\n", argv[0]);
+        printf("  script commands: 0|1|off|on|get|mask=0xMASK\n");
         return 1;
     }
 
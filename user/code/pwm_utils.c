@@ -5,9 +5,22 @@
 #include <fcntl.h>
 #include <errno.h>
 #include "pwm_utils.h"
+#include "uring_io.h"
 
 #define SYSFS_PWM_BASE "/sys/class/pwm"
 
+/* 시뮬레이션(sim/sim.sh)은 TOPST_PWM_BASE 로 가짜 PWM 트리를 가리킨다 */
+static const char *pwm_base(void)
+{
+    static const char *base;
+
+    if (!base) {
+        const char *env = getenv("TOPST_PWM_BASE");
+        base = env && *env ? env : SYSFS_PWM_BASE;
+    }
+    return base;
+}
+
 static int write_sysfs(const char *path, const char *value)
 {
     int fd = open(path, O_WRONLY);
@@ -28,43 +41,256 @@ static int write_sysfs(const char *path, const char *value)
 
 int pwm_export(int chip, int channel)
 {
-    char path[128];
+    char path[256];
     char val[16];
-    snprintf(path, sizeof(path), SYSFS_PWM_BASE "/pwmchip%d/export", chip);
+    snprintf(path, sizeof(path), "%s/pwmchip%d/export", pwm_base(), chip);
     snprintf(val, sizeof(val), "%d", channel);
     return write_sysfs(path, val);
 }
 
 int pwm_unexport(int chip, int channel)
 {
-    char path[128];
+    char path[256];
     char val[16];
-    snprintf(path, sizeof(path), SYSFS_PWM_BASE "/pwmchip%d/unexport", chip);
+    snprintf(path, sizeof(path), "%s/pwmchip%d/unexport", pwm_base(), chip);
     snprintf(val, sizeof(val), "%d", channel);
     return write_sysfs(path, val);
 }
 
 int pwm_set_period(int chip, int channel, int period_ns)
 {
-    char path[128];
+    char path[256];
     char val[32];
-    snprintf(path, sizeof(path), SYSFS_PWM_BASE "/pwmchip%d/pwm%d/period", chip, channel);
+    snprintf(path, sizeof(path), "%s/pwmchip%d/pwm%d/period", pwm_base(), chip, channel);
     snprintf(val, sizeof(val), "%d", period_ns);
     return write_sysfs(path, val);
 }
 
 int pwm_set_duty_cycle(int chip, int channel, int duty_ns)
 {
-    char path[128];
+    char path[256];
     char val[32];
-    snprintf(path, sizeof(path), SYSFS_PWM_BASE "/pwmchip%d/pwm%d/duty_cycle", chip, channel);
+    snprintf(path, sizeof(path), "%s/pwmchip%d/pwm%d/duty_cycle", pwm_base(), chip, channel);
     snprintf(val, sizeof(val), "%d", duty_ns);
     return write_sysfs(path, val);
 }
 
 int pwm_enable(int chip, int channel, int enable)
 {
-    char path[128];
-    snprintf(path, sizeof(path), SYSFS_PWM_BASE "/pwmchip%d/pwm%d/enable", chip, channel);
+    char path[256];
+    snprintf(path, sizeof(path), "%s/pwmchip%d/pwm%d/enable", pwm_base(), chip, channel);
     return write_sysfs(path, enable ? "1" : "0");
 }
+
+/* ===== 열어 둔 채널 + io_uring 일괄 제출 ===== */
+
+#define PWM_SLOTS   16          /* 등록 fd/버퍼 수 (채널당 2개) */
+#define PWM_VAL_LEN 16
+
+static struct uring_io pwm_ring;
+static int  pwm_ring_state;     /* 0: 미초기화, 1: 사용, -1: 사용 불가 */
+static int  pwm_slot_fd[PWM_SLOTS];
+static char pwm_slot_buf[PWM_SLOTS][PWM_VAL_LEN];
+static int  pwm_nslots;
+static int  pwm_nchans;
+
+/*
+ * 제출 전 큐 (io_uring 이 해당 파일을 지원하지 않으면 pwrite 로 재실행).
+ * enable write 는 chan 을 기억해 두었다가 flush 가 성공해야 chan->enabled 에 반영
+ */
+static struct { int fd, slot, len, value; struct pwm_chan *chan; } pwm_pending[PWM_SLOTS];
+static int  pwm_npending;
+
+static int pwm_ring_setup(void)
+{
+    struct iovec iov[PWM_SLOTS];
+
+    if (pwm_ring_state)
+        return pwm_ring_state > 0 ? 0 : -1;
+
+    if (uring_init(&pwm_ring, 2 * PWM_SLOTS) < 0) {
+        pwm_ring_state = -1;
+        return -1;
+    }
+    for (int i = 0; i < PWM_SLOTS; i++) {
+        iov[i].iov_base = pwm_slot_buf[i];
+        iov[i].iov_len = PWM_VAL_LEN;
+    }
+    if (uring_register_buffers(&pwm_ring, iov, PWM_SLOTS) < 0) {
+        perror("io_uring register buffers");
+        uring_exit(&pwm_ring);
+        pwm_ring_state = -1;
+        return -1;
+    }
+    pwm_ring_state = 1;
+    return 0;
+}
+
+/* fd 두 개를 등록 테이블에 추가. 실패하면 이 채널은 pwrite 경로 */
+static int pwm_ring_add(struct pwm_chan *c)
+{
+    if (pwm_ring_setup() < 0 || pwm_nslots + 2 > PWM_SLOTS)
+        return -1;
+
+    pwm_slot_fd[pwm_nslots]     = c->duty_fd;
+    pwm_slot_fd[pwm_nslots + 1] = c->enable_fd;
+    if (uring_register_files(&pwm_ring, pwm_slot_fd, pwm_nslots + 2) < 0) {
+        perror("io_uring register files");
+        if (pwm_nslots)
+            uring_register_files(&pwm_ring, pwm_slot_fd, pwm_nslots);
+        return -1;
+    }
+    c->duty_slot   = pwm_nslots;
+    c->enable_slot = pwm_nslots + 1;
+    pwm_nslots += 2;
+    return 0;
+}
+
+static int open_attr(int chip, int channel, const char *attr)
+{
+    char path[256];
+    int fd;
+
+    snprintf(path, sizeof(path), "%s/pwmchip%d/pwm%d/%s", pwm_base(), chip, channel, attr);
+    fd = open(path, O_WRONLY);
+    if (fd < 0)
+        perror(path);
+    return fd;
+}
+
+int pwm_chan_open(struct pwm_chan *c, int chip, int channel)
+{
+    c->chip = chip;
+    c->channel = channel;
+    c->duty_slot = c->enable_slot = -1;
+    c->enabled = -1;
+
+    c->duty_fd = open_attr(chip, channel, "duty_cycle");
+    if (c->duty_fd < 0)
+        return -1;
+    c->enable_fd = open_attr(chip, channel, "enable");
+    if (c->enable_fd < 0) {
+        close(c->duty_fd);
+        return -1;
+    }
+
+    pwm_ring_add(c);
+    pwm_nchans++;
+    return 0;
+}
+
+void pwm_chan_close(struct pwm_chan *c)
+{
+    if (c->duty_fd >= 0)
+        close(c->duty_fd);
+    if (c->enable_fd >= 0)
+        close(c->enable_fd);
+    c->duty_fd = c->enable_fd = -1;
+
+    /* 마지막 채널이면 링도 정리 (등록 fd 는 링이 참조를 쥐고 있음) */
+    if (--pwm_nchans == 0 && pwm_ring_state > 0) {
+        uring_exit(&pwm_ring);
+        pwm_ring_state = 0;
+        pwm_nslots = 0;
+    }
+}
+
+/* 1: io_uring 에 큐잉 (pwm_flush 에서 제출), 0: pwrite 로 바로 씀, -1: 실패 */
+static int queue_value(int fd, int slot, int value, int link, struct pwm_chan *chan)
+{
+    char tmp[PWM_VAL_LEN];
+    int use_ring = slot >= 0 && pwm_ring_state > 0;
+    char *buf = use_ring ? pwm_slot_buf[slot] : tmp;
+    int len = snprintf(buf, PWM_VAL_LEN, "%d", value);
+
+    if (use_ring) {
+        if (uring_queue_write(&pwm_ring, slot, slot, buf, len, link) < 0)
+            return -1;
+        pwm_pending[pwm_npending].fd = fd;
+        pwm_pending[pwm_npending].slot = slot;
+        pwm_pending[pwm_npending].len = len;
+        pwm_pending[pwm_npending].value = value;
+        pwm_pending[pwm_npending].chan = chan;
+        pwm_npending++;
+        return 1;
+    }
+
+    if (pwrite(fd, buf, len, 0) < 0) {
+        perror("pwm pwrite");
+        return -1;
+    }
+    return 0;
+}
+
+int pwm_chan_queue(struct pwm_chan *c, int duty_ns, int enable)
+{
+    int need_enable = (c->enabled != enable);
+    int ret;
+
+    /* duty 가 실패하면 enable 도 취소되도록 link */
+    if (queue_value(c->duty_fd, c->duty_slot, duty_ns, need_enable, NULL) < 0)
+        return -1;
+    if (need_enable) {
+        ret = queue_value(c->enable_fd, c->enable_slot, enable ? 1 : 0, 0, c);
+        if (ret < 0)
+            return -1;
+        /* pwrite 는 이미 썼고, io_uring 이면 pwm_flush 가 결과에 따라 반영 */
+        if (ret == 0)
+            c->enabled = enable;
+    }
+    return 0;
+}
+
+/* 큐의 [from, n) 에 있는 enable write 결과를 캐시에 반영. 실패면 모름(-1) → 다음 queue 가 다시 씀 */
+static void pwm_pending_done(int from, int n, int ok)
+{
+    for (int i = from; i < n; i++)
+        if (pwm_pending[i].chan)
+            pwm_pending[i].chan->enabled = ok ? pwm_pending[i].value : -1;
+}
+
+int pwm_flush(void)
+{
+    int ret, n = pwm_npending;
+
+    if (pwm_ring_state <= 0 || n == 0)
+        return 0;
+    pwm_npending = 0;
+
+    ret = uring_submit_wait(&pwm_ring);
+    if (ret == -EINVAL || ret == -EOPNOTSUPP) {
+        /* 구 커널: write_iter 없는 sysfs 파일은 io_uring write 불가 → pwrite 로 전환 */
+        fprintf(stderr, "pwm: io_uring write not supported here, falling back to pwrite\n");
+        uring_exit(&pwm_ring);
+        pwm_ring_state = -1;
+        for (int i = 0; i < n; i++) {
+            if (pwrite(pwm_pending[i].fd, pwm_slot_buf[pwm_pending[i].slot],
+                       pwm_pending[i].len, 0) < 0) {
+                perror("pwm pwrite");
+                pwm_pending_done(i, n, 0);
+                return -1;
+            }
+            pwm_pending_done(i, i + 1, 1);
+        }
+        return 0;
+    }
+    /* 어느 write 가 실패했는지는 모르므로 이번 묶음의 enable 은 모두 모름으로 */
+    pwm_pending_done(0, n, ret == 0);
+    if (ret < 0) {
+        fprintf(stderr, "pwm io_uring write: %s\n", strerror(-ret));
+        return -1;
+    }
+    return 0;
+}
+
+int pwm_chan_update(struct pwm_chan *c, int duty_ns, int enable)
+{
+    if (pwm_chan_queue(c, duty_ns, enable) < 0)
+        return -1;
+    return pwm_flush();
+}
+
+const char *pwm_backend_name(void)
+{
+    return pwm_ring_state > 0 ? "io_uring" : "pwrite";
+}
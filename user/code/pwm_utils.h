@@ -1,10 +1,34 @@
 #ifndef PWM_UTILS_H
 #define PWM_UTILS_H
 
+/* sysfs 경로 기준은 /sys/class/pwm, 환경변수 TOPST_PWM_BASE 로 바꿀 수 있음 */
 int pwm_export(int chip, int channel);
 int pwm_unexport(int chip, int channel);
 int pwm_set_period(int chip, int channel, int period_ns);
 int pwm_set_duty_cycle(int chip, int channel, int duty_ns);
 int pwm_enable(int chip, int channel, int enable);
 
+/*
+ * 주기적으로 갱신하는 채널용 핸들. duty_cycle/enable sysfs fd 를 열어 두고,
+ * io_uring 이 있으면 등록 fd/버퍼에 대한 linked write 로 제출한다.
+ * 없으면 열어 둔 fd 에 pwrite (매번 open/close 하지 않음).
+ */
+struct pwm_chan {
+    int chip, channel;
+    int duty_fd, enable_fd;
+    int duty_slot, enable_slot;   /* io_uring 등록 index, -1 = 일반 write */
+    int enabled;                  /* 마지막으로 적용된 enable 값, -1 = 모름 (flush 실패 포함) */
+};
+
+int  pwm_chan_open(struct pwm_chan *c, int chip, int channel);
+void pwm_chan_close(struct pwm_chan *c);
+/* duty → enable 순서로 큐잉 (enable 은 바뀔 때만). pwm_flush() 로 제출 */
+int  pwm_chan_queue(struct pwm_chan *c, int duty_ns, int enable);
+/* 큐잉된 모든 채널 갱신을 한 번에 제출하고 완료 대기 */
+int  pwm_flush(void);
+/* pwm_chan_queue + pwm_flush */
+int  pwm_chan_update(struct pwm_chan *c, int duty_ns, int enable);
+/* 현재 갱신 경로 이름 ("io_uring" / "pwrite") */
+const char *pwm_backend_name(void);
+
 #endif // PWM_UTILS_H
@@ -0,0 +1,282 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <alloca.h>
+#include <malloc.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include "rt_profile.h"
+
+void rt_profile_init(struct rt_profile *rt)
+{
+    memset(rt, 0, sizeof(*rt));
+    rt->stack_kb    = 256;
+    rt->interval_us = 1000;
+}
+
+static int set_key(struct rt_profile *rt, const char *key, const char *val)
+{
+    char *end;
+    long v = 0;
+
+    if (strcmp(key, "cpus") == 0) {
+        if (!val || strlen(val) >= sizeof(rt->cpus))
+            return -1;
+        strcpy(rt->cpus, val);
+        return 0;
+    }
+    if (val) {
+        v = strtol(val, &end, 0);
+        if (end == val || *end)
+            return -1;
+    }
+    if (strcmp(key, "prio") == 0) {
+        if (v < 0 || v > 99)
+            return -1;
+        rt->prio = v;
+    } else if (strcmp(key, "mlock") == 0) {
+        rt->mlock = val ? v != 0 : 1;
+    } else if (strcmp(key, "stack_kb") == 0) {
+        if (v < 0)
+            return -1;
+        rt->stack_kb = v;
+    } else if (strcmp(key, "selftest") == 0) {
+        rt->selftest = val ? v : 1000;
+    } else if (strcmp(key, "interval_us") == 0) {
+        if (v < 50)
+            return -1;
+        rt->interval_us = v;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+int rt_load_config(struct rt_profile *rt, const char *path)
+{
+    FILE *fp = fopen(path, "r");
+    char line[256];
+    int lineno = 0;
+
+    if (!fp) {
+        perror(path);
+        return -1;
+    }
+    while (fgets(line, sizeof(line), fp)) {
+        char *p = line, *eq, *key, *val;
+
+        lineno++;
+        p[strcspn(p, "#\r\n")] = '\0';
+        eq = strchr(p, '=');
+        if (!eq) {
+            if (strspn(p, " \t") == strlen(p))
+                continue;
+            fprintf(stderr, "%s:%d: key=value 형식이 아님\n", path, lineno);
+            fclose(fp);
+            return -1;
+        }
+        *eq = '\0';
+        key = strtok(p, " \t");
+        val = strtok(eq + 1, " \t");
+        if (!key || set_key(rt, key, val) < 0) {
+            fprintf(stderr, "%s:%d: 잘못된 설정 '%s'\n", path, lineno, key ? key : "");
+            fclose(fp);
+            return -1;
+        }
+    }
+    fclose(fp);
+    return 0;
+}
+
+int rt_parse_args(struct rt_profile *rt, int *argc, char *argv[])
+{
+    static const struct { const char *opt, *key; int arg; } opts[] = {
+        { "--rt-cpus",        "cpus",        1 },
+        { "--rt-prio",        "prio",        1 },
+        { "--rt-mlock",       "mlock",       0 },
+        { "--rt-stack-kb",    "stack_kb",    1 },
+        { "--rt-interval-us", "interval_us", 1 },
+    };
+    int i, o, out = 1;
+
+    for (i = 1; i < *argc; i++) {
+        const char *a = argv[i];
+        int done = 0;
+
+        if (strncmp(a, "--rt-", 5) != 0) {
+            argv[out++] = argv[i];
+            continue;
+        }
+        if (strcmp(a, "--rt-config") == 0) {
+            if (i + 1 >= *argc || rt_load_config(rt, argv[++i]) < 0)
+                return -1;
+            continue;
+        }
+        if (strcmp(a, "--rt-selftest") == 0) {
+            /* 횟수는 생략 가능 */
+            if (i + 1 < *argc && argv[i + 1][0] >= '0' && argv[i + 1][0] <= '9')
+                done = set_key(rt, "selftest", argv[++i]) == 0;
+            else
+                done = set_key(rt, "selftest", NULL) == 0;
+            if (!done)
+                return -1;
+            continue;
+        }
+        for (o = 0; o < (int)(sizeof(opts) / sizeof(opts[0])); o++) {
+            if (strcmp(a, opts[o].opt) != 0)
+                continue;
+            if (opts[o].arg && i + 1 >= *argc)
+                return -1;
+            if (set_key(rt, opts[o].key, opts[o].arg ? argv[++i] : NULL) < 0)
+                return -1;
+            done = 1;
+            break;
+        }
+        if (!done) {
+            fprintf(stderr, "unknown option %s\n", a);
+            return -1;
+        }
+    }
+    argv[out] = NULL;
+    *argc = out;
+    return 0;
+}
+
+void rt_usage(FILE *fp)
+{
+    fprintf(fp, "  RT: [--rt-config file] [--rt-cpus 2-3] [--rt-prio 1..99] [--rt-mlock]\n"
+           "      [--rt-stack-kb kb] [--rt-selftest [n]] [--rt-interval-us us]\n");
+}
+
+/* "2,3" / "2-3" / "0,2-3" */
+static int parse_cpus(const char *s, cpu_set_t *set)
+{
+    CPU_ZERO(set);
+    while (*s) {
+        char *end;
+        long a = strtol(s, &end, 10), b;
+
+        if (end == s || a < 0 || a >= CPU_SETSIZE)
+            return -1;
+        b = a;
+        if (*end == '-') {
+            s = end + 1;
+            b = strtol(s, &end, 10);
+            if (end == s || b < a || b >= CPU_SETSIZE)
+                return -1;
+        }
+        for (; a <= b; a++)
+            CPU_SET(a, set);
+        if (*end == ',')
+            end++;
+        else if (*end)
+            return -1;
+        s = end;
+    }
+    return CPU_COUNT(set) ? 0 : -1;
+}
+
+/* 스택을 미리 건드려 제어 루프 중 page fault 가 나지 않게 한다 (mlockall 이후) */
+static void __attribute__((noinline)) prefault_stack(size_t bytes)
+{
+    volatile unsigned char *p = alloca(bytes);
+    size_t i;
+
+    for (i = 0; i < bytes; i += 4096)
+        p[i] = 0;
+}
+
+int rt_apply(const struct rt_profile *rt, const char *name)
+{
+    int ret = 0;
+
+    if (rt->cpus[0]) {
+        cpu_set_t set;
+
+        if (parse_cpus(rt->cpus, &set) < 0) {
+            fprintf(stderr, "[%s] rt: bad cpu list '%s'\n", name, rt->cpus);
+            ret = -1;
+        } else if (sched_setaffinity(0, sizeof(set), &set) < 0) {
+            fprintf(stderr, "[%s] rt: sched_setaffinity(%s): %s\n", name, rt->cpus, strerror(errno));
+            ret = -1;
+        }
+    }
+
+    if (rt->mlock) {
+        /* free() 가 힙을 OS 에 돌려주거나 큰 할당이 mmap 으로 가면 다시 fault 가 난다 */
+        mallopt(M_TRIM_THRESHOLD, -1);
+        mallopt(M_MMAP_MAX, 0);
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) < 0) {
+            fprintf(stderr, "[%s] rt: mlockall: %s\n", name, strerror(errno));
+            ret = -1;
+        } else if (rt->stack_kb) {
+            prefault_stack(rt->stack_kb * 1024);
+        }
+    }
+
+    if (rt->prio > 0) {
+        struct sched_param sp = { .sched_priority = rt->prio };
+
+        if (sched_setscheduler(0, SCHED_FIFO, &sp) < 0) {
+            fprintf(stderr, "[%s] rt: SCHED_FIFO %d: %s\n", name, rt->prio, strerror(errno));
+            ret = -1;
+        }
+    }
+
+    printf("[%s] rt: cpus %s, %s, mlock %s\n", name,
+           rt->cpus[0] ? rt->cpus : "all",
+           rt->prio > 0 ? "SCHED_FIFO" : "SCHED_OTHER",
+           rt->mlock ? "on" : "off");
+    if (rt->prio > 0)
+        printf("[%s] rt: priority %d\n", name, rt->prio);
+    return ret;
+}
+
+static int64_t ts_diff_ns(const struct timespec *a, const struct timespec *b)
+{
+    return (int64_t)(a->tv_sec - b->tv_sec) * 1000000000ll + (a->tv_nsec - b->tv_nsec);
+}
+
+static int cmp_i64(const void *a, const void *b)
+{
+    int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+    return (x > y) - (x < y);
+}
+
+void rt_selftest(const struct rt_profile *rt, const char *name)
+{
+    int n = rt->selftest, i;
+    int64_t *lat, sum = 0;
+    struct timespec next, now;
+
+    if (n <= 0)
+        return;
+    lat = malloc(sizeof(*lat) * n);
+    if (!lat)
+        return;
+
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    for (i = 0; i < n; i++) {
+        next.tv_nsec += rt->interval_us * 1000L;
+        while (next.tv_nsec >= 1000000000L) {
+            next.tv_sec++;
+            next.tv_nsec -= 1000000000L;
+        }
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR)
+            ;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        lat[i] = ts_diff_ns(&now, &next);
+        sum += lat[i];
+    }
+
+    qsort(lat, n, sizeof(*lat), cmp_i64);
+    printf("[%s] rt selftest: %d wakeups @ %d us\n", name, n, rt->interval_us);
+    printf("[%s]   latency us: min %.1f avg %.1f p50 %.1f p99 %.1f p99.9 %.1f max %.1f\n", name,
+           lat[0] / 1e3, sum / 1e3 / n, lat[n / 2] / 1e3,
+           lat[(int)(n * 0.99)] / 1e3, lat[(int)(n * 0.999)] / 1e3, lat[n - 1] / 1e3);
+    free(lat);
+}
@@ -0,0 +1,41 @@
+#ifndef RT_PROFILE_H
+#define RT_PROFILE_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+/*
+ * 데몬 공용 실시간 실행 설정.
+ * main() 첫머리에서 rt_parse_args() 로 --rt-* 옵션을 걷어 내고,
+ * 스레드를 만들기 전에 rt_apply() 를 부르면 이후 생성되는 스레드도
+ * 같은 affinity / 스케줄링 정책 / 메모리 잠금을 물려받는다.
+ *
+ *   --rt-config <file>    key=value 설정 파일 (아래 키, # 주석)
+ *   --rt-cpus <list>      cpus=2,3 또는 2-3
+ *   --rt-prio <1..99>     prio=   SCHED_FIFO 우선순위 (0 = SCHED_OTHER 유지)
+ *   --rt-mlock            mlock=1 mlockall + malloc trim 끔 + 스택 prefault
+ *   --rt-stack-kb <kb>    stack_kb=  prefault 할 스택 크기 (기본 256)
+ *   --rt-selftest [n]     selftest=n  제어 루프 전에 n 회 주기 wakeup 지연 측정
+ *   --rt-interval-us <us> interval_us=  self-test 주기 (기본 1000)
+ */
+struct rt_profile {
+    char   cpus[64];        /* 빈 문자열 = affinity 변경 안 함 */
+    int    prio;
+    int    mlock;
+    size_t stack_kb;
+    int    selftest;        /* 0 = 안 함 */
+    int    interval_us;
+};
+
+void rt_profile_init(struct rt_profile *rt);
+/* --rt-* 옵션을 처리하고 argv 에서 제거 (argc 갱신). 잘못된 값이면 -1 */
+int  rt_parse_args(struct rt_profile *rt, int *argc, char *argv[]);
+int  rt_load_config(struct rt_profile *rt, const char *path);
+/* 설정 적용 + 요약 출력. 권한 부족 등 실패는 경고만 하고 계속 (-1 반환) */
+int  rt_apply(const struct rt_profile *rt, const char *name);
+/* cyclictest 방식: 절대시각 clock_nanosleep 후 깨어난 지연의 분포 출력 */
+void rt_selftest(const struct rt_profile *rt, const char *name);
+/* 옵션 도움말 한 블록 */
+void rt_usage(FILE *fp);
+
+#endif // RT_PROFILE_H
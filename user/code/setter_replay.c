@@ -0,0 +1,212 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include "setter_replay.h"
+
+struct replay_entry {
+    uint64_t          t_ns;   /* 스크립트 시작 기준 시각 */
+    struct replay_cmd cmd;
+    int               line;
+};
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void sleep_until_ns(uint64_t t_ns)
+{
+    struct timespec ts = {
+        .tv_sec  = t_ns / 1000000000ull,
+        .tv_nsec = t_ns % 1000000000ull,
+    };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void replay_usage(const char *progname)
+{
+    fprintf(stderr,
+            "Usage: %s --replay [file|-] [--max-rate] [--repeat N]\n"
+            "  script line: [<time_ms>] <command>   (# 주석, 빈 줄 무시)\n"
+            "  --max-rate : 타임스탬프 무시, 최대 속도로 재생\n"
+            "  --repeat N : 스크립트를 N 회 반복\n", progname);
+}
+
+/* 스크립트 전체를 미리 파싱해 둔다 (재생 중에는 파싱 비용 없음) */
+static struct replay_entry *load_script(FILE *fp, replay_parse_fn parse, int *count)
+{
+    struct replay_entry *v = NULL;
+    int n = 0, cap = 0, lineno = 0;
+    uint64_t last_ns = 0;
+    char line[256];
+
+    while (fgets(line, sizeof(line), fp)) {
+        char *p = line, *end, *word;
+        double ms;
+
+        lineno++;
+        p[strcspn(p, "#\r\n")] = '\0';
+        while (*p == ' ' || *p == '\t')
+            p++;
+        if (*p == '\0')
+            continue;
+
+        ms = strtod(p, &end);
+        if (end != p && (*end == ' ' || *end == '\t')) {
+            if (ms < 0) {
+                fprintf(stderr, "line %d: negative timestamp\n", lineno);
+                goto fail;
+            }
+            last_ns = (uint64_t)(ms * 1000000.0);
+            p = end;
+        }
+        word = strtok(p, " \t");
+        if (!word)
+            continue;
+
+        if (n == cap) {
+            struct replay_entry *nv;
+            cap = cap ? cap * 2 : 256;
+            nv = realloc(v, cap * sizeof(*v));
+            if (!nv) {
+                perror("realloc");
+                goto fail;
+            }
+            v = nv;
+        }
+        if (parse(word, &v[n].cmd) < 0) {
+            fprintf(stderr, "line %d: unknown command '%s'\n", lineno, word);
+            goto fail;
+        }
+        v[n].t_ns = last_ns;
+        v[n].line = lineno;
+        n++;
+    }
+
+    *count = n;
+    return v;
+
+fail:
+    free(v);
+    return NULL;
+}
+
+int replay_main(const char *dev_path, int argc, char *argv[], replay_parse_fn parse)
+{
+    const char *progname = argv[0];
+    const char *path = "-";
+    int max_rate = 0, repeat = 1;
+    struct replay_entry *script;
+    uint64_t *lat, t0, t_end, sum = 0;
+    long total, done = 0, errors = 0;
+    int n, fd;
+    FILE *fp;
+
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--max-rate") == 0) {
+            max_rate = 1;
+        } else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = atoi(argv[++i]);
+            if (repeat < 1) {
+                replay_usage(progname);
+                return 1;
+            }
+        } else if (argv[i][0] != '-' || strcmp(argv[i], "-") == 0) {
+            path = argv[i];
+        } else {
+            replay_usage(progname);
+            return 1;
+        }
+    }
+
+    fp = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (!fp) {
+        perror(path);
+        return 1;
+    }
+    script = load_script(fp, parse, &n);
+    if (fp != stdin)
+        fclose(fp);
+    if (!script)
+        return 1;
+    if (n == 0) {
+        fprintf(stderr, "empty script\n");
+        free(script);
+        return 1;
+    }
+
+    total = (long)n * repeat;
+    lat = malloc(total * sizeof(*lat));
+    if (!lat) {
+        perror("malloc");
+        free(script);
+        return 1;
+    }
+
+    fd = open(dev_path, O_RDWR);
+    if (fd < 0) {
+        perror(dev_path);
+        free(lat);
+        free(script);
+        return 1;
+    }
+
+    t0 = now_ns();
+    for (int r = 0; r < repeat; r++) {
+        /* 반복마다 스크립트 마지막 시각만큼 밀어서 재생 */
+        uint64_t base = t0 + (uint64_t)r * script[n - 1].t_ns;
+
+        for (int i = 0; i < n; i++) {
+            struct replay_cmd c = script[i].cmd;
+            uint64_t a, b;
+
+            if (!max_rate)
+                sleep_until_ns(base + script[i].t_ns);
+
+            a = now_ns();
+            if (ioctl(fd, c.req, &c.val) < 0) {
+                if (errors++ < 10)
+                    fprintf(stderr, "line %d: ioctl: %s\n", script[i].line, strerror(errno));
+            }
+            b = now_ns();
+
+            lat[done++] = b - a;
+            sum += b - a;
+        }
+    }
+    t_end = now_ns();
+    close(fd);
+
+    qsort(lat, done, sizeof(*lat), cmp_u64);
+    {
+        double elapsed = (t_end - t0) / 1e9;
+
+        printf("[replay] %ld commands (%d x %d), %ld errors, %.3f s\n",
+               done, n, repeat, errors, elapsed);
+        printf("[replay] rate: %.1f cmd/s%s\n",
+               elapsed > 0 ? done / elapsed : 0.0, max_rate ? " (max-rate)" : "");
+        printf("[replay] ioctl latency us: min %.2f avg %.2f p50 %.2f p99 %.2f max %.2f\n",
+               lat[0] / 1e3, (double)sum / done / 1e3,
+               lat[done / 2] / 1e3, lat[(done * 99) / 100] / 1e3,
+               lat[done - 1] / 1e3);
+    }
+
+    free(lat);
+    free(script);
+    return errors ? 1 : 0;
+}
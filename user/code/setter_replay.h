@@ -0,0 +1,20 @@
+#ifndef SETTER_REPLAY_H
+#define SETTER_REPLAY_H
+
+/*
+ * *_setter 공용 batch/replay 모드.
+ * 장치를 한 번만 열어 두고 "<time_ms> <command>" 줄을 순서대로 ioctl로 재생한다.
+ */
+
+struct replay_cmd {
+    unsigned long req;   /* ioctl 번호 */
+    int           val;   /* ioctl 인자 (GET 이면 결과가 덮어써짐) */
+};
+
+/* command 단어를 ioctl로 변환. 성공 0, 모르는 단어면 -1 */
+typedef int (*replay_parse_fn)(const char *word, struct replay_cmd *out);
+
+/* argv[1] == "--replay" 인 경우 main 에서 호출. 종료 코드를 반환 */
+int replay_main(const char *dev_path, int argc, char *argv[], replay_parse_fn parse);
+
+#endif // SETTER_REPLAY_H
@@ -0,0 +1,359 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <ctype.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * sim/sim.sh 용 측정 도구. 실제 하드웨어 대신 시뮬레이션 쪽 끝점을 관찰한다.
+ *
+ *   spi   <fifo> <leds> <sec>               ambient_daemon 의 SPI 출력(FIFO)을 프레임 단위로 받아 FPS
+ *   pwm   <duty_cycle> <sec>                가짜 PWM 트리의 duty 파일을 샘플링해 갱신률/왕복 주기
+ *   edge  <pull> <pull-up|pull-down> <0|1> <value>...
+ *                                           gpio-sim 입력 pull 을 바꾼 시각부터 출력 value 들이
+ *                                           모두 기대값이 될 때까지 (예: 리미트 스위치 → 모터 정지)
+ *   wakeups <pid|comm> <sec>                프로세스 전체 스레드의 문맥 전환(= 잠에서 깬 횟수) / 초.
+ *                                           park 상태에서 데몬이 정말 멈췄는지 확인
+ *
+ * 결과는 한 줄 key=value 로 출력 (스크립트에서 비교).
+ */
+
+#define SPI_BYTES_PER_LED (3 * 24)
+#define PWM_SAMPLE_US     100
+#define PWM_MAX_CHANGES   200000
+#define EDGE_TIMEOUT_MS   1000
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/* WS281x SPI 인코딩(비트당 3바이트 1x0)을 한 바이트로 되돌림. 형식이 틀리면 -1 */
+static int decode_byte(const uint8_t *in)
+{
+    int v = 0;
+
+    for (int i = 0; i < 8; i++, in += 3) {
+        if (in[0] != 0xFF || in[2] != 0x00 || (in[1] != 0xFF && in[1] != 0x00))
+            return -1;
+        v = (v << 1) | (in[1] == 0xFF);
+    }
+    return v;
+}
+
+static int probe_spi(const char *path, int leds, int sec)
+{
+    size_t len = (size_t)leds * SPI_BYTES_PER_LED, got = 0;
+    uint8_t *frame = malloc(len);
+    uint64_t t_end, t_first = 0, t_last = 0, gap, gap_max = 0;
+    unsigned long frames = 0, bad = 0;
+    int fd, g = 0, r = 0, b = 0;
+
+    if (!frame)
+        return 1;
+    /* writer(daemon) 가 열 때까지 블록 */
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        free(frame);
+        return 1;
+    }
+    t_end = now_ns() + (uint64_t)sec * 1000000000ull;
+
+    while (now_ns() < t_end) {
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        ssize_t n;
+
+        if (poll(&pfd, 1, 100) <= 0)
+            continue;
+        n = read(fd, frame + got, len - got);
+        if (n <= 0)
+            break;      /* writer 종료 */
+        got += n;
+        if (got < len)
+            continue;
+        got = 0;
+
+        uint64_t t = now_ns();
+        if (frames++ == 0) {
+            t_first = t;
+        } else {
+            gap = t - t_last;
+            if (gap > gap_max)
+                gap_max = gap;
+        }
+        t_last = t;
+
+        g = decode_byte(frame);
+        r = decode_byte(frame + 24);
+        b = decode_byte(frame + 48);
+        if (g < 0 || r < 0 || b < 0 || decode_byte(frame + len - 24) < 0)
+            bad++;
+    }
+    close(fd);
+    free(frame);
+
+    printf("spi frames=%lu fps=%.2f interval_avg_ms=%.2f interval_max_ms=%.2f first_rgb=%02x%02x%02x bad=%lu\n",
+           frames,
+           frames > 1 ? (frames - 1) * 1e9 / (t_last - t_first) : 0.0,
+           frames > 1 ? (t_last - t_first) / 1e6 / (frames - 1) : 0.0,
+           gap_max / 1e6, r & 0xff, g & 0xff, b & 0xff, bad);
+    return 0;
+}
+
+struct pwm_change {
+    uint64_t t;
+    long     val;
+};
+
+static int probe_pwm(const char *path, int sec)
+{
+    struct pwm_change *ch = calloc(PWM_MAX_CHANGES, sizeof(*ch));
+    struct timespec next;
+    uint64_t t_end, p_sum = 0, p_max = 0, t_min_prev = 0;
+    long vmin = 0, vmax = 0, prev = -1;
+    int fd, n = 0, periods = 0;
+
+    if (!ch)
+        return 1;
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        free(ch);
+        return 1;
+    }
+    t_end = now_ns() + (uint64_t)sec * 1000000000ull;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    while (now_ns() < t_end && n < PWM_MAX_CHANGES) {
+        char buf[32];
+        ssize_t len = pread(fd, buf, sizeof(buf) - 1, 0);
+
+        if (len > 0) {
+            long v;
+            buf[len] = '\0';
+            v = strtol(buf, NULL, 10);
+            if (v != prev) {
+                ch[n].t = now_ns();
+                ch[n].val = v;
+                n++;
+                prev = v;
+            }
+        }
+        next.tv_nsec += PWM_SAMPLE_US * 1000L;
+        while (next.tv_nsec >= 1000000000L) {
+            next.tv_sec++;
+            next.tv_nsec -= 1000000000L;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+    }
+    close(fd);
+
+    /* 왕복 주기 = duty 가 최소값(0deg)으로 돌아온 간격 */
+    for (int i = 0; i < n; i++) {
+        if (i == 0 || ch[i].val < vmin)
+            vmin = ch[i].val;
+        if (i == 0 || ch[i].val > vmax)
+            vmax = ch[i].val;
+    }
+    for (int i = 0; i < n; i++) {
+        if (ch[i].val != vmin)
+            continue;
+        if (t_min_prev) {
+            uint64_t p = ch[i].t - t_min_prev;
+            p_sum += p;
+            if (p > p_max)
+                p_max = p;
+            periods++;
+        }
+        t_min_prev = ch[i].t;
+    }
+
+    printf("pwm changes=%d rate_hz=%.1f min=%ld max=%ld periods=%d period_avg_ms=%.1f period_max_ms=%.1f\n",
+           n, n / (double)sec, vmin, vmax, periods,
+           periods ? p_sum / 1e6 / periods : 0.0, p_max / 1e6);
+    free(ch);
+    return 0;
+}
+
+static int read_val(int fd)
+{
+    char c;
+    return pread(fd, &c, 1, 0) == 1 ? c - '0' : -1;
+}
+
+static int probe_edge(const char *pull, const char *dir, int expect, int nval, char **vals)
+{
+    int fds[8], pfd, ret = 1;
+    uint64_t t0, t;
+
+    if (nval > 8)
+        nval = 8;
+    for (int i = 0; i < nval; i++) {
+        fds[i] = open(vals[i], O_RDONLY);
+        if (fds[i] < 0) {
+            perror(vals[i]);
+            while (i-- > 0)
+                close(fds[i]);
+            return 1;
+        }
+    }
+    pfd = open(pull, O_WRONLY);
+    if (pfd < 0) {
+        perror(pull);
+        goto out;
+    }
+
+    t0 = now_ns();
+    if (write(pfd, dir, strlen(dir)) < 0) {
+        perror(pull);
+        close(pfd);
+        goto out;
+    }
+    close(pfd);
+
+    /* busy poll: sysfs read 한 번이 수 us 라 해상도로 충분 */
+    for (;;) {
+        int all = 1;
+
+        t = now_ns();
+        for (int i = 0; i < nval && all; i++)
+            all = read_val(fds[i]) == expect;
+        if (all) {
+            printf("edge latency_us=%.1f\n", (t - t0) / 1e3);
+            ret = 0;
+            break;
+        }
+        if (t - t0 > EDGE_TIMEOUT_MS * 1000000ull) {
+            printf("edge latency_us=timeout\n");
+            break;
+        }
+    }
+out:
+    for (int i = 0; i < nval; i++)
+        close(fds[i]);
+    return ret;
+}
+
+/* comm 이 같은 첫 프로세스. 숫자면 그대로 pid */
+static int find_pid(const char *arg)
+{
+    DIR *d;
+    struct dirent *e;
+    int pid = 0;
+
+    if (isdigit((unsigned char)arg[0]))
+        return atoi(arg);
+    d = opendir("/proc");
+    if (!d)
+        return 0;
+    while (!pid && (e = readdir(d))) {
+        char path[300], comm[32];
+        FILE *f;
+
+        if (!isdigit((unsigned char)e->d_name[0]))
+            continue;
+        snprintf(path, sizeof(path), "/proc/%s/comm", e->d_name);
+        f = fopen(path, "r");
+        if (!f)
+            continue;
+        if (fgets(comm, sizeof(comm), f)) {
+            comm[strcspn(comm, "\n")] = '\0';
+            if (strcmp(comm, arg) == 0)
+                pid = atoi(e->d_name);
+        }
+        fclose(f);
+    }
+    closedir(d);
+    return pid;
+}
+
+/* /proc/<pid>/task/<tid>/status 의 voluntary + nonvoluntary ctxt switch 합. 없으면 -1 */
+static long long ctxt_switches(int pid, int *threads)
+{
+    char path[300], line[128];
+    struct dirent *e;
+    long long sum = 0;
+    DIR *d;
+
+    snprintf(path, sizeof(path), "/proc/%d/task", pid);
+    d = opendir(path);
+    if (!d)
+        return -1;
+    *threads = 0;
+    while ((e = readdir(d))) {
+        FILE *f;
+
+        if (!isdigit((unsigned char)e->d_name[0]))
+            continue;
+        snprintf(path, sizeof(path), "/proc/%d/task/%s/status", pid, e->d_name);
+        f = fopen(path, "r");
+        if (!f)
+            continue;   /* 그 사이 끝난 스레드 */
+        while (fgets(line, sizeof(line), f)) {
+            long long v;
+
+            if (sscanf(line, "voluntary_ctxt_switches: %lld", &v) == 1 ||
+                sscanf(line, "nonvoluntary_ctxt_switches: %lld", &v) == 1)
+                sum += v;
+        }
+        fclose(f);
+        (*threads)++;
+    }
+    closedir(d);
+    return sum;
+}
+
+static int probe_wakeups(const char *who, int sec)
+{
+    int pid = find_pid(who), threads;
+    long long c0, c1;
+
+    c0 = pid > 0 ? ctxt_switches(pid, &threads) : -1;
+    if (c0 < 0) {
+        fprintf(stderr, "%s: no such process\n", who);
+        return 1;
+    }
+    sleep(sec);
+    c1 = ctxt_switches(pid, &threads);
+    if (c1 < 0) {
+        fprintf(stderr, "%s: exited\n", who);
+        return 1;
+    }
+    printf("wakeups pid=%d threads=%d switches=%lld per_sec=%.1f\n",
+           pid, threads, c1 - c0, (c1 - c0) / (double)sec);
+    return 0;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s spi <fifo> <leds> <sec>\n"
+            "       %s pwm <duty_cycle> <sec>\n"
+            "       %s edge <pull> <pull-up|pull-down> <0|1> <value>...\n"
+            "       %s wakeups <pid|comm> <sec>\n",
+            prog, prog, prog, prog);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc == 5 && strcmp(argv[1], "spi") == 0)
+        return probe_spi(argv[2], atoi(argv[3]), atoi(argv[4]));
+    if (argc == 4 && strcmp(argv[1], "pwm") == 0)
+        return probe_pwm(argv[2], atoi(argv[3]));
+    if (argc == 4 && strcmp(argv[1], "wakeups") == 0)
+        return probe_wakeups(argv[2], atoi(argv[3]));
+    if (argc >= 6 && strcmp(argv[1], "edge") == 0)
+        return probe_edge(argv[2], argv[3], atoi(argv[4]), argc - 5, argv + 5);
+    usage(argv[0]);
+    return 1;
+}
@@ -0,0 +1,447 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/types.h>
+
+/*
+ * ioctl 동시성 벤치마크: 장치마다 스레드 N 개가 각자 fd 를 열고 SET/GET 을
+ * 섞어 두드린다. 스레드 수별 ops/s 와 1 스레드 대비 배율, 그리고 GET 결과가
+ * SET 으로 쓸 수 있는 값이 아닌 경우(torn)를 센다.
+ *
+ * 액추에이터가 실제로 움직이므로 (wiper/aircon/headlamp, window 는 stop 만)
+ * 보드에서는 데몬을 멈추고 벤치 환경에서, 또는 sim/sim.sh up 상태에서 돌릴 것.
+ * 시작 시 상태를 저장했다가 끝나면 되돌린다.
+ */
+
+#define MAX_THREADS 64
+
+/* ===== ioctl 정의 (각 드라이버와 동일) ===== */
+#define WIPER_MAGIC 'W'
+#define WIPER_SET_MODE _IOW(WIPER_MAGIC, 1, int)
+#define WIPER_GET_MODE _IOR(WIPER_MAGIC, 2, int)
+
+#define AIRCON_MAGIC 'A'
+#define AIRCON_SET_LEVEL _IOW(AIRCON_MAGIC, 1, int)
+#define AIRCON_GET_LEVEL _IOR(AIRCON_MAGIC, 2, int)
+#define AIRCON_LEVEL_AUTO (-1)
+
+struct aircon_status {
+    __s32 level;
+    __s32 manual;
+    __u32 cool_state;
+    __u32 cur_state;
+    __u32 max_state;
+    __u32 duty_pct;
+    __s32 pwm_owned;
+    __s32 boosting;
+};
+#define AIRCON_GET_STATUS _IOR(AIRCON_MAGIC, 3, struct aircon_status)
+
+#define WINDOW_MAGIC 'M'
+#define WINDOW_SET_STATE _IOW(WINDOW_MAGIC, 0, int)
+#define WINDOW_GET_STATE _IOR(WINDOW_MAGIC, 1, int)
+
+#define HEADLAMP_MAGIC 'H'
+#define HEADLAMP_SET_STATE _IOW(HEADLAMP_MAGIC, 0, int)
+#define HEADLAMP_GET_STATE _IOR(HEADLAMP_MAGIC, 1, int)
+
+#define AMBIENT_MAGIC 'L'
+#define AMBIENT_SET_MODE        _IOW(AMBIENT_MAGIC, 1, char *)
+#define AMBIENT_GET_MODE        _IOR(AMBIENT_MAGIC, 2, char *)
+#define AMBIENT_SET_BRIGHTNESS  _IOW(AMBIENT_MAGIC, 3, int)
+#define AMBIENT_GET_BRIGHTNESS  _IOR(AMBIENT_MAGIC, 4, int)
+#define AMBIENT_MAX_ZONES  8
+
+struct ambient_zone {
+    __u16 first;
+    __u16 count;
+    __s32 brightness;
+    char  mode[16];
+};
+
+struct ambient_zone_arg {
+    __u32               id;
+    struct ambient_zone zone;
+};
+
+struct ambient_zones {
+    __u32               nr;
+    struct ambient_zone bg;
+    struct ambient_zone zone[AMBIENT_MAX_ZONES];
+};
+
+#define AMBIENT_SET_ZONE        _IOW(AMBIENT_MAGIC, 5, struct ambient_zone_arg)
+#define AMBIENT_GET_ZONE        _IOWR(AMBIENT_MAGIC, 6, struct ambient_zone_arg)
+#define AMBIENT_GET_ZONES       _IOR(AMBIENT_MAGIC, 7, struct ambient_zones)
+
+/*
+ * 벤치 전용 존: 끝쪽 LED 에 두어 실제 존과 겹치지 않게 하고,
+ * brightness == count, mode == bench_modes[count % N] 를 항상 같이 쓴다.
+ * GET_ZONES 스냅샷에서 이 관계가 깨지면 torn.
+ */
+#define BENCH_ZONE_ID     (AMBIENT_MAX_ZONES - 1)
+#define BENCH_ZONE_FIRST  4000
+
+static const char *const bench_modes[] = { "red", "magenta", "rainbow", "white" };
+#define NMODES (sizeof(bench_modes) / sizeof(bench_modes[0]))
+
+/* ===== 장치별 연산 ===== */
+
+struct bench_dev {
+    const char *name;
+    const char *path;
+    /* 반환: 0 정상, 1 torn, -1 ioctl 실패 */
+    int  (*set)(int fd, unsigned r);
+    int  (*get)(int fd, unsigned r);
+    int  (*save)(int fd);
+    void (*restore)(int fd, int saved);
+    int  saved;
+};
+
+static int int_set(int fd, unsigned long req, int val)
+{
+    return ioctl(fd, req, &val) < 0 ? -1 : 0;
+}
+
+/* GET 결과가 [lo, hi] 밖이면 torn */
+static int int_get(int fd, unsigned long req, int lo, int hi)
+{
+    int val = lo - 1;
+
+    if (ioctl(fd, req, &val) < 0)
+        return -1;
+    return val < lo || val > hi;
+}
+
+static int wiper_set(int fd, unsigned r) { return int_set(fd, WIPER_SET_MODE, r % 3); }
+static int wiper_get(int fd, unsigned r) { return int_get(fd, WIPER_GET_MODE, 0, 2); }
+
+static int aircon_set(int fd, unsigned r) { return int_set(fd, AIRCON_SET_LEVEL, r % 4); }
+static int aircon_get(int fd, unsigned r) { return int_get(fd, AIRCON_GET_LEVEL, 0, 3); }
+
+/* 창문은 움직이면 안 되므로 stop 만 */
+static int window_set(int fd, unsigned r) { return int_set(fd, WINDOW_SET_STATE, 0); }
+static int window_get(int fd, unsigned r) { return int_get(fd, WINDOW_GET_STATE, 0, 2); }
+
+static int headlamp_set(int fd, unsigned r) { return int_set(fd, HEADLAMP_SET_STATE, r & 1); }
+static int headlamp_get(int fd, unsigned r) { return int_get(fd, HEADLAMP_GET_STATE, 0, 1); }
+
+static int mode_known(const char *mode)
+{
+    for (unsigned i = 0; i < NMODES; i++)
+        if (strncmp(mode, bench_modes[i], 16) == 0)
+            return 1;
+    return 0;
+}
+
+static int ambient_set(int fd, unsigned r)
+{
+    switch (r % 3) {
+    case 0: {
+        char mode[16] = { 0 };
+        strcpy(mode, bench_modes[(r / 3) % NMODES]);
+        return ioctl(fd, AMBIENT_SET_MODE, mode) < 0 ? -1 : 0;
+    }
+    case 1:
+        return int_set(fd, AMBIENT_SET_BRIGHTNESS, (r / 3) % 101);
+    default: {
+        struct ambient_zone_arg za = { .id = BENCH_ZONE_ID };
+        za.zone.first = BENCH_ZONE_FIRST;
+        za.zone.count = 1 + (r / 3) % 90;
+        za.zone.brightness = za.zone.count;
+        strcpy(za.zone.mode, bench_modes[za.zone.count % NMODES]);
+        return ioctl(fd, AMBIENT_SET_ZONE, &za) < 0 ? -1 : 0;
+    }
+    }
+}
+
+static int ambient_get(int fd, unsigned r)
+{
+    if (r & 1) {
+        /* 데몬의 프레임 경로와 같은 스냅샷 */
+        struct ambient_zones st;
+        const struct ambient_zone *z = &st.zone[BENCH_ZONE_ID];
+
+        if (ioctl(fd, AMBIENT_GET_ZONES, &st) < 0)
+            return -1;
+        if (!mode_known(st.bg.mode) || st.bg.brightness < 0 || st.bg.brightness > 100)
+            return 1;
+        return z->count && (z->brightness != z->count ||
+                            strcmp(z->mode, bench_modes[z->count % NMODES]) != 0);
+    } else {
+        char mode[16];
+
+        if (ioctl(fd, AMBIENT_GET_MODE, mode) < 0)
+            return -1;
+        return !mode_known(mode);
+    }
+}
+
+/* ===== 상태 저장/복원 ===== */
+
+static int wiper_save(int fd) { int v = 0; ioctl(fd, WIPER_GET_MODE, &v); return v; }
+static int window_save(int fd) { return 0; }
+static int headlamp_save(int fd) { int v = 0; ioctl(fd, HEADLAMP_GET_STATE, &v); return v; }
+
+static int aircon_save(int fd)
+{
+    struct aircon_status st;
+
+    if (ioctl(fd, AIRCON_GET_STATUS, &st) < 0)
+        return AIRCON_LEVEL_AUTO;
+    return st.manual ? st.level : AIRCON_LEVEL_AUTO;
+}
+
+static char ambient_saved_mode[16];
+static struct ambient_zone_arg ambient_saved_zone = { .id = BENCH_ZONE_ID };
+
+static int ambient_save(int fd)
+{
+    char mode[16] = "red";
+    int b = 50;
+
+    ioctl(fd, AMBIENT_GET_MODE, ambient_saved_mode);
+    ioctl(fd, AMBIENT_GET_BRIGHTNESS, &b);
+    ioctl(fd, AMBIENT_GET_ZONE, &ambient_saved_zone);
+    /* 배경 모드 검사는 벤치 모드 목록 기준 */
+    if (!ambient_saved_zone.zone.count)
+        ioctl(fd, AMBIENT_SET_MODE, mode);
+    /* 벤치 존 자리가 이미 쓰이고 있으면 0 이 아님 → 벤치 거부 */
+    return b | (ambient_saved_zone.zone.count ? 0x10000 : 0);
+}
+
+static void wiper_restore(int fd, int saved) { int_set(fd, WIPER_SET_MODE, saved); }
+static void aircon_restore(int fd, int saved) { int_set(fd, AIRCON_SET_LEVEL, saved); }
+static void window_restore(int fd, int saved) { }
+static void headlamp_restore(int fd, int saved) { int_set(fd, HEADLAMP_SET_STATE, saved); }
+
+static void ambient_restore(int fd, int saved)
+{
+    ioctl(fd, AMBIENT_SET_MODE, ambient_saved_mode);
+    int_set(fd, AMBIENT_SET_BRIGHTNESS, saved & 0xffff);
+    ambient_saved_zone.zone.count = 0;
+    ioctl(fd, AMBIENT_SET_ZONE, &ambient_saved_zone);
+}
+
+static struct bench_dev devs[] = {
+    { "wiper",    "/dev/wiper_dev",    wiper_set,    wiper_get,    wiper_save,    wiper_restore },
+    { "aircon",   "/dev/aircon_dev",   aircon_set,   aircon_get,   aircon_save,   aircon_restore },
+    { "window",   "/dev/window_dev",   window_set,   window_get,   window_save,   window_restore },
+    { "headlamp", "/dev/headlamp_dev", headlamp_set, headlamp_get, headlamp_save, headlamp_restore },
+    { "ambient",  "/dev/ambient_dev",  ambient_set,  ambient_get,  ambient_save,  ambient_restore },
+};
+#define NDEVS (sizeof(devs) / sizeof(devs[0]))
+
+/* ===== 실행 ===== */
+
+struct worker {
+    pthread_t          tid;
+    struct bench_dev  *dev;
+    int                fd;
+    unsigned           seed;
+    unsigned long      ops, torn, errors;
+} __attribute__((aligned(64)));
+
+static struct worker workers[MAX_THREADS];
+static atomic_int go, stop;
+static int write_pct = 10;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void *worker_fn(void *arg)
+{
+    struct worker *w = arg;
+
+    while (!atomic_load_explicit(&go, memory_order_acquire))
+        ;
+    while (!atomic_load_explicit(&stop, memory_order_relaxed)) {
+        unsigned r = rand_r(&w->seed);
+        int ret = (int)(r % 100) < write_pct ? w->dev->set(w->fd, r >> 7)
+                                             : w->dev->get(w->fd, r >> 7);
+        w->ops++;
+        if (ret > 0)
+            w->torn++;
+        else if (ret < 0)
+            w->errors++;
+    }
+    return NULL;
+}
+
+/* 스레드 n 개로 sec 초. 반환 ops/s, torn/errors 는 합산 */
+static double run_one(struct bench_dev *dev, int n, double sec,
+                      unsigned long *torn, unsigned long *errors)
+{
+    unsigned long ops = 0;
+    uint64_t t0, t1;
+    int i;
+
+    atomic_store(&go, 0);
+    atomic_store(&stop, 0);
+    for (i = 0; i < n; i++) {
+        struct worker *w = &workers[i];
+
+        memset(w, 0, sizeof(*w));
+        w->dev = dev;
+        w->seed = 0x9e3779b9u * (i + 1);
+        w->fd = open(dev->path, O_RDWR);
+        if (w->fd < 0 || pthread_create(&w->tid, NULL, worker_fn, w) != 0) {
+            perror(dev->path);
+            if (w->fd >= 0)
+                close(w->fd);
+            n = i;
+            break;
+        }
+    }
+    if (n == 0)
+        return -1;
+
+    t0 = now_ns();
+    atomic_store_explicit(&go, 1, memory_order_release);
+    usleep((useconds_t)(sec * 1e6));
+    atomic_store(&stop, 1);
+    for (i = 0; i < n; i++)
+        pthread_join(workers[i].tid, NULL);
+    t1 = now_ns();
+
+    *torn = *errors = 0;
+    for (i = 0; i < n; i++) {
+        ops += workers[i].ops;
+        *torn += workers[i].torn;
+        *errors += workers[i].errors;
+        close(workers[i].fd);
+    }
+    return ops * 1e9 / (t1 - t0);
+}
+
+static int parse_threads(const char *s, int *out, int max)
+{
+    char buf[128], *tok, *save;
+    int n = 0;
+
+    snprintf(buf, sizeof(buf), "%s", s);
+    for (tok = strtok_r(buf, ",", &save); tok && n < max; tok = strtok_r(NULL, ",", &save)) {
+        int v = atoi(tok);
+        if (v < 1 || v > MAX_THREADS)
+            return -1;
+        out[n++] = v;
+    }
+    return n;
+}
+
+/* /sys/class/topst/<장치>/mailbox/ 카운터. 없으면 (mailbox 미사용 장치/구 드라이버) -1 */
+static const char *const mbox_keys[] = { "posted", "applied", "coalesced", "redundant" };
+#define NMBOX (sizeof(mbox_keys) / sizeof(mbox_keys[0]))
+
+static int read_mbox(const struct bench_dev *dev, long long *v)
+{
+    for (unsigned k = 0; k < NMBOX; k++) {
+        char path[128];
+        FILE *f;
+
+        snprintf(path, sizeof(path), "/sys/class/topst/%s/mailbox/%s",
+                 strrchr(dev->path, '/') + 1, mbox_keys[k]);
+        f = fopen(path, "r");
+        if (!f)
+            return -1;
+        if (fscanf(f, "%lld", &v[k]) != 1)
+            v[k] = 0;
+        fclose(f);
+    }
+    return 0;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [--dev wiper|aircon|window|headlamp|ambient|all] [--threads 1,2,4,8]\n"
+            "          [--seconds 2] [--write-pct 10]\n",
+            prog);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *only = "all";
+    int threads[16] = { 1, 2, 4, 8 }, nthreads = 4, fail = 0;
+    double sec = 2.0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--dev") == 0 && i + 1 < argc) {
+            only = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            nthreads = parse_threads(argv[++i], threads, 16);
+            if (nthreads <= 0) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            sec = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--write-pct") == 0 && i + 1 < argc) {
+            write_pct = atoi(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    printf("%-9s %7s %12s %8s %8s %8s\n", "device", "threads", "ops/s", "scale", "torn", "errors");
+    for (unsigned d = 0; d < NDEVS; d++) {
+        struct bench_dev *dev = &devs[d];
+        double base = 0;
+        int fd;
+
+        if (strcmp(only, "all") && strcmp(only, dev->name))
+            continue;
+        fd = open(dev->path, O_RDWR);
+        if (fd < 0) {
+            printf("%-9s (skip: %s)\n", dev->name, strerror(errno));
+            continue;
+        }
+        dev->saved = dev->save(fd);
+        if (dev->save == ambient_save && (dev->saved & 0x10000)) {
+            printf("%-9s (skip: zone %d in use)\n", dev->name, BENCH_ZONE_ID);
+            close(fd);
+            continue;
+        }
+
+        long long mb0[NMBOX], mb1[NMBOX];
+        int has_mbox = read_mbox(dev, mb0) == 0;
+
+        for (int t = 0; t < nthreads; t++) {
+            unsigned long torn, errors;
+            double ops = run_one(dev, threads[t], sec, &torn, &errors);
+
+            if (ops < 0)
+                break;
+            if (t == 0)
+                base = ops;
+            printf("%-9s %7d %12.0f %7.2fx %8lu %8lu\n", dev->name, threads[t], ops,
+                   base > 0 ? ops / base : 0.0, torn, errors);
+            if (torn)
+                fail = 1;
+        }
+        /* SET 폭주 중 실제로 적용된 것과 합쳐지거나 무시된 것 */
+        if (has_mbox && read_mbox(dev, mb1) == 0) {
+            printf("%-9s mailbox:", dev->name);
+            for (unsigned k = 0; k < NMBOX; k++)
+                printf(" %s %lld", mbox_keys[k], mb1[k] - mb0[k]);
+            printf("\n");
+        }
+        dev->restore(fd, dev->saved);
+        close(fd);
+    }
+    return fail;
+}
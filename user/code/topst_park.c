@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include "topst_park.h"
+
+static const char *const park_names[] = {
+    [PARK_ACTIVE]    = "active",
+    [PARK_PARKING]   = "parking",
+    [PARK_PARKED]    = "parked",
+    [PARK_SUSPENDED] = "suspended",
+};
+
+const char *park_name(int state)
+{
+    return state >= 0 && state <= PARK_SUSPENDED ? park_names[state] : "?";
+}
+
+int park_open(struct topst_park *p, const char *name)
+{
+    char path[128];
+
+    snprintf(path, sizeof(path), "/sys/class/topst/%s/park/state", name);
+    p->fd = open(path, O_RDWR | O_CLOEXEC);
+    p->state = PARK_ACTIVE;
+    if (p->fd >= 0)
+        park_state(p);
+    return p->fd;
+}
+
+void park_close(struct topst_park *p)
+{
+    if (p->fd >= 0)
+        close(p->fd);
+    p->fd = -1;
+}
+
+int park_state(struct topst_park *p)
+{
+    char buf[16];
+    ssize_t n;
+
+    if (p->fd < 0)
+        return p->state = PARK_ACTIVE;
+    n = pread(p->fd, buf, sizeof(buf) - 1, 0);
+    if (n <= 0)
+        return p->state;
+    buf[n] = '\0';
+    buf[strcspn(buf, "\n")] = '\0';
+    for (int i = 0; i <= PARK_SUSPENDED; i++) {
+        if (strcmp(buf, park_names[i]) == 0) {
+            p->state = i;
+            break;
+        }
+    }
+    return p->state;
+}
+
+int park_ack(struct topst_park *p)
+{
+    if (p->fd < 0)
+        return 0;
+    if (pwrite(p->fd, "parked", 6, 0) < 0) {
+        perror("park ack");
+        return -1;
+    }
+    return park_state(p);
+}
+
+int park_wait(struct topst_park *p, int timeout_ms)
+{
+    struct pollfd pfd = { .fd = p->fd, .events = POLLPRI | POLLERR };
+
+    if (p->fd < 0) {
+        /* 바뀔 상태가 없으니 그냥 잠 */
+        if (timeout_ms > 0)
+            usleep(timeout_ms * 1000);
+        return p->state = PARK_ACTIVE;
+    }
+    /* sysfs 는 마지막 read 이후 notify 가 있을 때만 POLLPRI: 없으면 다시 읽을 필요 없음 */
+    if (poll(&pfd, 1, timeout_ms) <= 0)
+        return p->state;
+    return park_state(p);
+}
@@ -0,0 +1,37 @@
+#ifndef TOPST_PARK_H
+#define TOPST_PARK_H
+
+/*
+ * 데몬 공용: /sys/class/topst/<장치>/park/state 를 따라 루프를 얼린다.
+ *
+ *   active     평소대로 구동
+ *   parking    시스템 suspend 직전. 하드웨어를 안전 위치에 둔 뒤 park_ack()
+ *   parked     ack 완료 (커널이 suspend 진행)
+ *   suspended  장치가 runtime/시스템 suspend. 구동을 멈추고 active 까지 잠듦
+ *
+ * 상태가 바뀌면 드라이버가 sysfs_notify 하므로 POLLPRI 로 깨어난다.
+ * park/ 가 없는 (PM 미지원) 드라이버면 fd = -1 이고 항상 active 로 본다.
+ */
+#define PARK_ACTIVE    0
+#define PARK_PARKING   1
+#define PARK_PARKED    2
+#define PARK_SUSPENDED 3
+
+struct topst_park {
+    int fd;
+    int state;      /* 마지막으로 읽은 PARK_* */
+};
+
+/* name: "wiper_dev" 등 /dev 노드 이름 */
+int  park_open(struct topst_park *p, const char *name);
+void park_close(struct topst_park *p);
+/* 다시 읽어 p->state 갱신 (poll 재무장 포함) */
+int  park_state(struct topst_park *p);
+/* "parked" 기록. parking 이 아니면 커널이 무시 */
+int  park_ack(struct topst_park *p);
+/* 최대 timeout_ms (-1 = 무한) 동안 상태 변화를 기다림. 시그널이면 바로 돌아옴.
+ * park/ 가 없으면 timeout_ms 만큼 잠만 잠 (폴링 주기 대용) */
+int  park_wait(struct topst_park *p, int timeout_ms);
+const char *park_name(int state);
+
+#endif // TOPST_PARK_H
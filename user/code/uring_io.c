@@ -0,0 +1,211 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "uring_io.h"
+
+#ifdef __NR_io_uring_setup
+#include <linux/io_uring.h>
+
+static int sys_setup(unsigned entries, struct io_uring_params *p)
+{
+    return syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int sys_enter(int fd, unsigned submit, unsigned min_complete, unsigned flags)
+{
+    return syscall(__NR_io_uring_enter, fd, submit, min_complete, flags, NULL, 0);
+}
+
+static int sys_register(int fd, unsigned op, const void *arg, unsigned nr)
+{
+    return syscall(__NR_io_uring_register, fd, op, arg, nr);
+}
+
+int uring_init(struct uring_io *u, unsigned entries)
+{
+    struct io_uring_params p;
+    int single = 0;
+    int fd;
+
+    memset(u, 0, sizeof(*u));
+    u->ring_fd = -1;
+
+    if (getenv("TOPST_NO_URING")) {
+        errno = ENOSYS;
+        return -1;
+    }
+
+    memset(&p, 0, sizeof(p));
+    fd = sys_setup(entries, &p);
+    if (fd < 0)
+        return -1;
+
+    u->sq_sz = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    u->cq_sz = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+#ifdef IORING_FEAT_SINGLE_MMAP
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        single = 1;
+        if (u->cq_sz > u->sq_sz)
+            u->sq_sz = u->cq_sz;
+        u->cq_sz = u->sq_sz;
+    }
+#endif
+
+    u->sq_ptr = mmap(NULL, u->sq_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     fd, IORING_OFF_SQ_RING);
+    if (u->sq_ptr == MAP_FAILED)
+        goto fail;
+    if (single) {
+        u->cq_ptr = u->sq_ptr;
+    } else {
+        u->cq_ptr = mmap(NULL, u->cq_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         fd, IORING_OFF_CQ_RING);
+        if (u->cq_ptr == MAP_FAILED)
+            goto fail_sq;
+    }
+    u->sqes_sz = p.sq_entries * sizeof(struct io_uring_sqe);
+    u->sqes = mmap(NULL, u->sqes_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   fd, IORING_OFF_SQES);
+    if (u->sqes == MAP_FAILED)
+        goto fail_cq;
+
+    u->sq_head  = (unsigned *)((char *)u->sq_ptr + p.sq_off.head);
+    u->sq_tail  = (unsigned *)((char *)u->sq_ptr + p.sq_off.tail);
+    u->sq_mask  = (unsigned *)((char *)u->sq_ptr + p.sq_off.ring_mask);
+    u->sq_array = (unsigned *)((char *)u->sq_ptr + p.sq_off.array);
+    u->cq_head  = (unsigned *)((char *)u->cq_ptr + p.cq_off.head);
+    u->cq_tail  = (unsigned *)((char *)u->cq_ptr + p.cq_off.tail);
+    u->cq_mask  = (unsigned *)((char *)u->cq_ptr + p.cq_off.ring_mask);
+    u->cqes     = (struct io_uring_cqe *)((char *)u->cq_ptr + p.cq_off.cqes);
+    u->entries  = p.sq_entries;
+    u->ring_fd  = fd;
+    return 0;
+
+fail_cq:
+    if (!single)
+        munmap(u->cq_ptr, u->cq_sz);
+fail_sq:
+    munmap(u->sq_ptr, u->sq_sz);
+fail:
+    close(fd);
+    return -1;
+}
+
+void uring_exit(struct uring_io *u)
+{
+    if (u->ring_fd < 0)
+        return;
+    munmap(u->sqes, u->sqes_sz);
+    if (u->cq_ptr != u->sq_ptr)
+        munmap(u->cq_ptr, u->cq_sz);
+    munmap(u->sq_ptr, u->sq_sz);
+    close(u->ring_fd);
+    u->ring_fd = -1;
+}
+
+int uring_register_files(struct uring_io *u, const int *fds, unsigned n)
+{
+    sys_register(u->ring_fd, IORING_UNREGISTER_FILES, NULL, 0);
+    return sys_register(u->ring_fd, IORING_REGISTER_FILES, fds, n);
+}
+
+int uring_register_buffers(struct uring_io *u, const struct iovec *iov, unsigned n)
+{
+    sys_register(u->ring_fd, IORING_UNREGISTER_BUFFERS, NULL, 0);
+    return sys_register(u->ring_fd, IORING_REGISTER_BUFFERS, iov, n);
+}
+
+int uring_queue_write(struct uring_io *u, int file_idx, int buf_idx,
+                      const void *buf, unsigned len, int link)
+{
+    unsigned tail = *u->sq_tail;
+    unsigned idx;
+    struct io_uring_sqe *sqe;
+
+    if (tail - __atomic_load_n(u->sq_head, __ATOMIC_ACQUIRE) >= u->entries) {
+        errno = EBUSY;
+        return -1;
+    }
+
+    idx = tail & *u->sq_mask;
+    sqe = &u->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode    = IORING_OP_WRITE_FIXED;
+    sqe->flags     = IOSQE_FIXED_FILE | (link ? IOSQE_IO_LINK : 0);
+    sqe->fd        = file_idx;
+    sqe->addr      = (unsigned long)buf;
+    sqe->len       = len;
+    sqe->off       = 0;
+    sqe->buf_index = buf_idx;
+    sqe->user_data = u->queued;
+    u->sq_array[idx] = idx;
+
+    __atomic_store_n(u->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    u->queued++;
+    return 0;
+}
+
+int uring_submit_wait(struct uring_io *u)
+{
+    unsigned n = u->queued, submitted = 0, reaped = 0;
+    int err = 0;
+
+    if (n == 0)
+        return 0;
+    u->queued = 0;
+
+    /* 보통은 여기서 제출 + 전체 완료 대기가 한 번에 끝난다 */
+    while (submitted < n) {
+        int ret = sys_enter(u->ring_fd, n - submitted, n - submitted, IORING_ENTER_GETEVENTS);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            return -errno;
+        }
+        submitted += ret;
+    }
+
+    while (reaped < n) {
+        unsigned head = *u->cq_head;
+
+        if (head == __atomic_load_n(u->cq_tail, __ATOMIC_ACQUIRE)) {
+            if (sys_enter(u->ring_fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+                return -errno;
+            continue;
+        }
+        /* link 로 취소된 op 의 -ECANCELED 보다 실제 원인을 우선 */
+        if (u->cqes[head & *u->cq_mask].res < 0 && (err == 0 || err == -ECANCELED))
+            err = u->cqes[head & *u->cq_mask].res;
+        __atomic_store_n(u->cq_head, head + 1, __ATOMIC_RELEASE);
+        reaped++;
+    }
+    return err;
+}
+
+#else /* io_uring 헤더/시스템콜 없음 */
+
+int uring_init(struct uring_io *u, unsigned entries)
+{
+    memset(u, 0, sizeof(*u));
+    u->ring_fd = -1;
+    errno = ENOSYS;
+    return -1;
+}
+
+void uring_exit(struct uring_io *u) { }
+int uring_register_files(struct uring_io *u, const int *fds, unsigned n) { errno = ENOSYS; return -1; }
+int uring_register_buffers(struct uring_io *u, const struct iovec *iov, unsigned n) { errno = ENOSYS; return -1; }
+int uring_queue_write(struct uring_io *u, int file_idx, int buf_idx,
+                      const void *buf, unsigned len, int link) { errno = ENOSYS; return -1; }
+int uring_submit_wait(struct uring_io *u) { return -ENOSYS; }
+
+#endif
+
+int uring_available(const struct uring_io *u)
+{
+    return u->ring_fd >= 0;
+}
@@ -0,0 +1,40 @@
+#ifndef URING_IO_H
+#define URING_IO_H
+
+#include <stddef.h>
+#include <sys/uio.h>
+
+/*
+ * liburing 없이 쓰는 최소 io_uring 래퍼.
+ * 등록된 fd/버퍼에 대한 WRITE_FIXED 만 지원 (커널 5.4 에서 동작하는 범위).
+ * uring_init() 이 실패하면 호출자는 일반 write 경로로 돌아가면 된다.
+ * 환경변수 TOPST_NO_URING 이 있으면 항상 실패 (비교 측정용).
+ */
+struct uring_io {
+    int                  ring_fd;
+    unsigned             entries;
+    unsigned             queued;
+    unsigned            *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned            *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void                *sq_ptr, *cq_ptr;
+    size_t               sq_sz, cq_sz, sqes_sz;
+};
+
+int  uring_init(struct uring_io *u, unsigned entries);
+void uring_exit(struct uring_io *u);
+int  uring_available(const struct uring_io *u);
+
+/* 다시 호출하면 기존 등록을 해제하고 새로 등록 */
+int  uring_register_files(struct uring_io *u, const int *fds, unsigned n);
+int  uring_register_buffers(struct uring_io *u, const struct iovec *iov, unsigned n);
+
+/* 등록 file/buffer index 로 offset 0 write 1개 큐잉. link 면 다음 SQE 와 순서 연결 */
+int  uring_queue_write(struct uring_io *u, int file_idx, int buf_idx,
+                       const void *buf, unsigned len, int link);
+/* 큐잉된 SQE 를 io_uring_enter 한 번으로 제출하고 모두 완료될 때까지 대기.
+ * 실패한 op 가 있으면 첫 번째 음수 errno 반환 */
+int  uring_submit_wait(struct uring_io *u);
+
+#endif // URING_IO_H
@@ -0,0 +1,247 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include "vehicle.h"
+
+#ifndef VEHICLE_DEFAULT_FILE
+#define VEHICLE_DEFAULT_FILE "variants/topst-d3g.conf"
+#endif
+
+#ifdef VEHICLE_RUNTIME
+struct vehicle vehicle;
+#endif
+
+static int parse_int(const char *val, int *out)
+{
+    char *end;
+    long v = strtol(val, &end, 0);
+
+    if (end == val || *end)
+        return -1;
+    *out = v;
+    return 0;
+}
+
+/* 생성 헤더에 그대로 문자열로 들어가므로 따옴표/역슬래시는 받지 않음 */
+static int copy_str(char *dst, size_t size, const char *val)
+{
+    if (strlen(val) >= size || strpbrk(val, "\"\\"))
+        return -1;
+    strcpy(dst, val);
+    return 0;
+}
+
+/* "a,b,c,d" → n 개 */
+static int parse_list(const char *val, int *out, int n)
+{
+    char buf[64], *tok, *save;
+    int i = 0;
+
+    if (strlen(val) >= sizeof(buf))
+        return -1;
+    strcpy(buf, val);
+    for (tok = strtok_r(buf, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+        if (i >= n || parse_int(tok, &out[i++]) < 0)
+            return -1;
+    }
+    return i == n ? 0 : -1;
+}
+
+/* "name:first:count" */
+static int parse_zone(struct vehicle *v, const char *val)
+{
+    struct veh_zone *z;
+    char name[sizeof(z->name)];
+    int first, count;
+
+    if (v->ambient.nzone >= VEH_MAX_ZONES ||
+        sscanf(val, "%15[^:]:%d:%d", name, &first, &count) != 3 ||
+        first < 0 || count <= 0 || strpbrk(name, "\"\\"))
+        return -1;
+    z = &v->ambient.zone[v->ambient.nzone++];
+    strcpy(z->name, name);
+    z->first = first;
+    z->count = count;
+    return 0;
+}
+
+static int set_key(struct vehicle *v, const char *key, const char *val)
+{
+    static const struct { const char *key; size_t off; } ints[] = {
+        { "wiper.period_ns",    offsetof(struct vehicle, wiper.period_ns) },
+        { "wiper.duty_min_ns",  offsetof(struct vehicle, wiper.duty_min_ns) },
+        { "wiper.duty_max_ns",  offsetof(struct vehicle, wiper.duty_max_ns) },
+        { "wiper.angle_min",    offsetof(struct vehicle, wiper.angle_min) },
+        { "wiper.angle_max",    offsetof(struct vehicle, wiper.angle_max) },
+        { "wiper.park_angle",   offsetof(struct vehicle, wiper.park_angle) },
+        { "wiper.fast_step_us", offsetof(struct vehicle, wiper.fast_step_us) },
+        { "wiper.slow_step_us", offsetof(struct vehicle, wiper.slow_step_us) },
+        { "aircon.period_ns",   offsetof(struct vehicle, aircon.period_ns) },
+        { "aircon.boost_pct",   offsetof(struct vehicle, aircon.boost_pct) },
+        { "aircon.boost_ms",    offsetof(struct vehicle, aircon.boost_ms) },
+        { "ambient.leds",       offsetof(struct vehicle, ambient.leds) },
+        { "ambient.spi_hz",     offsetof(struct vehicle, ambient.spi_hz) },
+    };
+
+    if (!val)
+        return -1;
+    for (unsigned i = 0; i < sizeof(ints) / sizeof(ints[0]); i++)
+        if (strcmp(key, ints[i].key) == 0)
+            return parse_int(val, (int *)((char *)v + ints[i].off));
+
+    if (strcmp(key, "name") == 0)
+        return copy_str(v->name, sizeof(v->name), val);
+    if (strcmp(key, "wiper.chan") == 0) {
+        if (v->wiper.nchan >= VEH_MAX_WIPERS)
+            return -1;
+        return copy_str(v->wiper.chan[v->wiper.nchan++], VEH_SPEC_LEN, val);
+    }
+    if (strcmp(key, "aircon.pwm") == 0)
+        return sscanf(val, "%d:%d", &v->aircon.pwm_chip, &v->aircon.pwm_channel) == 2 ? 0 : -1;
+    if (strcmp(key, "aircon.duty_pct") == 0)
+        return parse_list(val, v->aircon.duty_pct, VEH_AIRCON_LEVELS);
+    if (strcmp(key, "ambient.spi") == 0) {
+        if (v->ambient.nspi >= VEH_MAX_SPI)
+            return -1;
+        return copy_str(v->ambient.spi[v->ambient.nspi++], VEH_SPEC_LEN, val);
+    }
+    if (strcmp(key, "ambient.zone") == 0)
+        return parse_zone(v, val);
+    return -1;
+}
+
+static int angle_to_duty(const struct vehicle *v, int angle)
+{
+    return v->wiper.duty_min_ns + (v->wiper.duty_max_ns - v->wiper.duty_min_ns) * angle / 180;
+}
+
+/* 값 검사 + 파생 테이블. 문제가 있으면 메시지 출력 후 -1 */
+static int derive(struct vehicle *v, const char *path)
+{
+    int h = v->wiper.angle_max - v->wiper.angle_min;
+
+    if (v->wiper.nchan == 0 || v->wiper.period_ns <= 0 ||
+        v->wiper.angle_min < 0 || v->wiper.angle_max > 180 || h <= 0 ||
+        v->wiper.park_angle < 0 || v->wiper.park_angle > 180 ||
+        v->wiper.fast_step_us <= 0 || v->wiper.slow_step_us <= 0) {
+        fprintf(stderr, "%s: wiper.* 가 없거나 범위 밖\n", path);
+        return -1;
+    }
+    if (v->aircon.period_ns <= 0 || v->aircon.boost_pct < 0 || v->aircon.boost_pct > 100) {
+        fprintf(stderr, "%s: aircon.* 가 없거나 범위 밖\n", path);
+        return -1;
+    }
+    if (v->ambient.leds <= 0 || v->ambient.leds > VEH_LEDS_LIMIT || v->ambient.nspi == 0) {
+        fprintf(stderr, "%s: ambient.leds (1~%d) / ambient.spi 필요\n", path, VEH_LEDS_LIMIT);
+        return -1;
+    }
+    for (int i = 0; i < v->ambient.nzone; i++) {
+        if (v->ambient.zone[i].first + v->ambient.zone[i].count > v->ambient.leds) {
+            fprintf(stderr, "%s: zone %s 가 LED %d 개를 넘음\n", path,
+                    v->ambient.zone[i].name, v->ambient.leds);
+            return -1;
+        }
+    }
+
+    /* 와이퍼: angle_min → angle_max → angle_min 을 1 도 / step 으로 */
+    v->wiper.cycle_steps = 2 * h;
+    for (int p = 0; p < v->wiper.cycle_steps; p++)
+        v->wiper.duty_lut[p] = angle_to_duty(v, v->wiper.angle_min + (p <= h ? p : 2 * h - p));
+    v->wiper.park_duty_ns = angle_to_duty(v, v->wiper.park_angle);
+
+    for (int l = 0; l < VEH_AIRCON_LEVELS; l++) {
+        if (v->aircon.duty_pct[l] < 0 || v->aircon.duty_pct[l] > 100) {
+            fprintf(stderr, "%s: aircon.duty_pct 는 0~100\n", path);
+            return -1;
+        }
+        v->aircon.duty_ns[l] = (long long)v->aircon.period_ns * v->aircon.duty_pct[l] / 100;
+    }
+    v->aircon.boost_ns = (long long)v->aircon.period_ns * v->aircon.boost_pct / 100;
+    return 0;
+}
+
+int vehicle_load(struct vehicle *v, const char *path)
+{
+    FILE *fp = fopen(path, "r");
+    char line[256];
+    int lineno = 0;
+
+    if (!fp) {
+        perror(path);
+        return -1;
+    }
+    memset(v, 0, sizeof(*v));
+    while (fgets(line, sizeof(line), fp)) {
+        char *p = line, *eq, *key, *val;
+
+        lineno++;
+        p[strcspn(p, "#\r\n")] = '\0';
+        eq = strchr(p, '=');
+        if (!eq) {
+            if (strspn(p, " \t") == strlen(p))
+                continue;
+            fprintf(stderr, "%s:%d: key=value 형식이 아님\n", path, lineno);
+            fclose(fp);
+            return -1;
+        }
+        *eq = '\0';
+        key = strtok(p, " \t");
+        val = strtok(eq + 1, " \t");
+        if (!key || set_key(v, key, val) < 0) {
+            fprintf(stderr, "%s:%d: 잘못된 설정 '%s'\n", path, lineno, key ? key : "");
+            fclose(fp);
+            return -1;
+        }
+    }
+    fclose(fp);
+    return derive(v, path);
+}
+
+int vehicle_setup(int *argc, char *argv[])
+{
+    const char *path = NULL;
+    int i, out = 1;
+
+    for (i = 1; i < *argc; i++) {
+        if (strcmp(argv[i], "--variant") == 0 && i + 1 < *argc) {
+            path = argv[++i];
+            continue;
+        }
+        argv[out++] = argv[i];
+    }
+    *argc = out;
+    argv[out] = NULL;
+
+#ifdef VEHICLE_RUNTIME
+    if (!path)
+        path = getenv("TOPST_VARIANT");
+    if (!path)
+        path = VEHICLE_DEFAULT_FILE;
+    return vehicle_load(&vehicle, path);
+#else
+    if (path) {
+        fprintf(stderr, "--variant: variant '%s' is built in (make VARIANT=runtime to load files)\n",
+                vehicle.name);
+        return -1;
+    }
+    return 0;
+#endif
+}
+
+int vehicle_zone_id(const char *name)
+{
+    for (int i = 0; i < vehicle.ambient.nzone; i++)
+        if (strcmp(name, vehicle.ambient.zone[i].name) == 0)
+            return i;
+    return -1;
+}
+
+void vehicle_usage(FILE *fp)
+{
+#ifdef VEHICLE_RUNTIME
+    fprintf(fp, "  --variant <file>      차량 variant (기본 $TOPST_VARIANT, %s)\n", VEHICLE_DEFAULT_FILE);
+#else
+    fprintf(fp, "  차량 variant: %s (빌드에 고정, make VARIANT=...)\n", vehicle.name);
+#endif
+}
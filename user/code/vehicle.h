@@ -0,0 +1,88 @@
+#ifndef VEHICLE_H
+#define VEHICLE_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+/*
+ * 차량 variant 별 설정 (PWM 채널, 서보/팬 duty, LED 수, SPI 버스, 존 배치).
+ * 설명은 variants/<name>.conf 하나 (key=value, # 주석) 에만 두고 데몬/setter 는
+ * 아래 struct vehicle 을 읽는다.
+ *
+ * 기본 빌드: make 가 vehicle_gen 으로 variant 를 vehicle_gen.h 의 static const
+ * 초기값으로 만들어 넣는다. 값과 파생 테이블(와이퍼 step→duty, 팬 단계→duty)이
+ * 컴파일 시 상수라 제어 루프에서 나눗셈/분기 없이 접힌다.
+ *   make VARIANT=variants/topst-d3g-long.conf
+ *
+ * 개발용: make VARIANT=runtime 이면 같은 파일을 시작할 때 읽는다.
+ *   --variant <file>  >  환경변수 TOPST_VARIANT  >  빌드 때 기본 파일
+ * 이때 배열 크기는 VEH_*_MAX 상한.
+ */
+#define VEH_NAME_LEN       32
+#define VEH_SPEC_LEN       64        /* --chan / --spi 와 같은 문자열 */
+#define VEH_MAX_WIPERS     4
+#define VEH_MAX_SPI        4
+#define VEH_MAX_ZONES      8         /* ambient_driver.c AMBIENT_MAX_ZONES */
+#define VEH_AIRCON_LEVELS  4         /* OFF LOW MID HIGH */
+#define VEH_WIPER_STEPS_MAX 360      /* 0 ~ 180 도 왕복, 1 도 / step */
+#define VEH_LEDS_LIMIT     4096
+
+struct veh_zone {
+    char     name[16];
+    uint16_t first, count;
+};
+
+struct vehicle {
+    char name[VEH_NAME_LEN];
+
+    struct {
+        char chan[VEH_MAX_WIPERS][VEH_SPEC_LEN];   /* chip:channel[:phase][:mirror] */
+        int  nchan;
+        int  period_ns;
+        int  duty_min_ns, duty_max_ns;   /* 0 도 / 180 도 */
+        int  angle_min, angle_max;       /* 스윕 범위 */
+        int  park_angle;
+        int  fast_step_us, slow_step_us;
+        /* 파생 */
+        int  cycle_steps;                /* 2 * (angle_max - angle_min) */
+        int  park_duty_ns;
+        int  duty_lut[VEH_WIPER_STEPS_MAX];   /* step → duty, 삼각파 한 왕복 */
+    } wiper;
+
+    struct {
+        int  pwm_chip, pwm_channel;
+        int  period_ns;
+        int  duty_pct[VEH_AIRCON_LEVELS];
+        int  boost_pct, boost_ms;
+        /* 파생 */
+        int  duty_ns[VEH_AIRCON_LEVELS];
+        int  boost_ns;
+    } aircon;
+
+    struct {
+        int  leds;
+        char spi[VEH_MAX_SPI][VEH_SPEC_LEN];       /* dev[:leds] */
+        int  nspi;
+        int  spi_hz;
+        struct veh_zone zone[VEH_MAX_ZONES];       /* index = 존 id */
+        int  nzone;
+    } ambient;
+};
+
+#ifdef VEHICLE_RUNTIME
+extern struct vehicle vehicle;
+#define VEH_LEDS_MAX VEH_LEDS_LIMIT
+#else
+#include "vehicle_gen.h"    /* static const struct vehicle vehicle, VEH_LEDS */
+#define VEH_LEDS_MAX VEH_LEDS
+#endif
+
+/* path 를 읽어 v 를 채우고 파생 테이블 계산. 오류는 "file:line: ..." 출력 후 -1 */
+int  vehicle_load(struct vehicle *v, const char *path);
+/* main() 첫머리: --variant <file> 를 걷어 내고 (runtime 빌드) variant 준비. 실패하면 -1 */
+int  vehicle_setup(int *argc, char *argv[]);
+/* 존 이름 → id, 없으면 -1 */
+int  vehicle_zone_id(const char *name);
+void vehicle_usage(FILE *fp);
+
+#endif // VEHICLE_H
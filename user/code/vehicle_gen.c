@@ -0,0 +1,88 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "vehicle.h"
+
+/*
+ * 빌드 도구: variant 파일 → vehicle_gen.h (static const struct vehicle).
+ * 파서/파생 계산은 런타임 로드와 같은 vehicle.c 라 두 빌드의 테이블이 같다.
+ *
+ *   vehicle_gen variants/topst-d3g.conf > vehicle_gen.h
+ */
+
+/* 8 개 이하면 한 줄, 아니면 줄당 8 개 */
+static void emit_ints(const char *field, const int *v, int n, const char *ind)
+{
+    printf("%s.%s = {", ind, field);
+    for (int i = 0; i < n; i++) {
+        if (n > 8 && i % 8 == 0)
+            printf("\n%s   ", ind);
+        printf(" %d,", v[i]);
+    }
+    if (n > 8)
+        printf("\n%s},\n", ind);
+    else
+        printf(" },\n");
+}
+
+static void emit_strs(const char *field, const char (*s)[VEH_SPEC_LEN], int n, const char *ind)
+{
+    printf("%s.%s = {", ind, field);
+    for (int i = 0; i < n; i++)
+        printf(" \"%s\",", s[i]);
+    printf(" },\n");
+}
+
+int main(int argc, char *argv[])
+{
+    const struct vehicle *v = &vehicle;
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s <variant.conf>\n", argv[0]);
+        return 1;
+    }
+    if (vehicle_load(&vehicle, argv[1]) < 0)
+        return 1;
+
+    printf("/* 자동 생성: vehicle_gen %s — 직접 고치지 말고 variant 파일을 고칠 것 */\n", argv[1]);
+    printf("#ifndef VEHICLE_GEN_H\n#define VEHICLE_GEN_H\n\n");
+    printf("#define VEH_LEDS %d\n\n", v->ambient.leds);
+    printf("static const struct vehicle vehicle = {\n");
+    printf("    .name = \"%s\",\n", v->name);
+
+    printf("    .wiper = {\n");
+    emit_strs("chan", v->wiper.chan, v->wiper.nchan, "        ");
+    printf("        .nchan = %d,\n", v->wiper.nchan);
+    printf("        .period_ns = %d,\n", v->wiper.period_ns);
+    printf("        .duty_min_ns = %d, .duty_max_ns = %d,\n", v->wiper.duty_min_ns, v->wiper.duty_max_ns);
+    printf("        .angle_min = %d, .angle_max = %d,\n", v->wiper.angle_min, v->wiper.angle_max);
+    printf("        .park_angle = %d,\n", v->wiper.park_angle);
+    printf("        .fast_step_us = %d, .slow_step_us = %d,\n", v->wiper.fast_step_us, v->wiper.slow_step_us);
+    printf("        .cycle_steps = %d,\n", v->wiper.cycle_steps);
+    printf("        .park_duty_ns = %d,\n", v->wiper.park_duty_ns);
+    emit_ints("duty_lut", v->wiper.duty_lut, v->wiper.cycle_steps, "        ");
+    printf("    },\n");
+
+    printf("    .aircon = {\n");
+    printf("        .pwm_chip = %d, .pwm_channel = %d,\n", v->aircon.pwm_chip, v->aircon.pwm_channel);
+    printf("        .period_ns = %d,\n", v->aircon.period_ns);
+    emit_ints("duty_pct", v->aircon.duty_pct, VEH_AIRCON_LEVELS, "        ");
+    printf("        .boost_pct = %d, .boost_ms = %d,\n", v->aircon.boost_pct, v->aircon.boost_ms);
+    emit_ints("duty_ns", v->aircon.duty_ns, VEH_AIRCON_LEVELS, "        ");
+    printf("        .boost_ns = %d,\n", v->aircon.boost_ns);
+    printf("    },\n");
+
+    printf("    .ambient = {\n");
+    printf("        .leds = VEH_LEDS,\n");
+    emit_strs("spi", v->ambient.spi, v->ambient.nspi, "        ");
+    printf("        .nspi = %d,\n", v->ambient.nspi);
+    printf("        .spi_hz = %d,\n", v->ambient.spi_hz);
+    printf("        .zone = {\n");
+    for (int i = 0; i < v->ambient.nzone; i++)
+        printf("            { \"%s\", %u, %u },\n", v->ambient.zone[i].name,
+               v->ambient.zone[i].first, v->ambient.zone[i].count);
+    printf("        },\n");
+    printf("        .nzone = %d,\n", v->ambient.nzone);
+    printf("    },\n");
+    printf("};\n\n#endif\n");
+    return 0;
+}
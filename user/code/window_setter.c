@@ -4,6 +4,7 @@
 #include <unistd.h>
 #include <string.h>
 #include <sys/ioctl.h>
+#include "setter_replay.h"
 
 #define DEVICE_PATH "/dev/window_dev"
 
@@ -11,13 +12,34 @@
 #define WINDOW_SET_STATE _IOW(WINDOW_MAGIC, 0, int)
 #define WINDOW_GET_STATE _IOR(WINDOW_MAGIC, 1, int)
 
+static int parse_cmd(const char *word, struct replay_cmd *out)
+{
+    out->req = WINDOW_SET_STATE;
+    if (strcmp(word, "stop") == 0)
+        out->val = 0;
+    else if (strcmp(word, "open") == 0)
+        out->val = 1;
+    else if (strcmp(word, "close") == 0)
+        out->val = 2;
+    else if (strcmp(word, "get") == 0) {
+        out->req = WINDOW_GET_STATE;
+        out->val = 0;
+    } else
+        return -1;
+    return 0;
+}
+
 int main(int argc, char *argv[])
 {
     int fd;
     int cmd;
 
+    if (argc >= 2 && strcmp(argv[1], "--replay") == 0)
+        return replay_main(DEVICE_PATH, argc, argv, parse_cmd);
+
     if (argc != 2) {
         fprintf(stderr, "Usage: %s [stop | open | close | get]\n", argv[0]);
+        fprintf(stderr, "       %s --replay [file|-] [--max-rate] [--repeat N]\n", argv[0]);
         return 1;
     }
 
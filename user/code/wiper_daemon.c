@@ -8,10 +8,15 @@
 #include <errno.h>
 #include <signal.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
 #include <sys/ioctl.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include "pwm_utils.h"
+#include "rt_profile.h"
+#include "topst_park.h"
+#include "vehicle.h"
 
 #define DEVICE_PATH "/dev/wiper_dev"
 
@@ -23,17 +28,33 @@
 #define WIPER_MODE_FAST 1
 #define WIPER_MODE_SLOW 2
 
-#define PWM_CHIP        0
-#define PWM_CHANNEL     0
-#define PWM_PERIOD_NS   20000000  // 20ms (50Hz)
+/* PWM 채널, 주기, 스윕 범위, step 간격, step → duty 테이블은 vehicle.h (variant) */
+#define OFF_POLL_US     100000    // 정지 중 모드 확인 주기
+#define PARK_SETTLE_MS  150       // 서보가 90° 에 닿을 시간 (커널 park 대기 300ms 안)
+#define PARK_CHECK_STEPS 30       // 스윕 중 park 상태 확인 간격 (~100ms)
 
-#define ANGLE_MIN       0
-#define ANGLE_MAX       180
-#define DUTY_MIN_NS     1000000   // 1.0ms
-#define DUTY_MAX_NS     2000000   // 2.0ms
+#define MAX_WIPERS      VEH_MAX_WIPERS
 
-#define FAST_DELAY_US   3000      // 2ms
-#define SLOW_DELAY_US   4000      // 4ms
+/*
+ * 한 타임라인으로 여러 와이퍼 채널을 구동한다. 채널마다 주기 대비 위상(deg)과
+ * 좌우 반전(mirror)을 두고, 매 tick 의 duty 갱신은 pwm_chan_queue 로 모아
+ * pwm_flush 한 번에 제출한다 (io_uring 이면 syscall 한 번).
+ */
+struct wiper_ch {
+    int             chip, channel;
+    int             phase;        /* 0~359, 주기 대비 위상 */
+    int             mirror;       /* 1 이면 스윕 범위 안에서 좌우 반전 */
+    int             offset;       /* duty_lut 시작 step (위상 + 반전 = 반 주기) */
+    struct pwm_chan pwm;
+
+    /* tick 시작 → 이 채널 write 완료 */
+    unsigned long   n;
+    uint64_t        off_ns_sum, off_ns_max;
+};
+
+static struct wiper_ch wipers[MAX_WIPERS];
+static int nwipers;
+static unsigned long pwm_errors;   /* 실패한 queue/flush (스윕은 계속, 종료 시 보고) */
 
 static bool keep_running = true;
 
@@ -41,17 +62,171 @@ void handle_sigint(int sig) {
     keep_running = false;
 }
 
-// 각도 → 듀티 변환
-unsigned int angle_to_duty(int angle)
+static uint64_t ts_ns(const struct timespec *ts)
+{
+    return (uint64_t)ts->tv_sec * 1000000000ull + ts->tv_nsec;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts_ns(&ts);
+}
+
+static void ts_add_us(struct timespec *ts, long us)
+{
+    ts->tv_nsec += us * 1000L;
+    while (ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+/* "chip:channel[:phase][:mirror]" 예) 0:0  0:1:0:mirror  1:0:180 */
+static int add_wiper(const char *spec)
+{
+    struct wiper_ch *w;
+    char buf[64], *tok, *save;
+    int field = 0;
+
+    if (nwipers >= MAX_WIPERS) {
+        fprintf(stderr, "too many wiper channels (max %d)\n", MAX_WIPERS);
+        return -1;
+    }
+    w = &wipers[nwipers];
+    memset(w, 0, sizeof(*w));
+    snprintf(buf, sizeof(buf), "%s", spec);
+    for (tok = strtok_r(buf, ":", &save); tok; tok = strtok_r(NULL, ":", &save), field++) {
+        if (strcmp(tok, "mirror") == 0 || strcmp(tok, "m") == 0) {
+            w->mirror = 1;
+            continue;
+        }
+        switch (field) {
+        case 0: w->chip = atoi(tok); break;
+        case 1: w->channel = atoi(tok); break;
+        case 2: w->phase = ((atoi(tok) % 360) + 360) % 360; break;
+        default: return -1;
+        }
+    }
+    if (field < 2)
+        return -1;
+    /* 삼각파라 반 주기 밀면 min + max - angle */
+    w->offset = (w->phase * vehicle.wiper.cycle_steps / 360 +
+                 (w->mirror ? vehicle.wiper.cycle_steps / 2 : 0)) % vehicle.wiper.cycle_steps;
+    nwipers++;
+    return 0;
+}
+
+/* variant 빌드면 cycle_steps 와 테이블이 상수라 나머지 연산 + 배열 읽기 하나 */
+static int wiper_duty(const struct wiper_ch *w, int step)
+{
+    int p = step + w->offset;
+
+    if (p >= vehicle.wiper.cycle_steps)
+        p -= vehicle.wiper.cycle_steps;
+    return vehicle.wiper.duty_lut[p];
+}
+
+/*
+ * 모든 채널 duty 를 모아 한 번에 제출하고 채널별 완료 시각 기록.
+ * *skew_ns = 첫 채널 ~ 마지막 채널 완료 간격. io_uring 경로는 io_uring_enter 가
+ * 전부 끝난 뒤에 돌아와 채널별 완료 시각이 없으므로 기록하지 않고 false 반환
+ */
+static bool wipers_apply(int step, int park, uint64_t t_tick,
+                         uint64_t *batch_ns, uint64_t *skew_ns)
 {
-    if (angle < ANGLE_MIN) angle = ANGLE_MIN;
-    if (angle > ANGLE_MAX) angle = ANGLE_MAX;
-    return DUTY_MIN_NS + (DUTY_MAX_NS - DUTY_MIN_NS) * angle / 180;
+    uint64_t done[MAX_WIPERS];
+    bool per_ch = strcmp(pwm_backend_name(), "io_uring") != 0;
+
+    for (int i = 0; i < nwipers; i++) {
+        int duty = park ? vehicle.wiper.park_duty_ns : wiper_duty(&wipers[i], step);
+        if (pwm_chan_queue(&wipers[i].pwm, duty, 1) < 0)
+            pwm_errors++;
+        done[i] = now_ns();   /* pwrite 경로면 여기서 이미 완료 */
+    }
+    if (pwm_flush() < 0)
+        pwm_errors++;
+    *batch_ns = now_ns() - t_tick;
+    if (!per_ch)
+        return false;
+
+    for (int i = 0; i < nwipers; i++) {
+        uint64_t off = done[i] - t_tick;
+        wipers[i].n++;
+        wipers[i].off_ns_sum += off;
+        if (off > wipers[i].off_ns_max)
+            wipers[i].off_ns_max = off;
+    }
+    *skew_ns = done[nwipers - 1] - done[0];
+    return true;
 }
 
-int main(void)
+/*
+ * parking/suspended: 모든 채널을 park 각도로 세운 뒤 PWM 을 끄고 (parking 이면 ack)
+ * active 가 될 때까지 잠듦. 모드는 드라이버에 남아 있어 깨어나면 이어서 돈다.
+ */
+static void wipers_park(struct topst_park *park)
 {
-    int fd, mode = WIPER_MODE_OFF;
+    for (int i = 0; i < nwipers; i++)
+        if (pwm_chan_queue(&wipers[i].pwm, vehicle.wiper.park_duty_ns, 1) < 0)
+            pwm_errors++;
+    if (pwm_flush() < 0)
+        pwm_errors++;
+    usleep(PARK_SETTLE_MS * 1000);
+    for (int i = 0; i < nwipers; i++)
+        if (pwm_chan_queue(&wipers[i].pwm, vehicle.wiper.park_duty_ns, 0) < 0)
+            pwm_errors++;
+    if (pwm_flush() < 0)
+        pwm_errors++;
+
+    printf("Wiper parked at %d deg (%s)\n", vehicle.wiper.park_angle, park_name(park->state));
+    if (park->state == PARK_PARKING)
+        park_ack(park);
+    while (keep_running && park->state != PARK_ACTIVE)
+        park_wait(park, -1);
+    if (keep_running)
+        printf("Wiper resumed\n");
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "Usage: %s [--chan chip:channel[:phase_deg][:mirror]] ...  (최대 %d, 기본 variant 의 wiper.chan)\n",
+            prog, MAX_WIPERS);
+    rt_usage(stderr);
+    vehicle_usage(stderr);
+}
+
+int main(int argc, char *argv[])
+{
+    int fd, mode = WIPER_MODE_OFF, step = 0;
+    struct rt_profile rt;
+    struct topst_park park;
+    struct timespec next;
+    unsigned long ticks = 0, late = 0, skew_n = 0;
+    uint64_t late_ns_sum = 0, late_ns_max = 0, batch_sum = 0, batch_max = 0;
+    uint64_t skew_sum = 0, skew_max = 0;
+
+    rt_profile_init(&rt);
+    if (vehicle_setup(&argc, argv) < 0 || rt_parse_args(&rt, &argc, argv) < 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--chan") == 0 && i + 1 < argc && add_wiper(argv[i + 1]) == 0) {
+            i++;
+            continue;
+        }
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    /* --chan 이 없으면 variant 의 채널 목록 */
+    for (int i = 0, n = nwipers; n == 0 && i < vehicle.wiper.nchan; i++) {
+        if (add_wiper(vehicle.wiper.chan[i]) < 0) {
+            fprintf(stderr, "variant %s: bad wiper.chan %s\n", vehicle.name, vehicle.wiper.chan[i]);
+            return EXIT_FAILURE;
+        }
+    }
 
     signal(SIGINT, handle_sigint);
 
@@ -61,49 +236,124 @@ int main(void)
         return EXIT_FAILURE;
     }
 
-    pwm_export(PWM_CHIP, PWM_CHANNEL);
-    pwm_set_period(PWM_CHIP, PWM_CHANNEL, PWM_PERIOD_NS);
-    pwm_enable(PWM_CHIP, PWM_CHANNEL, 0);
+    for (int i = 0; i < nwipers; i++) {
+        struct wiper_ch *w = &wipers[i];
 
-    printf("Wiper daemon started (sweeping).\n");
+        pwm_export(w->chip, w->channel);
+        pwm_set_period(w->chip, w->channel, vehicle.wiper.period_ns);
+        pwm_enable(w->chip, w->channel, 0);
 
-    while (keep_running) {
-        if (ioctl(fd, WIPER_GET_MODE, &mode) < 0) {
-            perror("ioctl(GET_MODE)");
-            break;
+        /* 스윕 중 매 스텝 duty/enable 갱신은 열어 둔 fd 로 일괄 제출 */
+        if (pwm_chan_open(&w->pwm, w->chip, w->channel) < 0) {
+            while (i-- > 0)
+                pwm_chan_close(&wipers[i].pwm);
+            close(fd);
+            return EXIT_FAILURE;
         }
+        w->pwm.enabled = 0;
+        printf("Wiper channel %d:%d phase %d%s\n", w->chip, w->channel, w->phase,
+               w->mirror ? " mirrored" : "");
+    }
 
-        if (mode == WIPER_MODE_OFF) {
-            unsigned int duty = angle_to_duty(90); // 중간
-            pwm_set_duty_cycle(PWM_CHIP, PWM_CHANNEL, duty);
-            pwm_enable(PWM_CHIP, PWM_CHANNEL, 1);
-            usleep(100000); // 100ms
+    park_open(&park, "wiper_dev");
+
+    rt_apply(&rt, "wiper_daemon");
+    rt_selftest(&rt, "wiper_daemon");
+
+    printf("Wiper daemon started (%s, %d channel(s), %s).\n", vehicle.name, nwipers, pwm_backend_name());
+
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (keep_running) {
+        uint64_t t_tick, batch, skew;
+        bool per_ch;
+        long period_us;
+
+        /* 정지 중에는 매 tick (100ms), 스윕 중에는 PARK_CHECK_STEPS 마다 */
+        if (step % PARK_CHECK_STEPS == 0 && park_wait(&park, 0) != PARK_ACTIVE) {
+            wipers_park(&park);
+            /* 잠든 동안의 tick 은 버리고 왕복 처음부터 (모드도 다시 읽음) */
+            step = 0;
+            clock_gettime(CLOCK_MONOTONIC, &next);
             continue;
         }
 
-        int delay_us = (mode == WIPER_MODE_FAST) ? FAST_DELAY_US : SLOW_DELAY_US;
+        /* 모드는 왕복이 끝날 때(또는 정지 중)만 확인 → 스윕 도중 끊기지 않음 */
+        if (step == 0 || mode == WIPER_MODE_OFF) {
+            if (ioctl(fd, WIPER_GET_MODE, &mode) < 0) {
+                perror("ioctl(GET_MODE)");
+                break;
+            }
+        }
 
-        // 0 → 180
-        for (int angle = 0; angle <= 180 && keep_running; angle++) {
-            unsigned int duty = angle_to_duty(angle);
-            pwm_set_duty_cycle(PWM_CHIP, PWM_CHANNEL, duty);
-            pwm_enable(PWM_CHIP, PWM_CHANNEL, 1);
-            usleep(delay_us);
+        t_tick = now_ns();
+        if (t_tick > ts_ns(&next)) {
+            uint64_t l = t_tick - ts_ns(&next);
+            late_ns_sum += l;
+            if (l > late_ns_max)
+                late_ns_max = l;
+            if (l > 1000000)
+                late++;
         }
 
-        // 180 → 0
-        for (int angle = 180; angle >= 0 && keep_running; angle--) {
-            unsigned int duty = angle_to_duty(angle);
-            pwm_set_duty_cycle(PWM_CHIP, PWM_CHANNEL, duty);
-            pwm_enable(PWM_CHIP, PWM_CHANNEL, 1);
-            usleep(delay_us);
+        if (mode == WIPER_MODE_OFF) {
+            per_ch = wipers_apply(0, 1, t_tick, &batch, &skew);   // 중간
+            step = 0;
+            period_us = OFF_POLL_US;
+        } else {
+            per_ch = wipers_apply(step, 0, t_tick, &batch, &skew);
+            step = (step + 1) % vehicle.wiper.cycle_steps;
+            period_us = (mode == WIPER_MODE_FAST) ? vehicle.wiper.fast_step_us : vehicle.wiper.slow_step_us;
         }
+
+        ticks++;
+        batch_sum += batch;
+        if (batch > batch_max)
+            batch_max = batch;
+        if (per_ch) {
+            skew_n++;
+            skew_sum += skew;
+            if (skew > skew_max)
+                skew_max = skew;
+        }
+
+        /* 고정 타임라인: 처리 시간과 무관하게 절대 시각으로 다음 tick */
+        ts_add_us(&next, period_us);
+        if (now_ns() > ts_ns(&next))     /* 한 tick 이상 밀렸으면 몰아서 따라잡지 않고 재정렬 */
+            clock_gettime(CLOCK_MONOTONIC, &next);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
     }
 
-    pwm_enable(PWM_CHIP, PWM_CHANNEL, 0);
-    pwm_unexport(PWM_CHIP, PWM_CHANNEL);
+    park_close(&park);
+    for (int i = 0; i < nwipers; i++) {
+        struct wiper_ch *w = &wipers[i];
+
+        pwm_chan_close(&w->pwm);
+        pwm_enable(w->chip, w->channel, 0);
+        pwm_unexport(w->chip, w->channel);
+    }
     close(fd);
 
+    if (ticks) {
+        printf("Wiper ticks %lu, wakeup late avg %.1f / max %.1f us (>1ms: %lu)\n", ticks,
+               late_ns_sum / 1e3 / ticks, late_ns_max / 1e3, late);
+        printf("Wiper tick batch (all channels) avg %.1f / max %.1f us\n",
+               batch_sum / 1e3 / ticks, batch_max / 1e3);
+        for (int i = 0; i < nwipers; i++) {
+            if (wipers[i].n)
+                printf("  ch %d:%d write done after tick start: avg %.1f / max %.1f us\n",
+                       wipers[i].chip, wipers[i].channel,
+                       wipers[i].off_ns_sum / 1e3 / wipers[i].n, wipers[i].off_ns_max / 1e3);
+            else
+                printf("  ch %d:%d write done after tick start: n/a (io_uring)\n",
+                       wipers[i].chip, wipers[i].channel);
+        }
+        if (nwipers > 1 && skew_n)
+            printf("  channel skew (last - first): avg %.1f / max %.1f us (%lu ticks)\n",
+                   skew_sum / 1e3 / skew_n, skew_max / 1e3, skew_n);
+        else if (nwipers > 1)
+            printf("  channel skew (last - first): n/a (io_uring, batch above is the bound)\n");
+    }
+    printf("Wiper PWM write errors: %lu\n", pwm_errors);
     printf("Wiper daemon terminated.\n");
     return 0;
 }
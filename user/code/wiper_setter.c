@@ -4,6 +4,7 @@
 #include <unistd.h>
 #include <sys/ioctl.h>
 #include <string.h>
+#include "setter_replay.h"
 
 #define WIPER_MAGIC 'W'
 #define WIPER_SET_MODE _IOW(WIPER_MAGIC, 1, int)
@@ -14,26 +15,39 @@
 
 void usage(const char *progname) {
     printf("Usage: %s [off|fast|slow]\n", progname);
+    printf("       %s --replay [file|-] [--max-rate] [--repeat N]\n", progname);
+}
+
+static int parse_mode(const char *word, struct replay_cmd *out) {
+    out->req = WIPER_SET_MODE;
+    if (strcmp(word, "off") == 0)
+        out->val = WIPER_MODE_OFF;
+    else if (strcmp(word, "fast") == 0)
+        out->val = WIPER_MODE_FAST;
+    else if (strcmp(word, "slow") == 0)
+        out->val = WIPER_MODE_SLOW;
+    else
+        return -1;
+    return 0;
 }
 
 int main(int argc, char *argv[]) {
     int fd, mode;
+    struct replay_cmd c;
+
+    if (argc >= 2 && strcmp(argv[1], "--replay") == 0)
+        return replay_main("/dev/wiper_dev", argc, argv, parse_mode);
 
     if (argc != 2) {
         usage(argv[0]);
         return 1;
     }
 
-    if (strcmp(argv[1], "off") == 0)
-        mode = WIPER_MODE_OFF;
-    else if (strcmp(argv[1], "fast") == 0)
-        mode = WIPER_MODE_FAST;
-    else if (strcmp(argv[1], "slow") == 0)
-        mode = WIPER_MODE_SLOW;
-    else {
+    if (parse_mode(argv[1], &c) < 0) {
         usage(argv[0]);
         return 1;
     }
+    mode = c.val;
 
     fd = open("/dev/wiper_dev", O_RDWR);
     if (fd < 0) {